@@ -2,12 +2,91 @@
 // Created by Lars Gebraad on 14-8-17.
 //
 
+#include <cmath>
 #include <ctime>
 #include <iomanip>
+#include <random>
 #include "src/algebra_lib/algebra_lib.hpp"
 
 using namespace algebra_lib;
 
+namespace {
+    double MaximumEntry(const matrix &A) {
+        double maximum = 0.0;
+        for (unsigned int i = 0; i < A.rows(); ++i) {
+            for (unsigned int j = 0; j < A.columns(); ++j) {
+                maximum = std::max(maximum, std::fabs(A[i][j]));
+            }
+        }
+        return maximum;
+    }
+
+    double MaximumEntry(const vector &U) {
+        double maximum = 0.0;
+        for (unsigned int i = 0; i < U.size(); ++i) {
+            maximum = std::max(maximum, std::fabs(U[i]));
+        }
+        return maximum;
+    }
+
+    matrix RandomMatrix(unsigned int rows, unsigned int columns, std::mt19937 &generator) {
+        std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+        matrix A(rows, columns);
+        for (unsigned int i = 0; i < rows; ++i) {
+            for (unsigned int j = 0; j < columns; ++j) {
+                A[i][j] = distribution(generator);
+            }
+        }
+        return A;
+    }
+
+    vector RandomVector(unsigned int size, std::mt19937 &generator) {
+        std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+        vector U(size, true);
+        for (unsigned int i = 0; i < size; ++i) {
+            U[i] = distribution(generator);
+        }
+        return U;
+    }
+
+    matrix Identity(unsigned int size) {
+        matrix I(size, size);
+        for (unsigned int i = 0; i < size; ++i) {
+            I[i][i] = 1.0;
+        }
+        return I;
+    }
+
+    /*
+     * Sparse symmetric positive definite matrix: a path through all rows and a few random
+     * couplings, made diagonally dominant.
+     */
+    sparse_matrix RandomSparseDefinite(unsigned int size, std::mt19937 &generator) {
+        std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+        sparse_matrix A(size, size);
+        for (unsigned int i = 0; i + 1 < size; ++i) {
+            A(i + 1)(i) = A(i)(i + 1) = distribution(generator);
+        }
+        for (unsigned int coupling = 0; coupling < size; ++coupling) {
+            unsigned int i = generator() % size;
+            unsigned int j = generator() % size;
+            if (i != j) A(i)(j) = A(j)(i) = distribution(generator);
+        }
+        for (unsigned int i = 0; i < size; ++i) {
+            double sum = 0.0;
+            for (auto const &entry : A(i)) sum += std::fabs(entry.second);
+            A(i)(i) = sum + 1.0;
+        }
+        return A;
+    }
+
+    bool WithinTolerance(double residual, double tolerance, const char *what) {
+        if (residual <= tolerance) return true;
+        std::cerr << what << ": residual " << residual << " exceeds " << tolerance << "." << std::endl;
+        return false;
+    }
+}
+
 int main() {
 
     /*matrix PSD(3, 3);
@@ -30,6 +109,92 @@ int main() {
 
     std::cout << A.InvertLowerTriangular() * A;*/
 
+    // A moved from sparse_vector must stay usable, whether its entries were inline or not.
+    sparse_vector Moved(100);
+    sparse_vector Target(100);
+    for (unsigned int i = 0; i < 10; ++i) {
+        Moved(i) = 1.0;
+        Target(i) = 2.0;
+    }
+    Target = std::move(Moved);
+    Moved(99) = 1.0;
+    if (Moved.nonZeros() != 1 or Target.nonZeros() != 10 or Target[0] != 1.0) {
+        std::cerr << "Moved from sparse_vector is not empty." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Residuals of the decompositions and solvers, on fixed random problems.
+    std::mt19937 generator(2017);
+    const double tolerance = 1e-10;
+    bool passed = true;
+
+    const unsigned int n = 60;
+    matrix R = RandomMatrix(n, n, generator);
+    matrix S = R + R.Transpose();
+    symmetric_eigen_result Eigen = SymmetricEigenDecompose(S);
+    passed &= WithinTolerance(MaximumEntry(S * Eigen.eigenvectors - Eigen.eigenvectors *
+                                                                     VectorToDiagonal(Eigen.eigenvalues)),
+                              tolerance * MaximumEntry(S), "Eigen decomposition A V - V Lambda");
+    passed &= WithinTolerance(MaximumEntry(Eigen.eigenvectors.Transpose() * Eigen.eigenvectors - Identity(n)),
+                              tolerance, "Eigen decomposition V^T V - I");
+
+    vector X = RandomVector(n, generator);
+    vector Right = R * X;
+    vector Solution = lu_decomposition(R).Solve(Right);
+    passed &= WithinTolerance(MaximumEntry(R * Solution - Right), tolerance * MaximumEntry(Right), "LU A x - b");
+
+    matrix Definite = R * R.Transpose() + n * Identity(n);
+    matrix W = RandomMatrix(n, 2, generator);
+    matrix L = Definite.CholeskyDecompose();
+    CholeskyUpdate(L, W);
+    passed &= WithinTolerance(MaximumEntry(L * L.Transpose() - (Definite + W * W.Transpose())),
+                              tolerance * MaximumEntry(Definite), "Dense Cholesky update L L^T - A");
+    CholeskyDowndate(L, W);
+    passed &= WithinTolerance(MaximumEntry(L * L.Transpose() - Definite),
+                              tolerance * MaximumEntry(Definite), "Dense Cholesky downdate L L^T - A");
+
+    const unsigned int m = 200;
+    sparse_matrix SparseDefinite = RandomSparseDefinite(m, generator);
+    matrix FullDefinite = ToFull(SparseDefinite);
+    sparse_matrix SparseW(m, 2);
+    for (unsigned int i = 0; i < m; i += 17) {
+        SparseW(i)(i % 2) = 1.0 + i % 5;
+    }
+    sparse_matrix SparseL = SparseDefinite.CholeskyDecompose();
+    CholeskyUpdate(SparseL, SparseW);
+    matrix FullL = ToFull(SparseL);
+    matrix FullW = ToFull(SparseW);
+    passed &= WithinTolerance(MaximumEntry(FullL * FullL.Transpose() - (FullDefinite + FullW * FullW.Transpose())),
+                              tolerance * MaximumEntry(FullDefinite), "Sparse Cholesky update L L^T - A");
+    CholeskyDowndate(SparseL, SparseW);
+    FullL = ToFull(SparseL);
+    passed &= WithinTolerance(MaximumEntry(FullL * FullL.Transpose() - FullDefinite),
+                              tolerance * MaximumEntry(FullDefinite), "Sparse Cholesky downdate L L^T - A");
+
+    FullL = ToFull(block_sparse_matrix(SparseDefinite, 4).CholeskyDecompose().ToSparse());
+    passed &= WithinTolerance(MaximumEntry(FullL * FullL.Transpose() - FullDefinite),
+                              tolerance * MaximumEntry(FullDefinite), "Block sparse Cholesky L L^T - A");
+
+    // Without fill, as for a tridiagonal matrix, the incomplete factor is the complete one.
+    sparse_matrix Tridiagonal(m, m);
+    for (unsigned int i = 0; i < m; ++i) {
+        Tridiagonal(i)(i) = 4.0;
+        if (i > 0) Tridiagonal(i)(i - 1) = Tridiagonal(i - 1)(i) = -1.0;
+    }
+    FullL = ToFull(IncompleteCholesky(Tridiagonal));
+    passed &= WithinTolerance(MaximumEntry(FullL * FullL.Transpose() - ToFull(Tridiagonal)), tolerance,
+                              "Incomplete Cholesky L L^T - A");
+
+    vector SparseB = RandomVector(m, generator);
+    conjugate_gradient_options options;
+    options.relativeTolerance = 1e-12;
+    conjugate_gradient_result Result = ConjugateGradient(SparseDefinite, SparseB, nullptr, options);
+    passed &= WithinTolerance(MaximumEntry(SparseDefinite * Result.solution - SparseB),
+                              1e-10 * MaximumEntry(SparseB), "Conjugate gradient A x - b");
+    if (!passed) {
+        return EXIT_FAILURE;
+    }
+
     sparse_matrix B(501, 501);
 
     sparse_matrix A = ParallelMatrixProduct(B, B);
@@ -42,8 +42,34 @@
 #define LINEARALGEBRA_ALGEBRALIB_HPP
 
 #include "globals.hpp"
+#include "pool_allocator.hpp"
+#include "parallel.hpp"
 #include "full_algebra.hpp"
 #include "sparse_algebra.hpp"
 #include "sparse_parallel_algebra.hpp"
+#include "mixed_algebra.hpp"
+#include "hybrid_vector.hpp"
+#include "sparse_builder.hpp"
+#include "sparse_compressed_io.hpp"
+#include "sparse_stream.hpp"
+#include "transpose_view.hpp"
+#include "symmetric_matrix.hpp"
+#include "symmetric_sparse_matrix.hpp"
+#include "block_sparse_matrix.hpp"
+#include "sliced_ell_matrix.hpp"
+#include "band_matrix.hpp"
+#include "tridiagonal_matrix.hpp"
+#include "diagonal_matrix.hpp"
+#include "preconditioner.hpp"
+#include "conjugate_gradient.hpp"
+#include "incomplete_cholesky.hpp"
+#include "triangular_solve.hpp"
+#include "reordering.hpp"
+#include "cholesky_update.hpp"
+#include "dense_kernels.hpp"
+#include "lu_decomposition.hpp"
+#include "symmetric_eigen.hpp"
+#include "lanczos.hpp"
+#include "log_determinant.hpp"
 
 #endif //LINEARALGEBRA_ALGEBRALIB_HPP
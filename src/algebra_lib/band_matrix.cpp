@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <cmath>
+#include "parallel.hpp"
+#include "band_matrix.hpp"
+
+namespace algebra_lib {
+    band_matrix::band_matrix(unsigned int dimension, unsigned int lowerBandwidth, unsigned int upperBandwidth)
+            : _dimension(dimension), _lower(lowerBandwidth), _upper(upperBandwidth),
+              _bands(static_cast<unsigned long>(dimension) * (lowerBandwidth + upperBandwidth + 1), 0.0) {}
+
+    band_matrix::band_matrix(const sparse_matrix &A) : _dimension(A.rows()), _lower(0), _upper(0) {
+        if (A.rows() != A.columns()) {
+            throw std::length_error("Band matrix: matrix is not square.");
+        }
+        for (auto const &row : A) {
+            if (row.second.nonZeros() == 0) continue;
+            unsigned int first = row.second.begin()->first;
+            unsigned int last = row.second.rbegin()->first;
+            if (first < row.first) _lower = std::max(_lower, row.first - first);
+            if (last > row.first) _upper = std::max(_upper, last - row.first);
+        }
+        _bands.assign(static_cast<unsigned long>(_dimension) * (_lower + _upper + 1), 0.0);
+        for (auto const &row : A) {
+            for (auto const &entry : row.second) {
+                _bands[Position(row.first, entry.first)] = entry.second;
+            }
+        }
+    }
+
+    double &band_matrix::operator()(unsigned int row, unsigned int column) {
+        if (row >= _dimension or column >= _dimension) {
+            throw std::out_of_range("Exceeded matrix bounds");
+        } else if ((row > column and row - column > _lower) or (column > row and column - row > _upper)) {
+            throw std::out_of_range("Exceeded matrix band");
+        }
+        return _bands[Position(row, column)];
+    }
+
+    double band_matrix::operator()(unsigned int row, unsigned int column) const {
+        if (row >= _dimension or column >= _dimension) {
+            throw std::out_of_range("Exceeded matrix bounds");
+        } else if ((row > column and row - column > _lower) or (column > row and column - row > _upper)) {
+            return 0.0;
+        }
+        return _bands[Position(row, column)];
+    }
+
+    sparse_matrix band_matrix::ToSparse() const {
+        sparse_matrix Sparse(_dimension, _dimension);
+        for (unsigned int row = 0; row < _dimension; ++row) {
+            sparse_vector Row(_dimension, false);
+            unsigned int first = row > _lower ? row - _lower : 0;
+            unsigned int last = std::min(_dimension - 1, row + _upper);
+            for (unsigned int column = first; column <= last; ++column) {
+                double value = _bands[Position(row, column)];
+                if (value != 0) Row.Append(column, value);
+            }
+            if (Row.nonZeros() > 0)
+                Sparse.AppendRow(row, std::move(Row));
+        }
+        return Sparse;
+    }
+
+    band_matrix band_matrix::CholeskyDecompose() const {
+        // Right looking, column by column: every column is contiguous in band storage, and
+        // its update only touches the next lowerBandwidth columns.
+        const unsigned int width = _lower + 1;
+        band_matrix L(_dimension, _lower, 0);
+        double *l = L._bands.data();
+        for (unsigned int column = 0; column < _dimension; ++column) {
+            unsigned int last = std::min(_lower, _dimension - 1 - column);
+            for (unsigned int offset = 0; offset <= last; ++offset) {
+                l[static_cast<unsigned long>(column) * width + offset] = _bands[Position(column + offset, column)];
+            }
+        }
+
+        for (unsigned int column = 0; column < _dimension; ++column) {
+            double *lColumn = l + static_cast<unsigned long>(column) * width;
+            if (!(lColumn[0] > 0)) {
+                throw std::domain_error("Cholesky decomposition: matrix is not positive definite.");
+            }
+            lColumn[0] = sqrt(lColumn[0]);
+            unsigned int last = std::min(_lower, _dimension - 1 - column);
+            for (unsigned int offset = 1; offset <= last; ++offset) {
+                lColumn[offset] /= lColumn[0];
+            }
+            for (unsigned int next = 1; next <= last; ++next) {
+                double *target = lColumn + static_cast<unsigned long>(next) * width;
+                double factor = lColumn[next];
+                for (unsigned int offset = next; offset <= last; ++offset) {
+                    target[offset - next] -= lColumn[offset] * factor;
+                }
+            }
+        }
+        return L;
+    }
+
+    vector band_matrix::SolveLowerTriangular(const vector &Y) const {
+        if (Y.size() != _dimension) {
+            throw std::length_error("Solving lower triangular matrix: vector and matrix are not compatible in dimension");
+        }
+
+        vector X(Y);
+        auto x = X.begin();
+        const unsigned int width = _lower + _upper + 1;
+        for (unsigned int column = 0; column < _dimension; ++column) {
+            const double *a = _bands.data() + static_cast<unsigned long>(column) * width + _upper;
+            x[column] /= a[0];
+            unsigned int last = std::min(_lower, _dimension - 1 - column);
+            for (unsigned int offset = 1; offset <= last; ++offset) {
+                x[column + offset] -= a[offset] * x[column];
+            }
+        }
+        return X;
+    }
+
+    vector band_matrix::SolveTransposedLowerTriangular(const vector &Y) const {
+        if (Y.size() != _dimension) {
+            throw std::length_error("Solving upper triangular matrix: vector and matrix are not compatible in dimension");
+        }
+
+        vector X(Y);
+        auto x = X.begin();
+        const unsigned int width = _lower + _upper + 1;
+        for (unsigned int column = _dimension; column-- > 0;) {
+            const double *a = _bands.data() + static_cast<unsigned long>(column) * width + _upper;
+            double sum = x[column];
+            unsigned int last = std::min(_lower, _dimension - 1 - column);
+            for (unsigned int offset = 1; offset <= last; ++offset) {
+                sum -= a[offset] * x[column + offset];
+            }
+            x[column] = sum / a[0];
+        }
+        return X;
+    }
+
+    vector CholeskySolve(const band_matrix &L, const vector &Y) {
+        return L.SolveTransposedLowerTriangular(L.SolveLowerTriangular(Y));
+    }
+
+    vector operator*(const band_matrix &A, const vector &U) {
+        if (A.columns() != U.size()) {
+            throw std::length_error(
+                    "Left multiplication with matrix: vector and matrix are not compatible in dimension");
+        } else if (!U.isColumn()) {
+            throw std::invalid_argument(
+                    "Left multiplication with matrix: vector is not a column vector! First transpose it for goodness' sake.");
+        }
+
+        // Along a row, band storage steps back one entry less than a column.
+        const unsigned int n = A.rows();
+        const unsigned long stride = A.lowerBandwidth() + A.upperBandwidth();
+        const double *bands = A.bands().data();
+        vector Product(n, true);
+        auto u = U.begin();
+        auto y = Product.begin();
+        ParallelFor(0, n, [&](unsigned long first, unsigned long last) {
+            for (unsigned long row = first; row < last; ++row) {
+                unsigned long column = row > A.lowerBandwidth() ? row - A.lowerBandwidth() : 0;
+                unsigned long end = std::min<unsigned long>(n, row + A.upperBandwidth() + 1);
+                const double *a = bands + column * (stride + 1) + A.upperBandwidth() + row - column;
+                double sum = 0.0;
+                for (; column < end; ++column, a += stride) {
+                    sum += *a * u[column];
+                }
+                y[row] = sum;
+            }
+        }, 4096);
+        return Product;
+    }
+
+    std::ostream &operator<<(std::ostream &stream, const band_matrix &A) {
+        stream << "Band matrix of dimension " << A.rows() << "x" << A.columns() << ", "
+               << A.lowerBandwidth() << " sub- and " << A.upperBandwidth() << " superdiagonals:" << std::endl;
+        stream << A.ToSparse();
+        return stream;
+    }
+}
@@ -0,0 +1,126 @@
+/*! \file band_matrix.hpp
+ * \brief Square band matrices in LAPACK band storage.
+ *
+ * A matrix with \f$ k_l \f$ sub- and \f$ k_u \f$ superdiagonals is stored column by column,
+ * every column holding its \f$ k_l + k_u + 1 \f$ entries inside the band: entry
+ * \f$ (i, j) \f$ lives at \f$ j (k_l + k_u + 1) + k_u + i - j \f$, as in LAPACK's
+ * general band layout. The fill of a Cholesky factorization stays inside the band, so
+ * factorizing takes \f$ O(n k_l^2) \f$ and solving \f$ O(n k_l) \f$, where the generic
+ * sparse routines don't know about the band.
+ */
+
+#ifndef LINEARALGEBRA_BANDMATRIX_HPP
+#define LINEARALGEBRA_BANDMATRIX_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "sparse_matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Class for square band matrices.
+     */
+    class band_matrix {
+    public:
+        // Constructors
+        /*!
+         * \brief Zero matrix.
+         * @param dimension Rows and columns of the matrix.
+         * @param lowerBandwidth Number of subdiagonals stored.
+         * @param upperBandwidth Number of superdiagonals stored.
+         */
+        explicit band_matrix(unsigned int dimension = 0, unsigned int lowerBandwidth = 0,
+                             unsigned int upperBandwidth = 0);
+
+        /*!
+         * \brief Convert a sparse matrix, with the bandwidths of its stored entries.
+         * @throw std::length_error A is not square.
+         */
+        explicit band_matrix(const sparse_matrix &A);
+
+        // Member functions
+        unsigned int rows() const { return _dimension; }
+
+        unsigned int columns() const { return _dimension; }
+
+        unsigned int lowerBandwidth() const { return _lower; }
+
+        unsigned int upperBandwidth() const { return _upper; }
+
+        /*!
+         * \brief Entry (row, column) inside the band.
+         * @throw std::out_of_range Entry outside matrix or band.
+         */
+        double &operator()(unsigned int row, unsigned int column);
+
+        /*!
+         * \brief Entry (row, column), zero outside the band.
+         * @throw std::out_of_range Entry outside matrix.
+         */
+        double operator()(unsigned int row, unsigned int column) const;
+
+        /*!
+         * \brief Band storage, column after column, lowerBandwidth() + upperBandwidth() + 1 entries each.
+         *
+         * Entries of a column that fall outside the matrix are zero.
+         */
+        const std::vector<double> &bands() const { return _bands; }
+
+        /*!
+         * \brief Convert to a sparse matrix, leaving out zero entries.
+         */
+        sparse_matrix ToSparse() const;
+
+        /*!
+         * \brief Lower triangular Cholesky factor L, with \f$ A = L L^T \f$, as a band matrix without superdiagonals.
+         *
+         * Reads only the diagonal and the subdiagonals. Takes \f$ O(n k_l^2) \f$.
+         * @throw std::domain_error Matrix is not positive definite.
+         */
+        band_matrix CholeskyDecompose() const;
+
+        /*!
+         * \brief Solve \f$ L x = y \f$ by forward substitution, L being the diagonal and subdiagonals.
+         * @throw std::length_error Y is not of compatible dimension.
+         */
+        vector SolveLowerTriangular(const vector &Y) const;
+
+        /*!
+         * \brief Solve \f$ L^T x = y \f$ by back substitution, L being the diagonal and subdiagonals.
+         * @throw std::length_error Y is not of compatible dimension.
+         */
+        vector SolveTransposedLowerTriangular(const vector &Y) const;
+
+    private:
+        unsigned int _dimension;
+        unsigned int _lower;
+        unsigned int _upper;
+        std::vector<double> _bands;
+
+        unsigned long Position(unsigned int row, unsigned int column) const {
+            return static_cast<unsigned long>(column) * (_lower + _upper + 1) + _upper + row - column;
+        }
+    };
+
+    /*!
+     * \brief Solve \f$ A x = y \f$ given the Cholesky factor of A.
+     * @param L Factor from band_matrix::CholeskyDecompose.
+     * @param Y Right hand side.
+     * @throw std::length_error L and Y are not of compatible dimension.
+     */
+    vector CholeskySolve(const band_matrix &L, const vector &Y);
+
+    /**
+     *  \brief Band matrix vector product, \f$ O(n (k_l + k_u)) \f$.
+     * @param A \f$ n \times n \f$ band matrix
+     * @param U \f$ n \times 1 \f$ (column) vector
+     * @return \f$ n \times 1 \f$ (column) vector
+     * @throw std::length_error A and U are not of compatible dimension.
+     * @throw std::invalid_argument U is not a column vector.
+     */
+    vector operator*(const band_matrix &A, const vector &U);
+
+    std::ostream &operator<<(std::ostream &stream, const band_matrix &A);
+}
+
+#endif //LINEARALGEBRA_BANDMATRIX_HPP
@@ -0,0 +1,440 @@
+#include <algorithm>
+#include <cmath>
+#include "parallel.hpp"
+#include "block_sparse_matrix.hpp"
+
+namespace algebra_lib {
+    namespace {
+        /*
+         * Kernels are templates on the block size, Fixed = 0 meaning the size is only known
+         * at run time. With a fixed size all loops over a block have constant trip counts,
+         * so the compiler unrolls and vectorizes them.
+         */
+        template<unsigned int Fixed>
+        void MultiplyBlockRows(const block_sparse_matrix &A, contentVectorDouble::const_iterator u,
+                               contentVectorDouble::iterator y, unsigned long first, unsigned long last) {
+            const unsigned int b = Fixed ? Fixed : A.blockSize();
+            const unsigned long *offsets = A.rowOffsets().data();
+            const unsigned int *blockColumns = A.blockColumnIndices().data();
+            const double *values = A.values().data();
+            std::vector<double> sum(b);
+            for (unsigned long blockRow = first; blockRow < last; ++blockRow) {
+                std::fill(sum.begin(), sum.end(), 0.0);
+                for (unsigned long block = offsets[blockRow]; block < offsets[blockRow + 1]; ++block) {
+                    const double *a = values + block * b * b;
+                    auto x = u + static_cast<long>(blockColumns[block]) * b;
+                    for (unsigned int row = 0; row < b; ++row) {
+                        double s = 0.0;
+                        for (unsigned int column = 0; column < b; ++column) {
+                            s += a[row * b + column] * x[column];
+                        }
+                        sum[row] += s;
+                    }
+                }
+                std::copy(sum.begin(), sum.end(), y + static_cast<long>(blockRow) * b);
+            }
+        }
+
+        /*
+         * C += A B for b x b row major blocks.
+         */
+        template<unsigned int Fixed>
+        void BlockMultiplyAdd(const double *a, const double *bBlock, double *c, unsigned int blockSize) {
+            const unsigned int b = Fixed ? Fixed : blockSize;
+            for (unsigned int row = 0; row < b; ++row) {
+                for (unsigned int k = 0; k < b; ++k) {
+                    double factor = a[row * b + k];
+                    for (unsigned int column = 0; column < b; ++column) {
+                        c[row * b + column] += factor * bBlock[k * b + column];
+                    }
+                }
+            }
+        }
+
+        typedef void (*blockRowKernel)(const block_sparse_matrix &, contentVectorDouble::const_iterator,
+                                       contentVectorDouble::iterator, unsigned long, unsigned long);
+
+        typedef void (*blockProductKernel)(const double *, const double *, double *, unsigned int);
+
+        blockRowKernel SelectRowKernel(unsigned int blockSize) {
+            switch (blockSize) {
+                case 1: return MultiplyBlockRows<1>;
+                case 2: return MultiplyBlockRows<2>;
+                case 3: return MultiplyBlockRows<3>;
+                case 4: return MultiplyBlockRows<4>;
+                case 6: return MultiplyBlockRows<6>;
+                case 8: return MultiplyBlockRows<8>;
+                default: return MultiplyBlockRows<0>;
+            }
+        }
+
+        blockProductKernel SelectProductKernel(unsigned int blockSize) {
+            switch (blockSize) {
+                case 1: return BlockMultiplyAdd<1>;
+                case 2: return BlockMultiplyAdd<2>;
+                case 3: return BlockMultiplyAdd<3>;
+                case 4: return BlockMultiplyAdd<4>;
+                case 6: return BlockMultiplyAdd<6>;
+                case 8: return BlockMultiplyAdd<8>;
+                default: return BlockMultiplyAdd<0>;
+            }
+        }
+
+        /*
+         * C -= A B^T for b x b row major blocks.
+         */
+        void BlockSubtractTransposedProduct(const double *a, const double *bBlock, double *c, unsigned int b) {
+            for (unsigned int row = 0; row < b; ++row) {
+                for (unsigned int column = 0; column < b; ++column) {
+                    double sum = 0.0;
+                    for (unsigned int k = 0; k < b; ++k) {
+                        sum += a[row * b + k] * bBlock[column * b + k];
+                    }
+                    c[row * b + column] -= sum;
+                }
+            }
+        }
+
+        /*
+         * X = X L^{-T} in place, L a lower triangular b x b block: forward substitution
+         * with L for every row of X.
+         */
+        void BlockSolveTransposed(double *x, const double *l, unsigned int b) {
+            for (unsigned int row = 0; row < b; ++row) {
+                double *xRow = x + row * b;
+                for (unsigned int column = 0; column < b; ++column) {
+                    double sum = xRow[column];
+                    for (unsigned int k = 0; k < column; ++k) {
+                        sum -= l[column * b + k] * xRow[k];
+                    }
+                    xRow[column] = sum / l[column * b + column];
+                }
+            }
+        }
+
+        /*
+         * Dense Cholesky of a b x b block in place, using its lower triangle. Zeroes the
+         * upper triangle.
+         */
+        void BlockCholesky(double *d, unsigned int b) {
+            for (unsigned int row = 0; row < b; ++row) {
+                for (unsigned int column = 0; column <= row; ++column) {
+                    double sum = d[row * b + column];
+                    for (unsigned int k = 0; k < column; ++k) {
+                        sum -= d[row * b + k] * d[column * b + k];
+                    }
+                    if (column < row) {
+                        d[row * b + column] = sum / d[column * b + column];
+                    } else if (sum > 0) {
+                        d[row * b + column] = sqrt(sum);
+                    } else {
+                        throw std::domain_error("Cholesky decomposition: matrix is not positive definite.");
+                    }
+                }
+                for (unsigned int column = row + 1; column < b; ++column) {
+                    d[row * b + column] = 0.0;
+                }
+            }
+        }
+    }
+
+    block_sparse_matrix::block_sparse_matrix(unsigned int blockRows, unsigned int blockColumns,
+                                             unsigned int blockSize)
+            : _blockRows(blockRows), _blockColumns(blockColumns), _blockSize(blockSize), _lastBlockRow(0),
+              _rowOffsets(blockRows + 1, 0) {
+        if (blockSize == 0) {
+            throw std::invalid_argument("Block sparse matrix: block size must be positive.");
+        }
+    }
+
+    block_sparse_matrix::block_sparse_matrix(const sparse_matrix &A, unsigned int blockSize)
+            : block_sparse_matrix(blockSize ? A.rows() / blockSize : 0, blockSize ? A.columns() / blockSize : 0,
+                                  blockSize) {
+        if (A.rows() % blockSize != 0 or A.columns() % blockSize != 0) {
+            throw std::invalid_argument(
+                    "Block sparse matrix: block size doesn't divide the dimensions of the matrix.");
+        }
+
+        const unsigned int b = blockSize;
+        std::vector<const sparse_vector *> storedRows(A.rows(), nullptr);
+        for (auto const &row : A) {
+            storedRows[row.first] = &row.second;
+        }
+
+        // Every block row finds its block columns and fills its blocks independently.
+        std::vector<std::vector<unsigned int>> rowColumns(_blockRows);
+        std::vector<std::vector<double>> rowValues(_blockRows);
+        ParallelFor(0, _blockRows, [&](unsigned long first, unsigned long last) {
+            for (unsigned long blockRow = first; blockRow < last; ++blockRow) {
+                std::vector<unsigned int> &columns = rowColumns[blockRow];
+                for (unsigned int row = 0; row < b; ++row) {
+                    const sparse_vector *Row = storedRows[blockRow * b + row];
+                    if (Row == nullptr) continue;
+                    for (auto const &entry : *Row) {
+                        if (entry.second != 0 and (columns.empty() or columns.back() != entry.first / b))
+                            columns.push_back(entry.first / b);
+                    }
+                }
+                std::sort(columns.begin(), columns.end());
+                columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+
+                std::vector<double> &values = rowValues[blockRow];
+                values.assign(columns.size() * b * b, 0.0);
+                for (unsigned int row = 0; row < b; ++row) {
+                    const sparse_vector *Row = storedRows[blockRow * b + row];
+                    if (Row == nullptr) continue;
+                    std::size_t block = 0;
+                    for (auto const &entry : *Row) {
+                        if (entry.second == 0) continue;
+                        while (columns[block] != entry.first / b) ++block;
+                        values[block * b * b + row * b + entry.first % b] = entry.second;
+                    }
+                }
+            }
+        }, 64);
+
+        for (unsigned int blockRow = 0; blockRow < _blockRows; ++blockRow) {
+            _rowOffsets[blockRow + 1] = _rowOffsets[blockRow] + rowColumns[blockRow].size();
+            if (!rowColumns[blockRow].empty()) _lastBlockRow = blockRow;
+        }
+        _blockColumnIndices.reserve(_rowOffsets[_blockRows]);
+        _values.reserve(_rowOffsets[_blockRows] * b * b);
+        for (unsigned int blockRow = 0; blockRow < _blockRows; ++blockRow) {
+            _blockColumnIndices.insert(_blockColumnIndices.end(), rowColumns[blockRow].begin(),
+                                       rowColumns[blockRow].end());
+            _values.insert(_values.end(), rowValues[blockRow].begin(), rowValues[blockRow].end());
+        }
+    }
+
+    const double *block_sparse_matrix::Block(unsigned int blockRow, unsigned int blockColumn) const {
+        if (blockRow >= _blockRows or blockColumn >= _blockColumns) {
+            throw std::out_of_range("Exceeded matrix bounds");
+        }
+        auto begin = _blockColumnIndices.begin() + _rowOffsets[blockRow];
+        auto end = _blockColumnIndices.begin() + _rowOffsets[blockRow + 1];
+        auto stored = std::lower_bound(begin, end, blockColumn);
+        if (stored == end or *stored != blockColumn) return nullptr;
+        return _values.data() + (stored - _blockColumnIndices.begin()) * _blockSize * _blockSize;
+    }
+
+    double block_sparse_matrix::operator()(unsigned int row, unsigned int column) const {
+        if (row >= rows() or column >= columns()) {
+            throw std::out_of_range("Exceeded matrix bounds");
+        }
+        const double *block = Block(row / _blockSize, column / _blockSize);
+        return block ? block[(row % _blockSize) * _blockSize + column % _blockSize] : 0.0;
+    }
+
+    void block_sparse_matrix::AppendBlock(unsigned int blockRow, unsigned int blockColumn, const double *values) {
+        if (blockRow >= _blockRows or blockColumn >= _blockColumns) {
+            throw std::out_of_range("Exceeded matrix bounds");
+        }
+        unsigned long stored = _blockColumnIndices.size();
+        if (blockRow < _lastBlockRow or
+            (blockRow == _lastBlockRow and stored > 0 and _blockColumnIndices.back() >= blockColumn)) {
+            throw std::invalid_argument("Appending to block sparse matrix: block is not past the last stored block.");
+        }
+        _blockColumnIndices.push_back(blockColumn);
+        _values.insert(_values.end(), values, values + _blockSize * _blockSize);
+        // Rows skipped since the last block are empty. Every row is skipped at most once.
+        for (unsigned int row = _lastBlockRow + 2; row <= blockRow; ++row) {
+            _rowOffsets[row] = stored;
+        }
+        _rowOffsets[blockRow + 1] = stored + 1;
+        _lastBlockRow = blockRow;
+    }
+
+    void block_sparse_matrix::FinishAppending() {
+        for (unsigned int row = _lastBlockRow + 2; row <= _blockRows; ++row) {
+            _rowOffsets[row] = _blockColumnIndices.size();
+        }
+    }
+
+    sparse_matrix block_sparse_matrix::ToSparse() const {
+        const unsigned int b = _blockSize;
+        sparse_matrix Sparse(rows(), columns());
+        for (unsigned int blockRow = 0; blockRow < _blockRows; ++blockRow) {
+            for (unsigned int row = 0; row < b; ++row) {
+                sparse_vector Row(columns(), false);
+                for (unsigned long block = _rowOffsets[blockRow]; block < _rowOffsets[blockRow + 1]; ++block) {
+                    const double *values = _values.data() + block * b * b + row * b;
+                    for (unsigned int column = 0; column < b; ++column) {
+                        if (values[column] != 0)
+                            Row.Append(_blockColumnIndices[block] * b + column, values[column]);
+                    }
+                }
+                if (Row.nonZeros() > 0)
+                    Sparse.AppendRow(blockRow * b + row, std::move(Row));
+            }
+        }
+        return Sparse;
+    }
+
+    block_sparse_matrix block_sparse_matrix::CholeskyDecompose() const {
+        if (_blockRows != _blockColumns) {
+            throw std::length_error("Cholesky decomposition: matrix is not square.");
+        }
+
+        // The up-looking algorithm of symmetric_sparse_matrix::CholeskyDecompose, with
+        // b x b blocks in place of scalars.
+        const unsigned int n = _blockRows;
+        const unsigned int b = _blockSize;
+        const unsigned int area = b * b;
+        std::vector<int> parent(n, -1);
+        std::vector<int> ancestor(n, -1);
+        std::vector<std::vector<std::pair<unsigned int, unsigned long>>> factorColumns(n);
+        std::vector<double> work(static_cast<std::size_t>(n) * area, 0.0);
+        std::vector<unsigned int> mark(n, n);
+        std::vector<unsigned int> pattern(n);
+        std::vector<double> diagonal(area);
+        std::vector<std::pair<unsigned int, unsigned long>> rowBlocks;
+
+        // Blocks of L are kept in one array while factorizing, addressed by their offset.
+        std::vector<double> factor;
+        std::vector<unsigned long> diagonalOffset(n);
+        block_sparse_matrix L(n, n, b);
+
+        for (unsigned int k = 0; k < n; ++k) {
+            unsigned int top = n;
+            mark[k] = k;
+            std::fill(diagonal.begin(), diagonal.end(), 0.0);
+            for (unsigned long block = _rowOffsets[k]; block < _rowOffsets[k + 1]; ++block) {
+                unsigned int i = _blockColumnIndices[block];
+                if (i > k) break;
+                const double *values = _values.data() + block * area;
+                if (i == k) {
+                    std::copy(values, values + area, diagonal.begin());
+                    continue;
+                }
+                for (int node = static_cast<int>(i); node != -1 and node < static_cast<int>(k);) {
+                    int next = ancestor[node];
+                    ancestor[node] = k;
+                    if (next == -1) parent[node] = k;
+                    node = next;
+                }
+                std::copy(values, values + area, work.begin() + static_cast<long>(i) * area);
+                unsigned int length = 0;
+                for (int node = static_cast<int>(i); mark[node] != k; node = parent[node]) {
+                    pattern[length++] = static_cast<unsigned int>(node);
+                    mark[node] = k;
+                }
+                while (length > 0) {
+                    pattern[--top] = pattern[--length];
+                }
+            }
+
+            rowBlocks.clear();
+            for (; top < n; ++top) {
+                unsigned int i = pattern[top];
+                double *x = work.data() + static_cast<std::size_t>(i) * area;
+                // L_ki = X_i L_ii^{-T}
+                BlockSolveTransposed(x, factor.data() + diagonalOffset[i], b);
+                unsigned long offset = factor.size();
+                factor.insert(factor.end(), x, x + area);
+                std::fill(x, x + area, 0.0);
+                const double *lki = factor.data() + offset;
+                for (auto const &entry : factorColumns[i]) {
+                    // X_r -= L_ki L_ri^T
+                    BlockSubtractTransposedProduct(lki, factor.data() + entry.second,
+                                                   work.data() + static_cast<std::size_t>(entry.first) * area, b);
+                }
+                BlockSubtractTransposedProduct(lki, lki, diagonal.data(), b);
+                factorColumns[i].emplace_back(k, offset);
+                rowBlocks.emplace_back(i, offset);
+            }
+            BlockCholesky(diagonal.data(), b);
+            diagonalOffset[k] = factor.size();
+            factor.insert(factor.end(), diagonal.begin(), diagonal.end());
+
+            std::sort(rowBlocks.begin(), rowBlocks.end());
+            for (auto const &entry : rowBlocks) {
+                L.AppendBlock(k, entry.first, factor.data() + entry.second);
+            }
+            L.AppendBlock(k, k, factor.data() + diagonalOffset[k]);
+        }
+        L.FinishAppending();
+        return L;
+    }
+
+    vector operator*(const block_sparse_matrix &A, const vector &U) {
+        if (A.columns() != U.size()) {
+            throw std::length_error(
+                    "Left multiplication with matrix: vector and matrix are not compatible in dimension");
+        } else if (!U.isColumn()) {
+            throw std::invalid_argument(
+                    "Left multiplication with matrix: vector is not a column vector! First transpose it for goodness' sake.");
+        }
+
+        vector Product(A.rows(), true);
+        blockRowKernel kernel = SelectRowKernel(A.blockSize());
+        auto u = U.begin();
+        auto y = Product.begin();
+        ParallelFor(0, A.blockRows(), [&](unsigned long first, unsigned long last) {
+            kernel(A, u, y, first, last);
+        }, 256);
+        return Product;
+    }
+
+    block_sparse_matrix operator*(const block_sparse_matrix &A, const block_sparse_matrix &B) {
+        if (A.columns() != B.rows() or A.blockSize() != B.blockSize()) {
+            throw std::length_error("Matrix multiplication: matrices are not compatible in dimension");
+        }
+
+        const unsigned int b = A.blockSize();
+        const unsigned int area = b * b;
+        blockProductKernel kernel = SelectProductKernel(b);
+        std::vector<std::vector<unsigned int>> rowColumns(A.blockRows());
+        std::vector<std::vector<double>> rowValues(A.blockRows());
+
+        // Every block row accumulates its product blocks in a sparse accumulator indexed
+        // by block column.
+        ParallelFor(0, A.blockRows(), [&](unsigned long first, unsigned long last) {
+            std::vector<long> position(B.blockColumns(), -1);
+            std::vector<unsigned int> touched;
+            std::vector<double> accumulator;
+            for (unsigned long blockRow = first; blockRow < last; ++blockRow) {
+                touched.clear();
+                accumulator.clear();
+                for (unsigned long blockA = A.rowOffsets()[blockRow];
+                     blockA < A.rowOffsets()[blockRow + 1]; ++blockA) {
+                    unsigned int k = A.blockColumnIndices()[blockA];
+                    const double *a = A.values().data() + blockA * area;
+                    for (unsigned long blockB = B.rowOffsets()[k]; blockB < B.rowOffsets()[k + 1]; ++blockB) {
+                        unsigned int column = B.blockColumnIndices()[blockB];
+                        if (position[column] < 0) {
+                            position[column] = static_cast<long>(accumulator.size());
+                            accumulator.resize(accumulator.size() + area, 0.0);
+                            touched.push_back(column);
+                        }
+                        kernel(a, B.values().data() + blockB * area, accumulator.data() + position[column], b);
+                    }
+                }
+
+                std::sort(touched.begin(), touched.end());
+                rowValues[blockRow].reserve(touched.size() * area);
+                for (unsigned int column : touched) {
+                    const double *block = accumulator.data() + position[column];
+                    rowValues[blockRow].insert(rowValues[blockRow].end(), block, block + area);
+                    position[column] = -1;
+                }
+                rowColumns[blockRow] = touched;
+            }
+        }, 64);
+
+        block_sparse_matrix Product(A.blockRows(), B.blockColumns(), b);
+        for (unsigned int blockRow = 0; blockRow < A.blockRows(); ++blockRow) {
+            for (std::size_t block = 0; block < rowColumns[blockRow].size(); ++block) {
+                Product.AppendBlock(blockRow, rowColumns[blockRow][block], rowValues[blockRow].data() + block * area);
+            }
+        }
+        Product.FinishAppending();
+        return Product;
+    }
+
+    std::ostream &operator<<(std::ostream &stream, const block_sparse_matrix &A) {
+        stream << "Block sparse matrix of dimension " << A.rows() << "x" << A.columns() << ", blocks of "
+               << A.blockSize() << "x" << A.blockSize() << ", " << A.blocks() << " stored:" << std::endl;
+        stream << A.ToSparse();
+        return stream;
+    }
+}
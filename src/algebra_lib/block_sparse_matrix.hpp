@@ -0,0 +1,153 @@
+/*! \file block_sparse_matrix.hpp
+ * \brief Block sparse row (BSR) matrices.
+ *
+ * Hessians over parameters that come in groups per body consist of small dense blocks.
+ * Stored as scalar entries, every entry costs a column index and the kernels can't unroll
+ * over a block. block_sparse_matrix stores one column index per dense
+ * \f$ b \times b \f$ block, row major within the block, and its kernels work a block at a
+ * time. Block sizes 1, 2, 3, 4, 6 and 8 get kernels with the size fixed at compile time,
+ * fully unrolled by the compiler; other sizes use a generic kernel.
+ */
+
+#ifndef LINEARALGEBRA_BLOCKSPARSEMATRIX_HPP
+#define LINEARALGEBRA_BLOCKSPARSEMATRIX_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "sparse_matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Class for sparse matrices of dense square blocks, in block compressed rows.
+     */
+    class block_sparse_matrix {
+    public:
+        // Constructors
+        /*!
+         * \brief Matrix without stored blocks.
+         * @param blockRows Number of rows of blocks.
+         * @param blockColumns Number of columns of blocks.
+         * @param blockSize Rows and columns of every block.
+         * @throw std::invalid_argument blockSize is zero.
+         */
+        block_sparse_matrix(unsigned int blockRows = 0, unsigned int blockColumns = 0, unsigned int blockSize = 1);
+
+        /*!
+         * \brief Convert a sparse matrix, storing every block holding a non-zero entry.
+         * @param A Sparse matrix, its dimensions multiples of blockSize.
+         * @param blockSize Rows and columns of every block.
+         * @throw std::invalid_argument blockSize is zero, or doesn't divide the dimensions of A.
+         */
+        block_sparse_matrix(const sparse_matrix &A, unsigned int blockSize);
+
+        // Member functions
+        unsigned int rows() const { return _blockRows * _blockSize; }
+
+        unsigned int columns() const { return _blockColumns * _blockSize; }
+
+        unsigned int blockRows() const { return _blockRows; }
+
+        unsigned int blockColumns() const { return _blockColumns; }
+
+        unsigned int blockSize() const { return _blockSize; }
+
+        /*!
+         * \brief Number of stored blocks.
+         */
+        unsigned long blocks() const { return _blockColumnIndices.size(); }
+
+        /*!
+         * \brief Stored block (blockRow, blockColumn), row major, or nullptr if it isn't stored.
+         * @throw std::out_of_range Block outside matrix.
+         */
+        const double *Block(unsigned int blockRow, unsigned int blockColumn) const;
+
+        /*!
+         * \brief Entry (row, column), zero if its block isn't stored.
+         * @throw std::out_of_range Entry outside matrix.
+         */
+        double operator()(unsigned int row, unsigned int column) const;
+
+        /*!
+         * \brief Store a block behind all stored blocks, which must be in block row major order.
+         *
+         * Only the offsets up to the block row of the block are updated, so appending all
+         * blocks takes time in their number plus blockRows(). Call FinishAppending() after
+         * the last block, before using the matrix.
+         * @param blockRow Block row, not before the block row of the last stored block.
+         * @param blockColumn Block column, past the last stored block if in the same block row.
+         * @param values blockSize() * blockSize() entries, row major.
+         * @throw std::out_of_range Block outside matrix.
+         * @throw std::invalid_argument Block not behind the last stored block.
+         */
+        void AppendBlock(unsigned int blockRow, unsigned int blockColumn, const double *values);
+
+        /*!
+         * \brief Fill in the offsets of the block rows after the last appended block.
+         */
+        void FinishAppending();
+
+        /*!
+         * \brief Convert to a sparse matrix, leaving out zero entries.
+         */
+        sparse_matrix ToSparse() const;
+
+        /*!
+         * \brief Lower block triangular Cholesky factor L, with \f$ A = L L^T \f$.
+         *
+         * Up-looking over block rows, computing only blocks that are structurally non-zero
+         * in L. Reads only the blocks on and below the block diagonal, and the lower
+         * triangle of the diagonal blocks.
+         * @throw std::length_error Matrix is not square.
+         * @throw std::domain_error Matrix is not positive definite.
+         */
+        block_sparse_matrix CholeskyDecompose() const;
+
+        // Raw block compressed row arrays
+        /*!
+         * \brief Offsets of the block rows in blockColumnIndices(), blockRows() + 1 long.
+         */
+        const std::vector<unsigned long> &rowOffsets() const { return _rowOffsets; }
+
+        const std::vector<unsigned int> &blockColumnIndices() const { return _blockColumnIndices; }
+
+        /*!
+         * \brief Entries of the stored blocks, block after block, each row major.
+         */
+        const std::vector<double> &values() const { return _values; }
+
+    private:
+        unsigned int _blockRows;
+        unsigned int _blockColumns;
+        unsigned int _blockSize;
+        // Block row of the last stored block, zero without blocks. Offsets past the next
+        // block row are only filled in by FinishAppending().
+        unsigned int _lastBlockRow;
+        std::vector<unsigned long> _rowOffsets;
+        std::vector<unsigned int> _blockColumnIndices;
+        std::vector<double> _values;
+    };
+
+    /**
+     *  \brief Block sparse matrix vector product.
+     * @param A \f$ m \times n \f$ block sparse matrix
+     * @param U \f$ n \times 1 \f$ (column) vector
+     * @return \f$ m \times 1 \f$ (column) vector
+     * @throw std::length_error A and U are not of compatible dimension.
+     * @throw std::invalid_argument U is not a column vector.
+     */
+    vector operator*(const block_sparse_matrix &A, const vector &U);
+
+    /**
+     *  \brief Block sparse matrix product.
+     * @param A \f$ m \times n \f$ block sparse matrix
+     * @param B \f$ n \times l \f$ block sparse matrix, same block size as A
+     * @return \f$ m \times l \f$ block sparse matrix
+     * @throw std::length_error A and B are not of compatible dimension or block size.
+     */
+    block_sparse_matrix operator*(const block_sparse_matrix &A, const block_sparse_matrix &B);
+
+    std::ostream &operator<<(std::ostream &stream, const block_sparse_matrix &A);
+}
+
+#endif //LINEARALGEBRA_BLOCKSPARSEMATRIX_HPP
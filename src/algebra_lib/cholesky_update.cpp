@@ -0,0 +1,254 @@
+#include <cmath>
+#include <functional>
+#include <queue>
+#include "cholesky_update.hpp"
+
+namespace algebra_lib {
+    namespace {
+        /*
+         * The rotation of column k zeroes x_k against L_kk and turns the diagonal into
+         * sqrt(L_kk^2 + sign x_k^2); below the diagonal it is
+         *     L_ik <- (L_ik + sign s_k x_i) / c_k,  x_i <- c_k x_i - s_k L_ik.
+         * Row i only needs the rotations of the columns before it, so L is swept by rows,
+         * which are contiguous, every row taking the rotations of all columns of W in turn.
+         */
+        void RankUpdate(matrix &L, const matrix &W, double sign) {
+            if (L.rows() != L.columns()) {
+                throw std::length_error("Cholesky update: matrix is not square.");
+            } else if (W.rows() != L.rows()) {
+                throw std::length_error("Cholesky update: factor and update are not compatible in dimension");
+            }
+            const unsigned long n = L.rows();
+            const unsigned long k = W.columns();
+            std::vector<double> cosines(n * k);
+            std::vector<double> sines(n * k);
+
+            // Rotations overwrite a copy, so L is left alone if a downdate fails.
+            matrix Updated = L;
+            auto rows = Updated.begin();
+            auto wRows = W.begin();
+            for (unsigned long i = 0; i < n; ++i) {
+                auto l = rows[i].begin();
+                auto w = wRows[i].begin();
+                for (unsigned long j = 0; j < k; ++j) {
+                    const double *c = cosines.data() + j * n;
+                    const double *s = sines.data() + j * n;
+                    double x = w[j];
+                    for (unsigned long column = 0; column < i; ++column) {
+                        double updated = (l[column] + sign * s[column] * x) / c[column];
+                        x = c[column] * x - s[column] * updated;
+                        l[column] = updated;
+                    }
+
+                    double diagonal = l[i];
+                    double square = diagonal * diagonal + sign * x * x;
+                    if (!(diagonal > 0)) {
+                        throw std::domain_error("Cholesky update: factor has a diagonal entry that is not positive.");
+                    } else if (!(square > 0)) {
+                        throw std::domain_error("Cholesky downdate: result is not positive definite.");
+                    }
+                    double root = std::sqrt(square);
+                    cosines[j * n + i] = root / diagonal;
+                    sines[j * n + i] = x / diagonal;
+                    l[i] = root;
+                }
+            }
+            L = Updated;
+        }
+
+        matrix Column(const vector &W) {
+            matrix Column(W.size(), 1);
+            auto rows = Column.begin();
+            auto w = W.begin();
+            for (unsigned long i = 0; i < W.size(); ++i) {
+                rows[i].begin()[0] = w[i];
+            }
+            return Column;
+        }
+
+        /*
+         * Sparse version of the sweep above, one column of W at a time. Row i changes if
+         * w_i is non-zero or it has an entry in a rotated column, and all such rows lie on
+         * the elimination tree paths from the non-zeros of w, so only those rows are swept,
+         * in increasing order. Once x is non-zero in a row, every later rotated column
+         * fills in. Swept rows are staged and only stored in L when all columns are done.
+         */
+        void RankUpdate(sparse_matrix &L, const std::vector<const sparse_vector *> &Columns, double sign) {
+            if (L.rows() != L.columns()) {
+                throw std::length_error("Cholesky update: matrix is not square.");
+            }
+            const unsigned int n = L.rows();
+            std::vector<const sparse_vector *> storedRows(n, nullptr);
+            std::vector<unsigned int> parent(n, n);
+            for (auto const &row : L) {
+                storedRows[row.first] = &row.second;
+                const unsigned int *indices = row.second.indices();
+                for (unsigned int entry = 0; entry < row.second.nonZeros() and indices[entry] < row.first; ++entry) {
+                    if (parent[indices[entry]] == n) parent[indices[entry]] = row.first;
+                }
+            }
+
+            std::vector<int> stagedSlot(n, -1);
+            std::vector<sparse_vector> staged;
+            std::vector<double> cosines(n);
+            std::vector<double> sines(n);
+            std::vector<double> w(n, 0.0);
+            std::vector<unsigned int> rotated;
+            std::vector<int> rotatedPosition(n, -1);
+            std::vector<unsigned int> queuedStep(n, 0);
+            std::vector<std::pair<unsigned int, double>> entries;
+            std::priority_queue<unsigned int, std::vector<unsigned int>, std::greater<unsigned int>> pending;
+
+            unsigned int step = 0;
+            for (const sparse_vector *Column : Columns) {
+                ++step;
+                const unsigned int *wIndices = Column->indices();
+                const double *wValues = Column->values();
+                for (unsigned int entry = 0; entry < Column->nonZeros(); ++entry) {
+                    w[wIndices[entry]] = wValues[entry];
+                    if (queuedStep[wIndices[entry]] != step) {
+                        queuedStep[wIndices[entry]] = step;
+                        pending.push(wIndices[entry]);
+                    }
+                }
+
+                while (!pending.empty()) {
+                    const unsigned int i = pending.top();
+                    pending.pop();
+                    const sparse_vector *Row = stagedSlot[i] >= 0 ? &staged[stagedSlot[i]] : storedRows[i];
+                    const unsigned int *indices = Row == nullptr ? nullptr : Row->indices();
+                    const double *values = Row == nullptr ? nullptr : Row->values();
+                    const unsigned int stored = Row == nullptr ? 0 : Row->nonZeros();
+
+                    double x = w[i];
+                    unsigned int entry = 0;
+                    unsigned long next = x != 0 ? 0 : rotated.size();
+                    entries.clear();
+                    // Entries before the first rotated column the row has stay as they are.
+                    while (next == rotated.size() and entry < stored and indices[entry] < i) {
+                        if (rotatedPosition[indices[entry]] >= 0) {
+                            next = static_cast<unsigned long>(rotatedPosition[indices[entry]]);
+                        } else {
+                            entries.emplace_back(indices[entry], values[entry]);
+                            ++entry;
+                        }
+                    }
+                    while (next < rotated.size() or (entry < stored and indices[entry] < i)) {
+                        unsigned int column = next < rotated.size() ? rotated[next] : n;
+                        if (entry < stored and indices[entry] < column) {
+                            entries.emplace_back(indices[entry], values[entry]);
+                            ++entry;
+                            continue;
+                        }
+                        double value = 0;
+                        if (entry < stored and indices[entry] == column) value = values[entry++];
+                        double updated = (value + sign * sines[column] * x) / cosines[column];
+                        x = cosines[column] * x - sines[column] * updated;
+                        entries.emplace_back(column, updated);
+                        if (parent[column] > i) parent[column] = i;
+                        ++next;
+                    }
+
+                    double diagonal = entry < stored and indices[entry] == i ? values[entry++] : 0.0;
+                    double square = diagonal * diagonal + sign * x * x;
+                    if (!(diagonal > 0)) {
+                        throw std::domain_error("Cholesky update: factor has a diagonal entry that is not positive.");
+                    } else if (!(square > 0)) {
+                        throw std::domain_error("Cholesky downdate: result is not positive definite.");
+                    }
+                    double root = std::sqrt(square);
+                    entries.emplace_back(i, root);
+                    for (; entry < stored; ++entry) {
+                        entries.emplace_back(indices[entry], values[entry]);
+                    }
+                    if (x != 0) {
+                        cosines[i] = root / diagonal;
+                        sines[i] = x / diagonal;
+                        rotatedPosition[i] = static_cast<int>(rotated.size());
+                        rotated.push_back(i);
+                    }
+
+                    sparse_vector Updated(n, false);
+                    Updated.Reserve(static_cast<unsigned int>(entries.size()));
+                    for (auto const &updated : entries) {
+                        Updated.Append(updated.first, updated.second);
+                    }
+                    if (stagedSlot[i] < 0) {
+                        stagedSlot[i] = static_cast<int>(staged.size());
+                        staged.push_back(std::move(Updated));
+                    } else {
+                        staged[stagedSlot[i]] = std::move(Updated);
+                    }
+
+                    if (parent[i] < n and queuedStep[parent[i]] != step) {
+                        queuedStep[parent[i]] = step;
+                        pending.push(parent[i]);
+                    }
+                }
+
+                for (unsigned int entry = 0; entry < Column->nonZeros(); ++entry) {
+                    w[wIndices[entry]] = 0.0;
+                }
+                for (unsigned int column : rotated) {
+                    rotatedPosition[column] = -1;
+                }
+                rotated.clear();
+            }
+
+            for (unsigned int i = 0; i < n; ++i) {
+                if (stagedSlot[i] >= 0) L(i) = std::move(staged[stagedSlot[i]]);
+            }
+        }
+
+        void RankUpdate(sparse_matrix &L, const sparse_matrix &W, double sign) {
+            if (W.rows() != L.rows()) {
+                throw std::length_error("Cholesky update: factor and update are not compatible in dimension");
+            }
+            const sparse_matrix Columns = W.Transpose();
+            std::vector<const sparse_vector *> columns;
+            for (auto const &column : Columns) {
+                columns.push_back(&column.second);
+            }
+            RankUpdate(L, columns, sign);
+        }
+
+        void RankUpdate(sparse_matrix &L, const sparse_vector &W, double sign) {
+            if (W.size() != L.rows()) {
+                throw std::length_error("Cholesky update: factor and update are not compatible in dimension");
+            }
+            RankUpdate(L, std::vector<const sparse_vector *>(1, &W), sign);
+        }
+    }
+
+    void CholeskyUpdate(matrix &L, const matrix &W) {
+        RankUpdate(L, W, 1.0);
+    }
+
+    void CholeskyUpdate(matrix &L, const vector &W) {
+        RankUpdate(L, Column(W), 1.0);
+    }
+
+    void CholeskyDowndate(matrix &L, const matrix &W) {
+        RankUpdate(L, W, -1.0);
+    }
+
+    void CholeskyDowndate(matrix &L, const vector &W) {
+        RankUpdate(L, Column(W), -1.0);
+    }
+
+    void CholeskyUpdate(sparse_matrix &L, const sparse_matrix &W) {
+        RankUpdate(L, W, 1.0);
+    }
+
+    void CholeskyUpdate(sparse_matrix &L, const sparse_vector &W) {
+        RankUpdate(L, W, 1.0);
+    }
+
+    void CholeskyDowndate(sparse_matrix &L, const sparse_matrix &W) {
+        RankUpdate(L, W, -1.0);
+    }
+
+    void CholeskyDowndate(sparse_matrix &L, const sparse_vector &W) {
+        RankUpdate(L, W, -1.0);
+    }
+}
@@ -0,0 +1,87 @@
+/*! \file cholesky_update.hpp
+ * \brief Rank-k updates and downdates of Cholesky factors.
+ *
+ * Given the factor L of \f$ A = L L^T \f$, these overwrite L with the factor of
+ * \f$ A + W W^T \f$ or \f$ A - W W^T \f$, one column of W after the other, each by a
+ * sequence of rotations that sweeps L once. A dense factor costs \f$ O(n^2 k) \f$ instead
+ * of the \f$ O(n^3) \f$ of factorizing again. A sparse factor only changes in the rows on
+ * the elimination tree paths from the non-zeros of a column of W to the root, so a sparse
+ * column of W touches a small part of L.
+ *
+ * L must be lower triangular with positive diagonal, as returned by CholeskyDecompose.
+ * The columns of W are the vectors added or removed. If a downdate would leave a matrix
+ * that is not positive definite, std::domain_error is thrown and L is left unchanged.
+ */
+
+#ifndef LINEARALGEBRA_CHOLESKYUPDATE_HPP
+#define LINEARALGEBRA_CHOLESKYUPDATE_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "sparse_vector.hpp"
+#include "sparse_matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief L becomes the factor of \f$ L L^T + W W^T \f$.
+     * @param W Matrix of \f$ n \times k \f$.
+     * @throw std::length_error L is not square, or W doesn't have as many rows as L.
+     * @throw std::domain_error A diagonal entry of L is not positive.
+     */
+    void CholeskyUpdate(matrix &L, const matrix &W);
+
+    /*!
+     * \brief L becomes the factor of \f$ L L^T + w w^T \f$.
+     * @throw std::length_error L is not square, or W is not of its dimension.
+     * @throw std::domain_error A diagonal entry of L is not positive.
+     */
+    void CholeskyUpdate(matrix &L, const vector &W);
+
+    /*!
+     * \brief L becomes the factor of \f$ L L^T - W W^T \f$.
+     * @param W Matrix of \f$ n \times k \f$.
+     * @throw std::length_error L is not square, or W doesn't have as many rows as L.
+     * @throw std::domain_error A diagonal entry of L is not positive, or the result is not positive definite.
+     */
+    void CholeskyDowndate(matrix &L, const matrix &W);
+
+    /*!
+     * \brief L becomes the factor of \f$ L L^T - w w^T \f$.
+     * @throw std::length_error L is not square, or W is not of its dimension.
+     * @throw std::domain_error A diagonal entry of L is not positive, or the result is not positive definite.
+     */
+    void CholeskyDowndate(matrix &L, const vector &W);
+
+    /*!
+     * \brief L becomes the factor of \f$ L L^T + W W^T \f$, with the fill the update implies.
+     * @param W Matrix of \f$ n \times k \f$.
+     * @throw std::length_error L is not square, or W doesn't have as many rows as L.
+     * @throw std::domain_error A diagonal entry of L is missing or not positive.
+     */
+    void CholeskyUpdate(sparse_matrix &L, const sparse_matrix &W);
+
+    /*!
+     * \brief L becomes the factor of \f$ L L^T + w w^T \f$, with the fill the update implies.
+     * @throw std::length_error L is not square, or W is not of its dimension.
+     * @throw std::domain_error A diagonal entry of L is missing or not positive.
+     */
+    void CholeskyUpdate(sparse_matrix &L, const sparse_vector &W);
+
+    /*!
+     * \brief L becomes the factor of \f$ L L^T - W W^T \f$.
+     * @param W Matrix of \f$ n \times k \f$.
+     * @throw std::length_error L is not square, or W doesn't have as many rows as L.
+     * @throw std::domain_error A diagonal entry of L is missing or not positive, or the result is not positive definite.
+     */
+    void CholeskyDowndate(sparse_matrix &L, const sparse_matrix &W);
+
+    /*!
+     * \brief L becomes the factor of \f$ L L^T - w w^T \f$.
+     * @throw std::length_error L is not square, or W is not of its dimension.
+     * @throw std::domain_error A diagonal entry of L is missing or not positive, or the result is not positive definite.
+     */
+    void CholeskyDowndate(sparse_matrix &L, const sparse_vector &W);
+}
+
+#endif //LINEARALGEBRA_CHOLESKYUPDATE_HPP
@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cmath>
+#include "parallel.hpp"
+#include "mixed_algebra.hpp"
+#include "conjugate_gradient.hpp"
+
+namespace algebra_lib {
+    namespace {
+        typedef contentVectorDouble::const_iterator readIterator;
+        typedef contentVectorDouble::iterator writeIterator;
+
+        void CheckSystem(const sparse_matrix &A, const vector &B) {
+            if (A.rows() != A.columns()) {
+                throw std::length_error("Conjugate gradient: matrix is not square.");
+            } else if (A.rows() != B.size()) {
+                throw std::length_error("Conjugate gradient: vector and matrix are not compatible in dimension");
+            } else if (!B.isColumn()) {
+                throw std::invalid_argument(
+                        "Conjugate gradient: vector is not a column vector! First transpose it for goodness' sake.");
+            }
+        }
+
+        conjugate_gradient_result Solve(const sparse_matrix &A, const vector &B, vector X, bool warmStart,
+                                        const preconditioner *M, const conjugate_gradient_options &options) {
+            const unsigned long n = A.rows();
+            // Rows and vector entries are split into fixed parts, each summing into its own
+            // slot, so the sums don't depend on how the parts are scheduled.
+            const sparse_row_partition Rows(A);
+            const unsigned long parts = Rows.parts();
+            std::vector<double> partial(parts);
+            auto Total = [&partial]() {
+                double sum = 0.0;
+                for (double value : partial) sum += value;
+                return sum;
+            };
+
+            // q = A p, returning p . q
+            auto Multiply = [&](readIterator p, writeIterator q) {
+                return Rows.MultiplyDot(&p[0], &q[0]);
+            };
+
+            auto Dot = [&](readIterator u, readIterator v) {
+                ParallelFor(0, parts, [&](unsigned long first, unsigned long last) {
+                    for (unsigned long part = first; part < last; ++part) {
+                        double dot = 0.0;
+                        for (unsigned long i = n * part / parts; i < n * (part + 1) / parts; ++i) {
+                            dot += u[i] * v[i];
+                        }
+                        partial[part] = dot;
+                    }
+                });
+                return Total();
+            };
+
+            // x += alpha p and r -= alpha q, returning r . r
+            auto Update = [&](double alpha, writeIterator x, readIterator p, writeIterator r, readIterator q) {
+                ParallelFor(0, parts, [&](unsigned long first, unsigned long last) {
+                    for (unsigned long part = first; part < last; ++part) {
+                        double dot = 0.0;
+                        for (unsigned long i = n * part / parts; i < n * (part + 1) / parts; ++i) {
+                            x[i] += alpha * p[i];
+                            r[i] -= alpha * q[i];
+                            dot += r[i] * r[i];
+                        }
+                        partial[part] = dot;
+                    }
+                });
+                return Total();
+            };
+
+            // p = z + beta p
+            auto Direction = [&](double beta, readIterator z, writeIterator p) {
+                ParallelFor(0, parts, [&](unsigned long first, unsigned long last) {
+                    for (unsigned long part = first; part < last; ++part) {
+                        for (unsigned long i = n * part / parts; i < n * (part + 1) / parts; ++i) {
+                            p[i] = z[i] + beta * p[i];
+                        }
+                    }
+                });
+            };
+
+            vector R(B);
+            vector Q(n, true);
+            vector P(n, true);
+            vector Z(M ? n : 0, true);
+            auto x = X.begin();
+            auto r = R.begin();
+            auto q = Q.begin();
+            auto p = P.begin();
+            auto b = B.begin();
+            if (warmStart) {
+                Multiply(x, q);
+                for (unsigned long i = 0; i < n; ++i) {
+                    r[i] = b[i] - q[i];
+                }
+            }
+            // Without a preconditioner z is r itself.
+            vector &ZR = M ? Z : R;
+            auto z = ZR.begin();
+
+            conjugate_gradient_result Result;
+            Result.iterations = 0;
+            Result.converged = false;
+            double target = options.relativeTolerance * sqrt(Dot(b, b));
+            double rr = Dot(r, r);
+            Result.residualNorm = sqrt(rr);
+            if (options.recordResiduals) Result.residualNorms.push_back(Result.residualNorm);
+
+            if (Result.residualNorm <= target) {
+                Result.converged = true;
+            } else {
+                if (M) M->Apply(R, Z);
+                std::copy(z, z + n, p);
+                double rz = M ? Dot(r, z) : rr;
+                while (Result.iterations < options.maximumIterations) {
+                    double pq = Multiply(p, q);
+                    if (!(pq > 0)) {
+                        throw std::domain_error("Conjugate gradient: matrix is not positive definite.");
+                    }
+                    rr = Update(rz / pq, x, p, r, q);
+                    ++Result.iterations;
+                    Result.residualNorm = sqrt(rr);
+                    if (options.recordResiduals) Result.residualNorms.push_back(Result.residualNorm);
+                    if (Result.residualNorm <= target) {
+                        Result.converged = true;
+                        break;
+                    }
+
+                    if (M) M->Apply(R, Z);
+                    double rzNext = M ? Dot(r, z) : rr;
+                    Direction(rzNext / rz, z, p);
+                    rz = rzNext;
+                }
+            }
+            Result.solution = X;
+            return Result;
+        }
+    }
+
+    conjugate_gradient_result ConjugateGradient(const sparse_matrix &A, const vector &B, const preconditioner *M,
+                                                const conjugate_gradient_options &options) {
+        CheckSystem(A, B);
+        return Solve(A, B, vector(B.size(), true), false, M, options);
+    }
+
+    conjugate_gradient_result ConjugateGradient(const sparse_matrix &A, const vector &B, const vector &X0,
+                                                const preconditioner *M, const conjugate_gradient_options &options) {
+        CheckSystem(A, B);
+        if (X0.size() != B.size()) {
+            throw std::length_error("Conjugate gradient: initial guess and matrix are not compatible in dimension");
+        } else if (!X0.isColumn()) {
+            throw std::invalid_argument(
+                    "Conjugate gradient: initial guess is not a column vector! First transpose it for goodness' sake.");
+        }
+        return Solve(A, B, X0, true, M, options);
+    }
+}
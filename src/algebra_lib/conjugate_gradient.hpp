@@ -0,0 +1,78 @@
+/*! \file conjugate_gradient.hpp
+ * \brief Preconditioned conjugate gradient solver for sparse symmetric positive definite systems.
+ *
+ * Solving through CholeskyDecompose needs the factor in memory, which fills in far beyond
+ * A for large systems. Conjugate gradients only need products with A and applications of
+ * a preconditioner. Every iteration does one parallel product fused with the dot product
+ * it needs, one fused update of solution and residual along with the residual norm, and
+ * one application of the preconditioner, on vectors allocated before the first iteration.
+ */
+
+#ifndef LINEARALGEBRA_CONJUGATEGRADIENT_HPP
+#define LINEARALGEBRA_CONJUGATEGRADIENT_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "sparse_matrix.hpp"
+#include "preconditioner.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Stopping criteria and instrumentation of ConjugateGradient.
+     */
+    struct conjugate_gradient_options {
+        unsigned int maximumIterations;
+        /*!
+         * \brief Stop once \f$ \|b - A x\| \leq \f$ relativeTolerance \f$ \|b\| \f$.
+         */
+        double relativeTolerance;
+        /*!
+         * \brief Keep the residual norm of every iteration in conjugate_gradient_result::residualNorms.
+         */
+        bool recordResiduals;
+
+        conjugate_gradient_options() : maximumIterations(1000), relativeTolerance(1e-8), recordResiduals(false) {}
+    };
+
+    /*!
+     * \brief Solution and convergence history of ConjugateGradient.
+     */
+    struct conjugate_gradient_result {
+        vector solution;
+        unsigned int iterations;
+        /*!
+         * \brief Norm of the residual at the last iteration, as updated by the recurrence.
+         */
+        double residualNorm;
+        bool converged;
+        /*!
+         * \brief Residual norms of the initial guess and of every iteration, if recorded.
+         */
+        std::vector<double> residualNorms;
+    };
+
+    /*!
+     * \brief Solve \f$ A x = b \f$ by preconditioned conjugate gradients, starting from zero.
+     * @param A Symmetric positive definite sparse matrix.
+     * @param B Right hand side, column vector.
+     * @param M Preconditioner, or nullptr for none.
+     * @throw std::length_error A is not square, or A and B are not of compatible dimension.
+     * @throw std::invalid_argument B is not a column vector.
+     * @throw std::domain_error A turns out not to be positive definite.
+     */
+    conjugate_gradient_result ConjugateGradient(const sparse_matrix &A, const vector &B,
+                                                const preconditioner *M = nullptr,
+                                                const conjugate_gradient_options &options = conjugate_gradient_options());
+
+    /*!
+     * \brief Solve \f$ A x = b \f$ by preconditioned conjugate gradients, warm started from X0.
+     * @throw std::length_error A is not square, or A, B and X0 are not of compatible dimension.
+     * @throw std::invalid_argument B or X0 is not a column vector.
+     * @throw std::domain_error A turns out not to be positive definite.
+     */
+    conjugate_gradient_result ConjugateGradient(const sparse_matrix &A, const vector &B, const vector &X0,
+                                                const preconditioner *M = nullptr,
+                                                const conjugate_gradient_options &options = conjugate_gradient_options());
+}
+
+#endif //LINEARALGEBRA_CONJUGATEGRADIENT_HPP
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include "parallel.hpp"
+#include "dense_kernels.hpp"
+
+namespace algebra_lib {
+    namespace {
+        // A panel of B of depthBlock x widthBlock doubles takes 256 kB, about an L2 cache.
+        const unsigned long depthBlock = 128;
+        const unsigned long widthBlock = 256;
+
+        void MultiplyAddRows(unsigned long first, unsigned long last, unsigned long n, unsigned long k, double alpha,
+                             const double *const *A, const double *const *B, double *const *C) {
+            for (unsigned long columnBegin = 0; columnBegin < n; columnBegin += widthBlock) {
+                const unsigned long width = std::min(widthBlock, n - columnBegin);
+                for (unsigned long depthBegin = 0; depthBegin < k; depthBegin += depthBlock) {
+                    const unsigned long depthEnd = std::min(k, depthBegin + depthBlock);
+                    unsigned long i = first;
+                    for (; i + 4 <= last; i += 4) {
+                        double *c0 = C[i] + columnBegin;
+                        double *c1 = C[i + 1] + columnBegin;
+                        double *c2 = C[i + 2] + columnBegin;
+                        double *c3 = C[i + 3] + columnBegin;
+                        const double *a0 = A[i];
+                        const double *a1 = A[i + 1];
+                        const double *a2 = A[i + 2];
+                        const double *a3 = A[i + 3];
+                        unsigned long p = depthBegin;
+                        for (; p + 2 <= depthEnd; p += 2) {
+                            const double *b0 = B[p] + columnBegin;
+                            const double *b1 = B[p + 1] + columnBegin;
+                            const double x0 = alpha * a0[p], y0 = alpha * a0[p + 1];
+                            const double x1 = alpha * a1[p], y1 = alpha * a1[p + 1];
+                            const double x2 = alpha * a2[p], y2 = alpha * a2[p + 1];
+                            const double x3 = alpha * a3[p], y3 = alpha * a3[p + 1];
+                            for (unsigned long j = 0; j < width; ++j) {
+                                const double u = b0[j];
+                                const double v = b1[j];
+                                c0[j] += x0 * u + y0 * v;
+                                c1[j] += x1 * u + y1 * v;
+                                c2[j] += x2 * u + y2 * v;
+                                c3[j] += x3 * u + y3 * v;
+                            }
+                        }
+                        for (; p < depthEnd; ++p) {
+                            const double *b0 = B[p] + columnBegin;
+                            const double x0 = alpha * a0[p];
+                            const double x1 = alpha * a1[p];
+                            const double x2 = alpha * a2[p];
+                            const double x3 = alpha * a3[p];
+                            for (unsigned long j = 0; j < width; ++j) {
+                                const double u = b0[j];
+                                c0[j] += x0 * u;
+                                c1[j] += x1 * u;
+                                c2[j] += x2 * u;
+                                c3[j] += x3 * u;
+                            }
+                        }
+                    }
+                    for (; i < last; ++i) {
+                        double *c = C[i] + columnBegin;
+                        const double *a = A[i];
+                        for (unsigned long p = depthBegin; p < depthEnd; ++p) {
+                            const double *b = B[p] + columnBegin;
+                            const double x = alpha * a[p];
+                            for (unsigned long j = 0; j < width; ++j) {
+                                c[j] += x * b[j];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void MultiplyAdd(unsigned long m, unsigned long n, unsigned long k, double alpha,
+                     const double *const *A, const double *const *B, double *const *C) {
+        if (m == 0 or n == 0 or k == 0 or alpha == 0) return;
+        // Chunks of at least a million multiply-adds, in multiples of the four row kernel.
+        const unsigned long chunk = std::max<unsigned long>(4, (1048576 / (n * k) + 3) / 4 * 4);
+        ParallelFor(0, m, [&](unsigned long first, unsigned long last) {
+            MultiplyAddRows(first, last, n, k, alpha, A, B, C);
+        }, chunk);
+    }
+}
@@ -0,0 +1,30 @@
+/*! \file dense_kernels.hpp
+ * \brief Blocked kernels on rows of full matrices.
+ *
+ * matrix stores every row as its own vector, so a block of a matrix is described by the
+ * address of its first entry in each of its rows. The kernels take such arrays of row
+ * pointers, which lets them work on sub-blocks (as a blocked factorization does) and on
+ * rows that were permuted by swapping pointers, without copying.
+ */
+
+#ifndef LINEARALGEBRA_DENSEKERNELS_HPP
+#define LINEARALGEBRA_DENSEKERNELS_HPP
+
+#include "globals.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief \f$ C \leftarrow C + \alpha A B \f$ for an \f$ m \times k \f$ block A and a \f$ k \times n \f$ block B.
+     *
+     * Rows of C are split over ParallelFor. Within a chunk, B is walked in panels small
+     * enough to stay in cache while four rows of C at a time take two rows of B per pass.
+     * C must not overlap A or B.
+     * @param A m pointers, to the first of k entries in a row of A.
+     * @param B k pointers, to the first of n entries in a row of B.
+     * @param C m pointers, to the first of n entries in a row of C.
+     */
+    void MultiplyAdd(unsigned long m, unsigned long n, unsigned long k, double alpha,
+                     const double *const *A, const double *const *B, double *const *C);
+}
+
+#endif //LINEARALGEBRA_DENSEKERNELS_HPP
@@ -0,0 +1,268 @@
+#include <cmath>
+#include "parallel.hpp"
+#include "diagonal_matrix.hpp"
+
+namespace algebra_lib {
+    diagonal_matrix::diagonal_matrix(unsigned long dimension, double value) : _diagonal(dimension, true) {
+        if (value != 0) {
+            std::fill(_diagonal.begin(), _diagonal.end(), value);
+        }
+    }
+
+    diagonal_matrix::diagonal_matrix(const vector &U) : _diagonal(U) {
+        if (!_diagonal.isColumn()) _diagonal.TransposeSelf();
+    }
+
+    diagonal_matrix::diagonal_matrix(const sparse_vector &U) : _diagonal(U.size(), true) {
+        auto d = _diagonal.begin();
+        for (auto const &entry : U) {
+            d[entry.first] = entry.second;
+        }
+    }
+
+    diagonal_matrix diagonal_matrix::Inverse() const {
+        diagonal_matrix Inverse(rows());
+        auto d = _diagonal.begin();
+        auto inverse = Inverse._diagonal.begin();
+        for (unsigned long i = 0; i < rows(); ++i) {
+            if (d[i] == 0) {
+                throw std::domain_error("Inverting diagonal matrix: zero on the diagonal.");
+            }
+            inverse[i] = 1.0 / d[i];
+        }
+        return Inverse;
+    }
+
+    diagonal_matrix diagonal_matrix::SquareRoot() const {
+        diagonal_matrix Root(rows());
+        auto d = _diagonal.begin();
+        auto root = Root._diagonal.begin();
+        for (unsigned long i = 0; i < rows(); ++i) {
+            if (d[i] < 0) {
+                throw std::domain_error("Square root of diagonal matrix: negative entry on the diagonal.");
+            }
+            root[i] = sqrt(d[i]);
+        }
+        return Root;
+    }
+
+    sparse_matrix diagonal_matrix::ToSparse() const {
+        sparse_matrix Sparse(static_cast<unsigned int>(rows()), static_cast<unsigned int>(columns()));
+        auto d = _diagonal.begin();
+        for (unsigned int i = 0; i < rows(); ++i) {
+            if (d[i] == 0) continue;
+            sparse_vector Row(static_cast<unsigned int>(columns()), false);
+            Row.Append(i, d[i]);
+            Sparse.AppendRow(i, std::move(Row));
+        }
+        return Sparse;
+    }
+
+    matrix diagonal_matrix::ToFull() const {
+        matrix Full(rows(), columns());
+        auto fullRows = Full.begin();
+        auto d = _diagonal.begin();
+        for (unsigned long i = 0; i < rows(); ++i) {
+            fullRows[i].begin()[i] = d[i];
+        }
+        return Full;
+    }
+
+    vector operator*(const diagonal_matrix &D, const vector &U) {
+        if (D.columns() != U.size()) {
+            throw std::length_error(
+                    "Left multiplication with matrix: vector and matrix are not compatible in dimension");
+        } else if (!U.isColumn()) {
+            throw std::invalid_argument(
+                    "Left multiplication with matrix: vector is not a column vector! First transpose it for goodness' sake.");
+        }
+        vector Product(U);
+        return MultiplySelf(D, Product);
+    }
+
+    vector operator*(const vector &U, const diagonal_matrix &D) {
+        if (D.rows() != U.size()) {
+            throw std::length_error(
+                    "Right multiplication with matrix: vector and matrix are not compatible in dimension");
+        } else if (U.isColumn()) {
+            throw std::invalid_argument(
+                    "Right multiplication with matrix: vector is not a row vector! First transpose it for goodness' sake.");
+        }
+        vector Product(U);
+        return MultiplySelf(D, Product);
+    }
+
+    sparse_vector operator*(const diagonal_matrix &D, const sparse_vector &U) {
+        if (D.columns() != U.size()) {
+            throw std::length_error(
+                    "Left multiplication with matrix: vector and matrix are not compatible in dimension");
+        } else if (!U.isColumn()) {
+            throw std::invalid_argument(
+                    "Left multiplication with matrix: vector is not a column vector! First transpose it for goodness' sake.");
+        }
+        sparse_vector Product(U.size(), true);
+        Product.Reserve(U.nonZeros());
+        auto d = D.diagonal().begin();
+        for (auto const &entry : U) {
+            double value = d[entry.first] * entry.second;
+            if (value != 0) Product.Append(entry.first, value);
+        }
+        return Product;
+    }
+
+    matrix operator*(const diagonal_matrix &D, const matrix &A) {
+        if (D.columns() != A.rows()) {
+            throw std::length_error("matrix multiplication: matrices are not compatible in dimension");
+        }
+        matrix Product(A);
+        return MultiplySelf(D, Product);
+    }
+
+    matrix operator*(const matrix &A, const diagonal_matrix &D) {
+        if (A.columns() != D.rows()) {
+            throw std::length_error("matrix multiplication: matrices are not compatible in dimension");
+        }
+        matrix Product(A);
+        auto rows = Product.begin();
+        auto d = D.diagonal().begin();
+        ParallelFor(0, Product.rows(), [&](unsigned long first, unsigned long last) {
+            for (unsigned long row = first; row < last; ++row) {
+                auto product = rows[row].begin();
+                for (unsigned long column = 0; column < D.columns(); ++column) {
+                    product[column] *= d[column];
+                }
+            }
+        }, 64);
+        return Product;
+    }
+
+    sparse_matrix operator*(const diagonal_matrix &D, const sparse_matrix &A) {
+        if (D.columns() != A.rows()) {
+            throw std::length_error("matrix multiplication: matrices are not compatible in dimension");
+        }
+        auto d = D.diagonal().begin();
+        sparse_matrix Product(A.rows(), A.columns());
+        for (auto const &row : A) {
+            double scale = d[row.first];
+            if (scale == 0) continue;
+            sparse_vector Row(A.columns(), false);
+            Row.Reserve(row.second.nonZeros());
+            for (auto const &entry : row.second) {
+                double value = entry.second * scale;
+                if (value != 0) Row.Append(entry.first, value);
+            }
+            if (Row.nonZeros() > 0)
+                Product.AppendRow(row.first, std::move(Row));
+        }
+        return Product;
+    }
+
+    sparse_matrix operator*(const sparse_matrix &A, const diagonal_matrix &D) {
+        if (A.columns() != D.rows()) {
+            throw std::length_error("matrix multiplication: matrices are not compatible in dimension");
+        }
+        auto d = D.diagonal().begin();
+        sparse_matrix Product(A.rows(), A.columns());
+        for (auto const &row : A) {
+            sparse_vector Row(A.columns(), false);
+            Row.Reserve(row.second.nonZeros());
+            for (auto const &entry : row.second) {
+                double value = entry.second * d[entry.first];
+                if (value != 0) Row.Append(entry.first, value);
+            }
+            if (Row.nonZeros() > 0)
+                Product.AppendRow(row.first, std::move(Row));
+        }
+        return Product;
+    }
+
+    diagonal_matrix operator*(const diagonal_matrix &D, const diagonal_matrix &E) {
+        if (D.columns() != E.rows()) {
+            throw std::length_error("matrix multiplication: matrices are not compatible in dimension");
+        }
+        diagonal_matrix Product(D.rows());
+        auto d = D.diagonal().begin();
+        auto e = E.diagonal().begin();
+        for (unsigned long i = 0; i < D.rows(); ++i) {
+            Product[i] = d[i] * e[i];
+        }
+        return Product;
+    }
+
+    diagonal_matrix operator*(const diagonal_matrix &D, double b) {
+        diagonal_matrix Product(D.rows());
+        auto d = D.diagonal().begin();
+        for (unsigned long i = 0; i < D.rows(); ++i) {
+            Product[i] = d[i] * b;
+        }
+        return Product;
+    }
+
+    diagonal_matrix operator*(double b, const diagonal_matrix &D) {
+        return D * b;
+    }
+
+    diagonal_matrix operator+(const diagonal_matrix &D, const diagonal_matrix &E) {
+        if (D.rows() != E.rows()) {
+            throw std::length_error("Matrices are not the same dimension");
+        }
+        diagonal_matrix Sum(D.rows());
+        auto d = D.diagonal().begin();
+        auto e = E.diagonal().begin();
+        for (unsigned long i = 0; i < D.rows(); ++i) {
+            Sum[i] = d[i] + e[i];
+        }
+        return Sum;
+    }
+
+    diagonal_matrix operator-(const diagonal_matrix &D, const diagonal_matrix &E) {
+        if (D.rows() != E.rows()) {
+            throw std::length_error("Matrices are not the same dimension");
+        }
+        diagonal_matrix Difference(D.rows());
+        auto d = D.diagonal().begin();
+        auto e = E.diagonal().begin();
+        for (unsigned long i = 0; i < D.rows(); ++i) {
+            Difference[i] = d[i] - e[i];
+        }
+        return Difference;
+    }
+
+    vector &MultiplySelf(const diagonal_matrix &D, vector &U) {
+        if (D.columns() != U.size()) {
+            throw std::length_error("Multiplication with diagonal matrix: vector and matrix are not compatible in dimension");
+        }
+        auto d = D.diagonal().begin();
+        auto u = U.begin();
+        for (unsigned long i = 0; i < U.size(); ++i) {
+            u[i] *= d[i];
+        }
+        return U;
+    }
+
+    matrix &MultiplySelf(const diagonal_matrix &D, matrix &A) {
+        if (D.columns() != A.rows()) {
+            throw std::length_error("matrix multiplication: matrices are not compatible in dimension");
+        }
+        auto rows = A.begin();
+        auto d = D.diagonal().begin();
+        ParallelFor(0, A.rows(), [&](unsigned long first, unsigned long last) {
+            for (unsigned long row = first; row < last; ++row) {
+                auto a = rows[row].begin();
+                for (unsigned long column = 0; column < A.columns(); ++column) {
+                    a[column] *= d[row];
+                }
+            }
+        }, 64);
+        return A;
+    }
+
+    std::ostream &operator<<(std::ostream &stream, const diagonal_matrix &D) {
+        stream << "Diagonal matrix of dimension " << D.rows() << "x" << D.columns() << ", diagonal:" << std::endl;
+        auto d = D.diagonal().begin();
+        for (unsigned long i = 0; i < D.rows(); ++i) {
+            stream << "row\t" << i + 1 << "\t|\t" << d[i] << std::endl;
+        }
+        return stream;
+    }
+}
@@ -0,0 +1,181 @@
+/*! \file diagonal_matrix.hpp
+ * \brief Diagonal matrices, stored as their diagonal.
+ *
+ * VectorToDiagonal builds a sparse_matrix with a row per diagonal entry, and products
+ * with it go through the generic sparse kernels. diagonal_matrix keeps only the diagonal,
+ * and its products scale the rows or columns of the other operand in one pass.
+ */
+
+#ifndef LINEARALGEBRA_DIAGONALMATRIX_HPP
+#define LINEARALGEBRA_DIAGONALMATRIX_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "sparse_vector.hpp"
+#include "sparse_matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Class for square diagonal matrices.
+     */
+    class diagonal_matrix {
+    public:
+        // Constructors
+        /*!
+         * \brief Multiple of the identity.
+         * @param dimension Rows and columns of the matrix.
+         * @param value Every diagonal entry.
+         */
+        explicit diagonal_matrix(unsigned long dimension = 0, double value = 0.0);
+
+        /*!
+         * \brief Matrix with diagonal U.
+         */
+        explicit diagonal_matrix(const vector &U);
+
+        /*!
+         * \brief Matrix with diagonal U, zero where U stores no entry.
+         */
+        explicit diagonal_matrix(const sparse_vector &U);
+
+        // Member functions
+        unsigned long rows() const { return _diagonal.size(); }
+
+        unsigned long columns() const { return _diagonal.size(); }
+
+        /*!
+         * \brief Diagonal entry (i, i).
+         * @throw std::out_of_range Entry outside matrix.
+         */
+        double &operator[](unsigned long i) { return _diagonal[i]; }
+
+        /*!
+         * \brief Diagonal entry (i, i).
+         * @throw std::out_of_range Entry outside matrix.
+         */
+        double operator[](unsigned long i) const { return _diagonal[i]; }
+
+        /*!
+         * \brief Diagonal as a column vector.
+         */
+        const vector &diagonal() const { return _diagonal; }
+
+        /*!
+         * \brief Inverse, \f$ D^{-1} \f$.
+         * @throw std::domain_error A diagonal entry is zero.
+         */
+        diagonal_matrix Inverse() const;
+
+        /*!
+         * \brief Square root, \f$ D^{1/2} \f$.
+         * @throw std::domain_error A diagonal entry is negative.
+         */
+        diagonal_matrix SquareRoot() const;
+
+        sparse_matrix ToSparse() const;
+
+        matrix ToFull() const;
+
+    private:
+        vector _diagonal;
+    };
+
+    /**
+     *  \brief Diagonal matrix vector product, scaling every entry of U.
+     * @param D \f$ n \times n \f$ diagonal matrix
+     * @param U \f$ n \times 1 \f$ (column) vector
+     * @return \f$ n \times 1 \f$ (column) vector
+     * @throw std::length_error D and U are not of compatible dimension.
+     * @throw std::invalid_argument U is not a column vector.
+     */
+    vector operator*(const diagonal_matrix &D, const vector &U);
+
+    /**
+     *  \brief Vector diagonal matrix product, scaling every entry of U.
+     * @param U \f$ 1 \times n \f$ (row) vector
+     * @param D \f$ n \times n \f$ diagonal matrix
+     * @return \f$ 1 \times n \f$ (row) vector
+     * @throw std::length_error U and D are not of compatible dimension.
+     * @throw std::invalid_argument U is not a row vector.
+     */
+    vector operator*(const vector &U, const diagonal_matrix &D);
+
+    /**
+     *  \brief Diagonal matrix vector product, scaling every stored entry of U.
+     * @param D \f$ n \times n \f$ diagonal matrix
+     * @param U \f$ n \times 1 \f$ (column) sparse vector
+     * @return \f$ n \times 1 \f$ (column) sparse vector
+     * @throw std::length_error D and U are not of compatible dimension.
+     * @throw std::invalid_argument U is not a column vector.
+     */
+    sparse_vector operator*(const diagonal_matrix &D, const sparse_vector &U);
+
+    /**
+     *  \brief Diagonal matrix matrix product, scaling the rows of A.
+     * @param D \f$ m \times m \f$ diagonal matrix
+     * @param A \f$ m \times n \f$ matrix
+     * @return \f$ m \times n \f$ matrix
+     * @throw std::length_error D and A are not of compatible dimension.
+     */
+    matrix operator*(const diagonal_matrix &D, const matrix &A);
+
+    /**
+     *  \brief Matrix diagonal matrix product, scaling the columns of A.
+     * @param A \f$ m \times n \f$ matrix
+     * @param D \f$ n \times n \f$ diagonal matrix
+     * @return \f$ m \times n \f$ matrix
+     * @throw std::length_error A and D are not of compatible dimension.
+     */
+    matrix operator*(const matrix &A, const diagonal_matrix &D);
+
+    /**
+     *  \brief Diagonal matrix sparse matrix product, scaling the rows of A.
+     *
+     *  Entries that become zero are not stored, on either side.
+     * @param D \f$ m \times m \f$ diagonal matrix
+     * @param A \f$ m \times n \f$ sparse matrix
+     * @return \f$ m \times n \f$ sparse matrix
+     * @throw std::length_error D and A are not of compatible dimension.
+     */
+    sparse_matrix operator*(const diagonal_matrix &D, const sparse_matrix &A);
+
+    /**
+     *  \brief Sparse matrix diagonal matrix product, scaling the columns of A.
+     *
+     *  Entries that become zero are not stored, on either side.
+     * @param A \f$ m \times n \f$ sparse matrix
+     * @param D \f$ n \times n \f$ diagonal matrix
+     * @return \f$ m \times n \f$ sparse matrix
+     * @throw std::length_error A and D are not of compatible dimension.
+     */
+    sparse_matrix operator*(const sparse_matrix &A, const diagonal_matrix &D);
+
+    diagonal_matrix operator*(const diagonal_matrix &D, const diagonal_matrix &E);
+
+    diagonal_matrix operator*(const diagonal_matrix &D, double b);
+
+    diagonal_matrix operator*(double b, const diagonal_matrix &D);
+
+    diagonal_matrix operator+(const diagonal_matrix &D, const diagonal_matrix &E);
+
+    diagonal_matrix operator-(const diagonal_matrix &D, const diagonal_matrix &E);
+
+    /*!
+     * \brief Scale U by D in place, without allocating.
+     * @return U
+     * @throw std::length_error D and U are not of compatible dimension.
+     */
+    vector &MultiplySelf(const diagonal_matrix &D, vector &U);
+
+    /*!
+     * \brief Scale the rows of A by D in place.
+     * @return A
+     * @throw std::length_error D and A are not of compatible dimension.
+     */
+    matrix &MultiplySelf(const diagonal_matrix &D, matrix &A);
+
+    std::ostream &operator<<(std::ostream &stream, const diagonal_matrix &D);
+}
+
+#endif //LINEARALGEBRA_DIAGONALMATRIX_HPP
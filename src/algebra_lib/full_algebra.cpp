@@ -5,6 +5,7 @@
 #include <iomanip>
 #include "globals.hpp"
 #include "full_algebra.hpp"
+#include "dense_kernels.hpp"
 
 namespace algebra_lib {
 
@@ -55,12 +56,22 @@ namespace algebra_lib {
         }
 
         matrix Product(A.rows(), B.columns());
-
-        for (int row = 0; row < Product.rows(); ++row) {
-            for (int column = 0; column < Product.columns(); ++column) {
-                Product[row][column] = A[row] * B.getColumn(column);
-            }
+        if (A.rows() == 0 or A.columns() == 0 or B.columns() == 0) return Product;
+
+        std::vector<const double *> aRows(A.rows());
+        std::vector<const double *> bRows(B.rows());
+        std::vector<double *> productRows(Product.rows());
+        auto a = A.begin();
+        auto b = B.begin();
+        auto product = Product.begin();
+        for (unsigned long row = 0; row < A.rows(); ++row) {
+            aRows[row] = &a[row].begin()[0];
+            productRows[row] = &product[row].begin()[0];
+        }
+        for (unsigned long row = 0; row < B.rows(); ++row) {
+            bRows[row] = &b[row].begin()[0];
         }
+        MultiplyAdd(A.rows(), B.columns(), A.columns(), 1.0, aRows.data(), bRows.data(), productRows.data());
 
         return Product;
 
@@ -106,7 +117,7 @@ namespace algebra_lib {
 
         vector Product(A.rows(), true);
 
-        for (int i = 0; i < U.size(); ++i) {
+        for (int i = 0; i < A.rows(); ++i) {
             Product[i] = A[i] * U;
         }
         return Product;
@@ -124,7 +135,7 @@ namespace algebra_lib {
 
         vector Product(A.columns(), false);
 
-        for (int i = 0; i < U.size(); ++i) {
+        for (int i = 0; i < A.columns(); ++i) {
             Product[i] = A.getColumn(i) * U;
         }
 
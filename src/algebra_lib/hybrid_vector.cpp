@@ -0,0 +1,179 @@
+#include <atomic>
+#include <cmath>
+#include "full_algebra.hpp"
+#include "sparse_algebra.hpp"
+#include "mixed_algebra.hpp"
+#include "hybrid_vector.hpp"
+
+namespace algebra_lib {
+    namespace {
+        std::atomic<double> densityThreshold(0.2);
+    }
+
+    hybrid_vector::hybrid_vector(unsigned int elements, bool isColumn)
+            : _sparse(elements, isColumn), _full(0ul, isColumn) {
+        _elements = elements;
+        _isColumn = isColumn;
+        _isSparse = true;
+    }
+
+    hybrid_vector::hybrid_vector(const sparse_vector &Vector) : _sparse(Vector), _full(0ul, Vector.isColumn()) {
+        _elements = Vector.size();
+        _isColumn = Vector.isColumn();
+        _isSparse = true;
+        Adapt();
+    }
+
+    hybrid_vector::hybrid_vector(const vector &Vector) : _sparse(0, Vector.isColumn()), _full(Vector) {
+        _elements = static_cast<unsigned int>(Vector.size());
+        _isColumn = Vector.isColumn();
+        _isSparse = false;
+        Adapt();
+    }
+
+    double hybrid_vector::DensityThreshold() {
+        return densityThreshold.load();
+    }
+
+    void hybrid_vector::SetDensityThreshold(double threshold) {
+        if (threshold < 0 or threshold > 1) {
+            throw std::invalid_argument("Hybrid vector: density threshold must lie in [0, 1].");
+        }
+        densityThreshold.store(threshold);
+    }
+
+    unsigned int hybrid_vector::nonZeros() const {
+        return _isSparse ? _sparse.nonZeros() : static_cast<unsigned int>(NonZeros(_full));
+    }
+
+    double hybrid_vector::operator[](unsigned int i) const {
+        return _isSparse ? _sparse[i] : _full[i];
+    }
+
+    void hybrid_vector::Set(unsigned int i, double value) {
+        if (_isSparse) {
+            if (value != 0) {
+                _sparse(i) = value;
+            } else if (i >= _elements) {
+                throw std::out_of_range("Exceeded number of elements");
+            } else {
+                _sparse.eraseEntry(i);
+            }
+        } else {
+            _full[i] = value;
+        }
+    }
+
+    sparse_vector hybrid_vector::ToSparse() const {
+        return _isSparse ? _sparse : algebra_lib::ToSparse(_full);
+    }
+
+    vector hybrid_vector::ToFull() const {
+        return _isSparse ? algebra_lib::ToFull(_sparse) : _full;
+    }
+
+    hybrid_vector hybrid_vector::Transpose() const {
+        hybrid_vector T = (*this);
+        T._isColumn = !_isColumn;
+        T._sparse.TransposeSelf();
+        T._full.TransposeSelf();
+        return T;
+    }
+
+    hybrid_vector hybrid_vector::Normalize() const {
+        return (*this) / sqrt((*this) * (*this));
+    }
+
+    hybrid_vector &hybrid_vector::Adapt() {
+        double threshold = DensityThreshold();
+        if (_isSparse) {
+            if (_sparse.nonZeros() > threshold * _elements) {
+                _full = algebra_lib::ToFull(_sparse);
+                _sparse = sparse_vector(0, _isColumn);
+                _isSparse = false;
+            }
+        } else if (NonZeros(_full) < 0.5 * threshold * _elements) {
+            _sparse = algebra_lib::ToSparse(_full);
+            _full = vector(0ul, _isColumn);
+            _isSparse = true;
+        }
+        return (*this);
+    }
+
+    double operator*(const hybrid_vector &U, const hybrid_vector &V) {
+        if (U.size() != V.size()) throw std::length_error("Vectors are not the same dimension");
+
+        if (U.isSparse()) {
+            return V.isSparse() ? U.sparse() * V.sparse() : U.sparse() * V.full();
+        }
+        return V.isSparse() ? U.full() * V.sparse() : U.full() * V.full();
+    }
+
+    hybrid_vector operator+(const hybrid_vector &U, const hybrid_vector &V) {
+        if (U.size() != V.size()) throw std::length_error("Vectors are not the same dimension");
+
+        if (U.isSparse()) {
+            if (V.isSparse())
+                return hybrid_vector(U.sparse() + V.sparse());
+            return hybrid_vector(U.sparse() + V.full());
+        }
+        if (V.isSparse())
+            return hybrid_vector(U.full() + V.sparse());
+        return hybrid_vector(U.full() + V.full());
+    }
+
+    hybrid_vector operator-(const hybrid_vector &U, const hybrid_vector &V) {
+        if (U.size() != V.size()) throw std::length_error("Vectors are not the same dimension");
+
+        if (U.isSparse()) {
+            if (V.isSparse())
+                return hybrid_vector(U.sparse() - V.sparse());
+            return hybrid_vector(U.sparse() - V.full());
+        }
+        if (V.isSparse())
+            return hybrid_vector(U.full() - V.sparse());
+        return hybrid_vector(U.full() - V.full());
+    }
+
+    hybrid_vector operator*(const hybrid_vector &U, double m) {
+        return U.isSparse() ? hybrid_vector(U.sparse() * m) : hybrid_vector(U.full() * m);
+    }
+
+    hybrid_vector operator*(double m, const hybrid_vector &U) {
+        return U * m;
+    }
+
+    hybrid_vector operator/(const hybrid_vector &U, double m) {
+        return U.isSparse() ? hybrid_vector(U.sparse() / m) : hybrid_vector(U.full() / m);
+    }
+
+    hybrid_vector ElementWiseMultiplication(const hybrid_vector &U, const hybrid_vector &V) {
+        if (U.size() != V.size()) throw std::length_error("Vectors are not the same dimension");
+
+        if (U.isSparse()) {
+            if (V.isSparse())
+                return hybrid_vector(ElementWiseMultiplication(U.sparse(), V.sparse()));
+            return hybrid_vector(ElementWiseMultiplication(U.sparse(), V.full()));
+        }
+        if (V.isSparse()) {
+            sparse_vector Product = ElementWiseMultiplication(V.sparse(), U.full());
+            if (Product.isColumn() != U.isColumn()) Product.TransposeSelf();
+            return hybrid_vector(Product);
+        }
+        return hybrid_vector(ElementWiseMultiplication(U.full(), V.full()));
+    }
+
+    hybrid_vector operator*(const sparse_matrix &A, const hybrid_vector &U) {
+        return U.isSparse() ? hybrid_vector(A * U.sparse()) : hybrid_vector(A * U.full());
+    }
+
+    std::ostream &operator<<(std::ostream &stream, const hybrid_vector &Vector) {
+        stream << "Hybrid vector, stored " << (Vector.isSparse() ? "sparse" : "full") << ". ";
+        if (Vector.isSparse()) {
+            stream << Vector.sparse();
+        } else {
+            stream << Vector.full();
+        }
+        return stream;
+    }
+}
@@ -0,0 +1,149 @@
+/*! \file hybrid_vector.hpp
+ * \brief Vector switching between sparse and full storage depending on its density.
+ *
+ * A sparse_vector costs many times the memory and time of a full vector once a large
+ * fraction of its entries is non-zero. A hybrid_vector stores its entries in whichever
+ * representation suits its current density, and re-evaluates that choice after every
+ * operation. Callers of the operators below never see which one is used.
+ */
+
+#ifndef LINEARALGEBRA_HYBRIDVECTOR_HPP
+#define LINEARALGEBRA_HYBRIDVECTOR_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "sparse_vector.hpp"
+#include "sparse_matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Class for vectors with automatic sparse or full storage.
+     */
+    class hybrid_vector {
+    public:
+        // Constructors
+        /*!
+         * \brief Zero vector, stored sparse.
+         * @param elements Number of dimensions of vector.
+         * @param isColumn True if vector is a column vector.
+         */
+        explicit hybrid_vector(unsigned int elements = 0, bool isColumn = true);
+
+        /*!
+         * \brief Wrap a sparse vector. Converted to full storage if it is dense enough.
+         */
+        explicit hybrid_vector(const sparse_vector &Vector);
+
+        /*!
+         * \brief Wrap a full vector. Converted to sparse storage if it is sparse enough.
+         */
+        explicit hybrid_vector(const vector &Vector);
+
+        // Density threshold
+        /*!
+         * \brief Fraction of non-zero entries above which vectors are stored full.
+         *
+         * Full vectors only go back to sparse storage below half this fraction, so vectors
+         * near the threshold don't flip representation on every operation.
+         */
+        static double DensityThreshold();
+
+        /*!
+         * \brief Set the fraction of non-zero entries above which vectors are stored full.
+         * @throw std::invalid_argument threshold outside [0, 1].
+         */
+        static void SetDensityThreshold(double threshold);
+
+        // Member functions
+        unsigned int size() const { return _elements; }
+
+        bool isColumn() const { return _isColumn; }
+
+        /*!
+         * \brief True if entries are currently stored in a sparse_vector.
+         */
+        bool isSparse() const { return _isSparse; }
+
+        /*!
+         * \brief Number of non-zero entries.
+         */
+        unsigned int nonZeros() const;
+
+        double operator[](unsigned int i) const;
+
+        /*!
+         * \brief Set a single entry. Doesn't change the representation.
+         */
+        void Set(unsigned int i, double value);
+
+        sparse_vector ToSparse() const;
+
+        vector ToFull() const;
+
+        /*!
+         * \brief Sparse storage, only valid if isSparse().
+         */
+        const sparse_vector &sparse() const { return _sparse; }
+
+        /*!
+         * \brief Full storage, only valid if not isSparse().
+         */
+        const vector &full() const { return _full; }
+
+        hybrid_vector Transpose() const;
+
+        hybrid_vector Normalize() const;
+
+        /*!
+         * \brief Re-evaluate the representation against the density threshold.
+         */
+        hybrid_vector &Adapt();
+
+    private:
+        unsigned int _elements;
+        bool _isColumn;
+        bool _isSparse;
+        sparse_vector _sparse;
+        vector _full;
+    };
+
+    /**
+     * \brief Vector dot product.
+     * @throw std::length_error U and V are not of compatible dimension.
+     */
+    double operator*(const hybrid_vector &U, const hybrid_vector &V);
+
+    /**
+     * \brief Vector sum.
+     * @throw std::length_error U and V are not of compatible dimension.
+     */
+    hybrid_vector operator+(const hybrid_vector &U, const hybrid_vector &V);
+
+    /**
+     * \brief Vector difference.
+     * @throw std::length_error U and V are not of compatible dimension.
+     */
+    hybrid_vector operator-(const hybrid_vector &U, const hybrid_vector &V);
+
+    hybrid_vector operator*(const hybrid_vector &U, double m);
+
+    hybrid_vector operator*(double m, const hybrid_vector &U);
+
+    hybrid_vector operator/(const hybrid_vector &U, double m);
+
+    hybrid_vector ElementWiseMultiplication(const hybrid_vector &U, const hybrid_vector &V);
+
+    /**
+     *  \brief Matrix vector product.
+     * @param A \f$ m \times n \f$ sparse matrix
+     * @param U \f$ n \times 1 \f$ (column) vector
+     * @return \f$ m \times 1 \f$ (column) vector
+     * @throw std::length_error A and U are not of compatible dimension.
+     * @throw std::invalid_argument U is not a column vector.
+     */
+    hybrid_vector operator*(const sparse_matrix &A, const hybrid_vector &U);
+
+    std::ostream &operator<<(std::ostream &stream, const hybrid_vector &Vector);
+}
+
+#endif //LINEARALGEBRA_HYBRIDVECTOR_HPP
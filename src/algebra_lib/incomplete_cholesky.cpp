@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include "incomplete_cholesky.hpp"
+
+namespace algebra_lib {
+    namespace {
+        /*
+         * Up-looking factorization, row k of L being the solution of a sparse triangular
+         * system with the rows before it, as in symmetric_sparse_matrix::CholeskyDecompose.
+         * The columns a row depends on are taken from a heap in increasing order, since fill
+         * can add columns while the row is being solved. With zeroFill, updates outside the
+         * pattern of row k of A are discarded instead.
+         */
+        sparse_matrix Factorize(const sparse_matrix &A, bool zeroFill, double dropTolerance,
+                                unsigned int maximumFill, double diagonalShift) {
+            if (A.rows() != A.columns()) {
+                throw std::length_error("Incomplete Cholesky decomposition: matrix is not square.");
+            }
+
+            const unsigned int n = A.rows();
+            std::vector<const sparse_vector *> storedRows(n, nullptr);
+            for (auto const &row : A) {
+                storedRows[row.first] = &row.second;
+            }
+
+            std::vector<std::vector<std::pair<unsigned int, double>>> factorColumns(n);
+            std::vector<double> diagonal(n, 0.0);
+            std::vector<double> work(n, 0.0);
+            // Row k has marked a column when it is queued for it; pattern marks the columns
+            // of row k of A.
+            std::vector<unsigned int> queued(n, n);
+            std::vector<unsigned int> pattern(n, n);
+            std::priority_queue<unsigned int, std::vector<unsigned int>, std::greater<unsigned int>> columns;
+            std::vector<std::pair<unsigned int, double>> rowEntries;
+
+            sparse_matrix L(n, n);
+            for (unsigned int k = 0; k < n; ++k) {
+                double d = 0.0;
+                double rowNorm = 0.0;
+                if (storedRows[k] != nullptr) {
+                    for (auto const &entry : *storedRows[k]) {
+                        if (entry.first > k) break;
+                        rowNorm += entry.second * entry.second;
+                        if (entry.first == k) {
+                            d = entry.second * (1.0 + diagonalShift);
+                            continue;
+                        }
+                        work[entry.first] = entry.second;
+                        pattern[entry.first] = k;
+                        queued[entry.first] = k;
+                        columns.push(entry.first);
+                    }
+                }
+                double dropBelow = dropTolerance * sqrt(rowNorm);
+
+                rowEntries.clear();
+                while (!columns.empty()) {
+                    unsigned int j = columns.top();
+                    columns.pop();
+                    double lkj = work[j] / diagonal[j];
+                    work[j] = 0.0;
+                    if (!zeroFill and std::fabs(lkj) < dropBelow) continue;
+                    for (auto const &entry : factorColumns[j]) {
+                        unsigned int r = entry.first;
+                        if (zeroFill and pattern[r] != k) continue;
+                        work[r] -= entry.second * lkj;
+                        if (queued[r] != k) {
+                            queued[r] = k;
+                            columns.push(r);
+                        }
+                    }
+                    rowEntries.emplace_back(j, lkj);
+                }
+
+                if (rowEntries.size() > maximumFill) {
+                    std::nth_element(rowEntries.begin(), rowEntries.begin() + maximumFill, rowEntries.end(),
+                                     [](const std::pair<unsigned int, double> &a,
+                                        const std::pair<unsigned int, double> &b) {
+                                         return std::fabs(a.second) > std::fabs(b.second);
+                                     });
+                    rowEntries.resize(maximumFill);
+                    std::sort(rowEntries.begin(), rowEntries.end());
+                }
+                for (auto const &entry : rowEntries) {
+                    d -= entry.second * entry.second;
+                }
+                if (!(d > 0)) {
+                    throw std::domain_error("Incomplete Cholesky decomposition: pivot is not positive.");
+                }
+                diagonal[k] = sqrt(d);
+
+                sparse_vector Row(n, false);
+                Row.Reserve(static_cast<unsigned int>(rowEntries.size() + 1));
+                for (auto const &entry : rowEntries) {
+                    factorColumns[entry.first].emplace_back(k, entry.second);
+                    Row.Append(entry.first, entry.second);
+                }
+                Row.Append(k, diagonal[k]);
+                L.AppendRow(k, std::move(Row));
+            }
+            return L;
+        }
+    }
+
+    sparse_matrix IncompleteCholesky(const sparse_matrix &A, double diagonalShift) {
+        return Factorize(A, true, 0.0, A.columns(), diagonalShift);
+    }
+
+    sparse_matrix ThresholdIncompleteCholesky(const sparse_matrix &A, double dropTolerance, unsigned int maximumFill,
+                                              double diagonalShift) {
+        return Factorize(A, false, dropTolerance, maximumFill, diagonalShift);
+    }
+}
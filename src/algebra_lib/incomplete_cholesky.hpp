@@ -0,0 +1,51 @@
+/*! \file incomplete_cholesky.hpp
+ * \brief Incomplete Cholesky factorizations of sparse symmetric positive definite matrices.
+ *
+ * A complete factor fills in, so for large systems it doesn't fit in memory. An incomplete
+ * factor L keeps to a prescribed sparsity, with \f$ L L^T \approx A \f$: IC(0) keeps
+ * exactly the pattern of the lower triangle of A, ICT keeps the largest entries of every
+ * row above a threshold. Either makes a preconditioner through
+ * incomplete_cholesky_preconditioner, or a cheap approximate factor of A.
+ *
+ * Both can break down on a non-positive pivot even when A is positive definite. Factorizing
+ * \f$ A + \alpha \mathrm{diag}(A) \f$ for a small shift \f$ \alpha \f$ avoids that.
+ */
+
+#ifndef LINEARALGEBRA_INCOMPLETECHOLESKY_HPP
+#define LINEARALGEBRA_INCOMPLETECHOLESKY_HPP
+
+#include "globals.hpp"
+#include "sparse_matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Zero fill incomplete Cholesky factor, IC(0).
+     *
+     * Reads only the lower triangle of A. The factor has the sparsity of that triangle.
+     * @param A Symmetric positive definite sparse matrix.
+     * @param diagonalShift Factorize \f$ A + \alpha \mathrm{diag}(A) \f$ with this \f$ \alpha \f$.
+     * @return Lower triangular factor L, diagonal included.
+     * @throw std::length_error A is not square.
+     * @throw std::domain_error A pivot is not positive.
+     */
+    sparse_matrix IncompleteCholesky(const sparse_matrix &A, double diagonalShift = 0.0);
+
+    /*!
+     * \brief Incomplete Cholesky factor with threshold dropping, ICT.
+     *
+     * Reads only the lower triangle of A. Entries of row k of L below dropTolerance times
+     * the norm of row k of A are dropped as they are computed, and of the rest only the
+     * maximumFill largest below the diagonal are kept.
+     * @param A Symmetric positive definite sparse matrix.
+     * @param dropTolerance Relative drop tolerance, 0 to drop nothing.
+     * @param maximumFill Maximum number of entries below the diagonal in every row of L.
+     * @param diagonalShift Factorize \f$ A + \alpha \mathrm{diag}(A) \f$ with this \f$ \alpha \f$.
+     * @return Lower triangular factor L, diagonal included.
+     * @throw std::length_error A is not square.
+     * @throw std::domain_error A pivot is not positive.
+     */
+    sparse_matrix ThresholdIncompleteCholesky(const sparse_matrix &A, double dropTolerance = 1e-3,
+                                              unsigned int maximumFill = 20, double diagonalShift = 0.0);
+}
+
+#endif //LINEARALGEBRA_INCOMPLETECHOLESKY_HPP
@@ -0,0 +1,416 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include "parallel.hpp"
+#include "mixed_algebra.hpp"
+#include "tridiagonal_matrix.hpp"
+#include "symmetric_eigen.hpp"
+#include "lanczos.hpp"
+
+namespace algebra_lib {
+    namespace {
+        const double epsilon = std::numeric_limits<double>::epsilon();
+
+        /*
+         * The Krylov basis and the operations on it. Vectors q of the basis are orthonormal in
+         * the inner product of M^-1, and p = M^-1 q is kept alongside, so that inner products
+         * only need M. Without a preconditioner p and q are the same vectors.
+         */
+        class lanczos_process {
+        public:
+            lanczos_process(const sparse_matrix &A, const preconditioner *M)
+                    : _M(M), _n(A.rows()), _rows(A), _U(A.rows(), true), _V(M ? A.rows() : 0, true) {
+                // Rows and entries are split into fixed parts, each summing into its own slot,
+                // so the sums don't depend on how the parts are scheduled.
+                _parts = _rows.parts();
+                _partial.resize(_parts);
+                auto uIterator = _U.begin();
+                _u = &uIterator[0];
+                if (M) {
+                    auto vIterator = _V.begin();
+                    _v = &vIterator[0];
+                } else {
+                    _v = _u;
+                }
+            }
+
+            unsigned long steps() const { return _q.size(); }
+
+            const std::vector<std::vector<double>> &preconditionedBasis() const { return _M ? _p : _q; }
+
+            /*
+             * Fill u with a random vector, orthogonal to the basis, and append it normalized.
+             * Returns false if the basis already spans the whole space.
+             */
+            bool Start(std::mt19937 &generator) {
+                std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+                for (unsigned long i = 0; i < _n; ++i) {
+                    _u[i] = distribution(generator);
+                }
+                if (_M) _M->Apply(_U, _V);
+                const double initial = Norm();
+                OrthogonalizeBasis();
+                const double norm = Norm();
+                if (!(norm > std::sqrt(epsilon) * initial)) return false;
+                Append(norm);
+                return true;
+            }
+
+            /*
+             * u = A q_j - alpha p_j - beta p_(j-1) and v = M u for the last vector j of the basis.
+             * Returns alpha.
+             */
+            double Step(double beta) {
+                const unsigned long j = _q.size() - 1;
+                const double *q = _q[j].data();
+                const double *p = (_M ? _p : _q)[j].data();
+                const double *previous = j > 0 ? (_M ? _p : _q)[j - 1].data() : nullptr;
+                const double alpha = _rows.MultiplyDot(q, _u);
+                ParallelFor(0, _parts, [&](unsigned long first, unsigned long last) {
+                    for (unsigned long part = first; part < last; ++part) {
+                        for (unsigned long i = _n * part / _parts; i < _n * (part + 1) / _parts; ++i) {
+                            _u[i] -= alpha * p[i] + (previous ? beta * previous[i] : 0.0);
+                        }
+                    }
+                });
+                if (_M) _M->Apply(_U, _V);
+                return alpha;
+            }
+
+            /*
+             * Two passes of classical Gram-Schmidt of u against the whole basis.
+             */
+            void OrthogonalizeBasis() {
+                for (unsigned int pass = 0; pass < 2; ++pass) {
+                    Orthogonalize(_q, preconditionedBasis());
+                }
+            }
+
+            /*
+             * One pass of classical Gram-Schmidt of u (and v) against vectors y, with p = M^-1 y.
+             */
+            void Orthogonalize(const std::vector<std::vector<double>> &y, const std::vector<std::vector<double>> &p) {
+                const unsigned long count = y.size();
+                if (count == 0) return;
+                std::vector<double> partial(_parts * count);
+                ParallelFor(0, _parts, [&](unsigned long first, unsigned long last) {
+                    for (unsigned long part = first; part < last; ++part) {
+                        const unsigned long begin = _n * part / _parts;
+                        const unsigned long end = _n * (part + 1) / _parts;
+                        for (unsigned long k = 0; k < count; ++k) {
+                            const double *yk = y[k].data();
+                            double dot = 0.0;
+                            for (unsigned long i = begin; i < end; ++i) {
+                                dot += yk[i] * _u[i];
+                            }
+                            partial[part * count + k] = dot;
+                        }
+                    }
+                });
+                std::vector<double> coefficients(count, 0.0);
+                for (unsigned long part = 0; part < _parts; ++part) {
+                    for (unsigned long k = 0; k < count; ++k) {
+                        coefficients[k] += partial[part * count + k];
+                    }
+                }
+                ParallelFor(0, _parts, [&](unsigned long first, unsigned long last) {
+                    for (unsigned long part = first; part < last; ++part) {
+                        const unsigned long begin = _n * part / _parts;
+                        const unsigned long end = _n * (part + 1) / _parts;
+                        for (unsigned long k = 0; k < count; ++k) {
+                            const double c = coefficients[k];
+                            const double *pk = p[k].data();
+                            for (unsigned long i = begin; i < end; ++i) {
+                                _u[i] -= c * pk[i];
+                            }
+                            if (_M) {
+                                const double *yk = y[k].data();
+                                for (unsigned long i = begin; i < end; ++i) {
+                                    _v[i] -= c * yk[i];
+                                }
+                            }
+                        }
+                    }
+                });
+            }
+
+            /*
+             * Length of u in the inner product of M^-1, that is sqrt(u . v).
+             * @throw std::domain_error M is not positive definite.
+             */
+            double Norm() {
+                ParallelFor(0, _parts, [&](unsigned long first, unsigned long last) {
+                    for (unsigned long part = first; part < last; ++part) {
+                        double dot = 0.0;
+                        for (unsigned long i = _n * part / _parts; i < _n * (part + 1) / _parts; ++i) {
+                            dot += _u[i] * _v[i];
+                        }
+                        _partial[part] = dot;
+                    }
+                });
+                const double square = Total();
+                if (square < 0) {
+                    throw std::domain_error("Lanczos: preconditioner is not positive definite.");
+                }
+                return std::sqrt(square);
+            }
+
+            /*
+             * Append v / beta to the basis, and u / beta to its preconditioned counterpart.
+             */
+            void Append(double beta) {
+                _q.emplace_back(_v, _v + _n);
+                for (double &value : _q.back()) value /= beta;
+                if (_M) {
+                    _p.emplace_back(_u, _u + _n);
+                    for (double &value : _p.back()) value /= beta;
+                }
+            }
+
+            /*
+             * Columns of the basis (or of the preconditioned basis) combined by the coefficients
+             * in the columns of the steps() x count S, as count vectors.
+             */
+            std::vector<std::vector<double>> Combine(const matrix &S, bool preconditioned) const {
+                const std::vector<std::vector<double>> &basis = preconditioned ? preconditionedBasis() : _q;
+                const unsigned long count = S.columns();
+                std::vector<std::vector<double>> y(count, std::vector<double>(_n, 0.0));
+                auto s = S.begin();
+                ParallelFor(0, _n, [&](unsigned long first, unsigned long last) {
+                    for (unsigned long j = 0; j < basis.size(); ++j) {
+                        auto sj = s[j].begin();
+                        const double *b = basis[j].data();
+                        for (unsigned long k = 0; k < count; ++k) {
+                            const double c = sj[k];
+                            double *yk = y[k].data();
+                            for (unsigned long i = first; i < last; ++i) {
+                                yk[i] += c * b[i];
+                            }
+                        }
+                    }
+                }, 4096);
+                return y;
+            }
+
+        private:
+            double Total() const {
+                double sum = 0.0;
+                for (double value : _partial) sum += value;
+                return sum;
+            }
+
+            const preconditioner *_M;
+            unsigned long _n;
+            const sparse_row_partition _rows;
+            unsigned long _parts;
+            std::vector<double> _partial;
+            vector _U;
+            vector _V;
+            double *_u;
+            double *_v;
+            std::vector<std::vector<double>> _q;
+            std::vector<std::vector<double>> _p;
+        };
+
+        /*
+         * Ritz pairs at one end of the spectrum of T_j, ordered from the end inwards, with the
+         * residual bounds beta_j |s_ji|.
+         */
+        struct ritz_pairs {
+            symmetric_eigen_result pairs;
+            std::vector<double> bounds;
+
+            ritz_pairs() = default;
+
+            ritz_pairs(const tridiagonal_matrix &T, double beta, unsigned int count, bool largest) {
+                pairs = SymmetricEigenDecompose(T, count, largest);
+                if (count == 0) return;
+                auto last = pairs.eigenvectors.begin()[T.rows() - 1].begin();
+                for (unsigned int k = 0; k < count; ++k) {
+                    bounds.push_back(std::fabs(beta * last[largest ? count - 1 - k : k]));
+                }
+            }
+
+            unsigned int size() const { return static_cast<unsigned int>(bounds.size()); }
+
+            // Column of the k-th pair from the end.
+            unsigned int column(unsigned int k, bool largest) const { return largest ? size() - 1 - k : k; }
+        };
+    }
+
+    lanczos_result Lanczos(const sparse_matrix &A, const preconditioner *M, const lanczos_options &options) {
+        if (A.rows() != A.columns()) {
+            throw std::length_error("Lanczos: matrix is not square.");
+        }
+        const unsigned long n = A.rows();
+        const unsigned int wanted[2] = {options.smallest, options.largest};
+        const unsigned long total = static_cast<unsigned long>(wanted[0]) + wanted[1];
+        if (total > n) {
+            throw std::invalid_argument("Lanczos: more eigenvalues requested than the dimension.");
+        }
+
+        lanczos_result Result;
+        Result.iterations = 0;
+        Result.converged = true;
+        if (total == 0) {
+            Result.eigenvalues = vector(0, true);
+            return Result;
+        }
+
+        const unsigned long maximumSteps = std::min<unsigned long>(n, std::max<unsigned long>(total,
+                                                                                           options.maximumIterations));
+        lanczos_process Process(A, M);
+        std::mt19937 generator(options.seed);
+        Process.Start(generator);
+
+        std::vector<double> alphas;
+        std::vector<double> betas;
+        double normT = 0.0;
+        // Converged Ritz vectors of either end that the selective variant keeps orthogonal to.
+        std::vector<std::vector<double>> good[2];
+        std::vector<std::vector<double>> goodPreconditioned[2];
+        ritz_pairs Ends[2];
+
+        while (true) {
+            const unsigned long j = Process.steps() - 1;
+            const double alpha = Process.Step(j > 0 ? betas[j - 1] : 0.0);
+            alphas.push_back(alpha);
+            if (options.fullReorthogonalization) {
+                Process.OrthogonalizeBasis();
+            } else {
+                for (unsigned int end = 0; end < 2; ++end) {
+                    Process.Orthogonalize(good[end], M ? goodPreconditioned[end] : good[end]);
+                }
+            }
+            double beta = Process.Norm();
+            normT = std::max(normT, std::fabs(alpha) + beta + (j > 0 ? betas[j - 1] : 0.0));
+
+            // Ritz pairs of T_(j+1). Both ends are watched for the selective variant, at least one
+            // pair further than has converged, since orthogonality is lost to whichever converges.
+            const unsigned long size = j + 1;
+            tridiagonal_matrix T(betas, alphas, betas);
+            unsigned long monitored[2];
+            for (unsigned int end = 0; end < 2; ++end) {
+                monitored[end] = std::min<unsigned long>(wanted[end], size);
+            }
+            if (monitored[0] + monitored[1] > size) monitored[0] = size - monitored[1];
+            if (!options.fullReorthogonalization) {
+                for (unsigned int end = 0; end < 2; ++end) {
+                    const unsigned long room = size - monitored[0] - monitored[1];
+                    if (good[end].size() + 1 > monitored[end]) {
+                        monitored[end] += std::min(room, good[end].size() + 1 - monitored[end]);
+                    }
+                }
+            }
+            for (unsigned int end = 0; end < 2; ++end) {
+                Ends[end] = ritz_pairs(T, beta, static_cast<unsigned int>(monitored[end]), end == 1);
+            }
+
+            if (!options.fullReorthogonalization) {
+                bool grown = false;
+                for (unsigned int end = 0; end < 2; ++end) {
+                    const bool largest = end == 1;
+                    unsigned int k = 0;
+                    while (k < Ends[end].size() and Ends[end].bounds[k] <= std::sqrt(epsilon) * normT) ++k;
+                    if (k <= good[end].size()) continue;
+                    // Pairs good[end].size(), ..., k - 1 from this end have just converged.
+                    const unsigned int fresh = static_cast<unsigned int>(k - good[end].size());
+                    matrix S(size, fresh);
+                    auto s = S.begin();
+                    auto vectors = Ends[end].pairs.eigenvectors.begin();
+                    for (unsigned long i = 0; i < size; ++i) {
+                        for (unsigned int f = 0; f < fresh; ++f) {
+                            s[i][f] = vectors[i][Ends[end].column(good[end].size() + f, largest)];
+                        }
+                    }
+                    for (auto &y : Process.Combine(S, false)) good[end].push_back(std::move(y));
+                    if (M) {
+                        for (auto &y : Process.Combine(S, true)) goodPreconditioned[end].push_back(std::move(y));
+                    }
+                    grown = true;
+                }
+                // The next vector already holds components along the Ritz vectors that just
+                // converged, and is taken orthogonal to them before it joins the basis.
+                if (grown) {
+                    for (unsigned int end = 0; end < 2; ++end) {
+                        Process.Orthogonalize(good[end], M ? goodPreconditioned[end] : good[end]);
+                    }
+                    beta = Process.Norm();
+                }
+            }
+
+            // Converged once every requested Ritz value is, with tolerance no finer than the
+            // precision Ritz values of T can be resolved to.
+            bool converged = size >= total;
+            for (unsigned int end = 0; end < 2 and converged; ++end) {
+                for (unsigned int k = 0; k < wanted[end]; ++k) {
+                    const double theta = Ends[end].pairs.eigenvalues[Ends[end].column(k, end == 1)];
+                    const double tolerance = options.relativeTolerance *
+                                             std::max(std::fabs(theta), std::pow(epsilon, 2.0 / 3.0) * normT);
+                    if (Ends[end].bounds[k] > tolerance) converged = false;
+                }
+            }
+            Result.iterations = static_cast<unsigned int>(size);
+            Result.converged = converged;
+            if (converged or size == maximumSteps) break;
+
+            if (beta <= epsilon * normT) {
+                // An invariant subspace is found: continue from a fresh random vector, with T
+                // decoupled.
+                if (!Process.Start(generator)) break;
+                beta = 0.0;
+            } else {
+                Process.Append(beta);
+            }
+            betas.push_back(beta);
+        }
+
+        // Smallest then largest, both ascending.
+        std::vector<unsigned int> columns[2];
+        for (unsigned int end = 0; end < 2; ++end) {
+            for (unsigned int k = 0; k < wanted[end]; ++k) {
+                columns[end].push_back(Ends[end].column(k, end == 1));
+            }
+            std::sort(columns[end].begin(), columns[end].end());
+        }
+        Result.eigenvalues = vector(total, true);
+        auto eigenvalues = Result.eigenvalues.begin();
+        unsigned long index = 0;
+        for (unsigned int end = 0; end < 2; ++end) {
+            for (unsigned int column : columns[end]) {
+                eigenvalues[index++] = Ends[end].pairs.eigenvalues[column];
+                const unsigned int k = end == 1 ? Ends[end].size() - 1 - column : column;
+                Result.residualBounds.push_back(Ends[end].bounds[k]);
+            }
+        }
+
+        if (options.computeEigenvectors) {
+            const unsigned long size = Process.steps();
+            matrix S(size, total);
+            auto s = S.begin();
+            index = 0;
+            for (unsigned int end = 0; end < 2; ++end) {
+                auto vectors = Ends[end].pairs.eigenvectors.begin();
+                for (unsigned int column : columns[end]) {
+                    for (unsigned long i = 0; i < size; ++i) {
+                        s[i][index] = vectors[i][column];
+                    }
+                    ++index;
+                }
+            }
+            std::vector<std::vector<double>> y = Process.Combine(S, false);
+            Result.eigenvectors = matrix(n, total);
+            auto rows = Result.eigenvectors.begin();
+            for (unsigned long k = 0; k < total; ++k) {
+                double length = 0.0;
+                for (double value : y[k]) length += value * value;
+                length = std::sqrt(length);
+                for (unsigned long i = 0; i < n; ++i) {
+                    rows[i][k] = y[k][i] / length;
+                }
+            }
+        }
+        return Result;
+    }
+}
@@ -0,0 +1,99 @@
+/*! \file lanczos.hpp
+ * \brief Extreme eigenvalues and eigenvectors of sparse symmetric matrices by the Lanczos method.
+ *
+ * The largest and smallest eigenvalues of a large sparse matrix are found long before
+ * SymmetricEigenDecompose could even hold it densely. Lanczos builds an orthonormal basis
+ * of the Krylov space of A and a random start vector, one product with A per step, in
+ * which A is tridiagonal. The extreme eigenvalues of that tridiagonal matrix (Ritz values)
+ * converge to those of A, and the iteration stops once every requested one has a residual
+ * bound within tolerance.
+ *
+ * In floating point the basis loses orthogonality as soon as a Ritz value converges,
+ * which shows as spurious copies of it. Full reorthogonalization against the whole basis
+ * prevents this at \f$ O(n j) \f$ per step j. Selective reorthogonalization (Parlett and
+ * Scott) only orthogonalizes against the Ritz vectors that have converged to the square
+ * root of machine precision, which are the directions orthogonality is lost to.
+ *
+ * With a preconditioner M, the eigenvalues are those of M A, the preconditioned matrix,
+ * iterated in the inner product of \f$ M^{-1} \f$ with one application of M per step.
+ */
+
+#ifndef LINEARALGEBRA_LANCZOS_HPP
+#define LINEARALGEBRA_LANCZOS_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "sparse_matrix.hpp"
+#include "preconditioner.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Requested eigenpairs and stopping criteria of Lanczos.
+     */
+    struct lanczos_options {
+        /*!
+         * \brief Number of largest eigenvalues to find.
+         */
+        unsigned int largest;
+        /*!
+         * \brief Number of smallest eigenvalues to find.
+         */
+        unsigned int smallest;
+        /*!
+         * \brief Lanczos steps at most, further limited by the dimension of A.
+         */
+        unsigned int maximumIterations;
+        /*!
+         * \brief A Ritz value \f$ \theta \f$ has converged once its residual bound is at most relativeTolerance \f$ |\theta| \f$.
+         *
+         * Ritz values near zero are held to relativeTolerance \f$ \epsilon^{2/3} \|T\| \f$ instead.
+         */
+        double relativeTolerance;
+        /*!
+         * \brief Orthogonalize against the whole basis every step, rather than selectively.
+         */
+        bool fullReorthogonalization;
+        bool computeEigenvectors;
+        /*!
+         * \brief Seed of the random start vector.
+         */
+        unsigned int seed;
+
+        lanczos_options() : largest(1), smallest(0), maximumIterations(300), relativeTolerance(1e-8),
+                            fullReorthogonalization(false), computeEigenvectors(false), seed(1) {}
+    };
+
+    /*!
+     * \brief Ritz values and vectors found by Lanczos, with their convergence.
+     */
+    struct lanczos_result {
+        /*!
+         * \brief The smallest eigenvalues followed by the largest, in ascending order.
+         */
+        vector eigenvalues;
+        /*!
+         * \brief Unit eigenvectors in the columns, one per eigenvalue, if they were requested.
+         */
+        matrix eigenvectors;
+        /*!
+         * \brief Residual bound \f$ \beta_j |s_{ji}| \f$ of every eigenvalue.
+         */
+        std::vector<double> residualBounds;
+        unsigned int iterations;
+        bool converged;
+    };
+
+    /*!
+     * \brief Extreme eigenvalues of a symmetric sparse matrix, or of M A, by the Lanczos method.
+     * @param A Symmetric sparse matrix.
+     * @param M Symmetric positive definite preconditioner, or nullptr for none.
+     * @throw std::length_error A is not square.
+     * @throw std::invalid_argument More eigenvalues requested than the dimension of A.
+     * @throw std::domain_error M is not positive definite.
+     */
+    lanczos_result Lanczos(const sparse_matrix &A, const preconditioner *M = nullptr,
+                           const lanczos_options &options = lanczos_options());
+}
+
+#endif //LINEARALGEBRA_LANCZOS_HPP
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include "parallel.hpp"
+#include "mixed_algebra.hpp"
+#include "tridiagonal_matrix.hpp"
+#include "symmetric_eigen.hpp"
+#include "log_determinant.hpp"
+
+namespace algebra_lib {
+    namespace {
+        const double epsilon = std::numeric_limits<double>::epsilon();
+
+        /*
+         * z^T log(A) z / |z|^2 for the unit q by Gauss quadrature with at most steps Lanczos
+         * steps, on the rows of A. Uses q, previous and w as work space.
+         */
+        double LanczosQuadrature(const sparse_row_partition &Rows, unsigned long n, unsigned long steps,
+                                 std::vector<double> &q, std::vector<double> &previous, std::vector<double> &w) {
+            std::vector<double> alphas;
+            std::vector<double> betas;
+            std::fill(previous.begin(), previous.end(), 0.0);
+            double beta = 0.0;
+            double normT = 0.0;
+            while (true) {
+                const double alpha = Rows.MultiplyDot(q.data(), w.data());
+                double length = 0.0;
+                for (unsigned long i = 0; i < n; ++i) {
+                    w[i] -= alpha * q[i] + beta * previous[i];
+                    length += w[i] * w[i];
+                }
+                alphas.push_back(alpha);
+                normT = std::max(normT, std::fabs(alpha) + beta);
+                const double next = std::sqrt(length);
+                // Stop at the step limit, or once the Krylov space is invariant and the quadrature exact.
+                if (alphas.size() == steps or next <= epsilon * normT) break;
+                betas.push_back(next);
+                beta = next;
+                for (unsigned long i = 0; i < n; ++i) {
+                    previous[i] = q[i];
+                    q[i] = w[i] / next;
+                }
+            }
+
+            symmetric_eigen_result Quadrature = SymmetricEigenDecompose(tridiagonal_matrix(betas, alphas, betas));
+            auto first = Quadrature.eigenvectors.begin()[0].begin();
+            auto nodes = Quadrature.eigenvalues.begin();
+            double sum = 0.0;
+            for (unsigned long k = 0; k < alphas.size(); ++k) {
+                if (!(nodes[k] > 0)) {
+                    throw std::domain_error("Stochastic log determinant: matrix is not positive definite.");
+                }
+                sum += first[k] * first[k] * std::log(nodes[k]);
+            }
+            return sum;
+        }
+    }
+
+    double CholeskyLogDeterminant(const matrix &L) {
+        if (L.rows() != L.columns()) {
+            throw std::length_error("Log determinant: factor is not square.");
+        }
+        auto rows = L.begin();
+        double sum = 0.0;
+        for (unsigned long i = 0; i < L.rows(); ++i) {
+            const double diagonal = rows[i].begin()[i];
+            if (!(diagonal > 0)) {
+                throw std::domain_error("Log determinant: factor has a diagonal entry that is not positive.");
+            }
+            sum += std::log(diagonal);
+        }
+        return 2 * sum;
+    }
+
+    double CholeskyLogDeterminant(const sparse_matrix &L) {
+        if (L.rows() != L.columns()) {
+            throw std::length_error("Log determinant: factor is not square.");
+        }
+        double sum = 0.0;
+        unsigned long found = 0;
+        for (auto const &row : L) {
+            const unsigned int *indices = row.second.indices();
+            const unsigned int *end = indices + row.second.nonZeros();
+            const unsigned int *entry = std::lower_bound(indices, end, row.first);
+            const double diagonal = entry != end and *entry == row.first ? row.second.values()[entry - indices] : 0.0;
+            if (!(diagonal > 0)) {
+                throw std::domain_error("Log determinant: factor has a diagonal entry that is not positive.");
+            }
+            sum += std::log(diagonal);
+            ++found;
+        }
+        if (found < L.rows()) {
+            throw std::domain_error("Log determinant: factor has a diagonal entry that is not positive.");
+        }
+        return 2 * sum;
+    }
+
+    log_determinant_estimate StochasticLogDeterminant(const sparse_matrix &A,
+                                                      const stochastic_log_determinant_options &options) {
+        if (A.rows() != A.columns()) {
+            throw std::length_error("Stochastic log determinant: matrix is not square.");
+        } else if (options.probes == 0 or options.lanczosSteps == 0) {
+            throw std::invalid_argument("Stochastic log determinant: needs at least one probe and one Lanczos step.");
+        }
+        log_determinant_estimate Estimate;
+        Estimate.value = 0.0;
+        Estimate.standardError = 0.0;
+        const unsigned long n = A.rows();
+        if (n == 0) return Estimate;
+
+        // Probes are the parallel dimension, so every product runs as a single part.
+        const sparse_row_partition Rows(A, 1);
+        const unsigned long steps = std::min<unsigned long>(n, options.lanczosSteps);
+
+        // One sample per probe, each in its own slot, so the mean doesn't depend on scheduling.
+        std::vector<double> samples(options.probes);
+        ParallelFor(0, options.probes, [&](unsigned long first, unsigned long last) {
+            std::vector<double> q(n), previous(n), w(n);
+            for (unsigned long probe = first; probe < last; ++probe) {
+                std::seed_seq sequence{options.seed, static_cast<unsigned int>(probe)};
+                std::mt19937 generator(sequence);
+                // Rademacher entries, so |z|^2 = n and q = z / sqrt(n).
+                const double entry = 1 / std::sqrt(static_cast<double>(n));
+                for (unsigned long i = 0; i < n; ++i) {
+                    q[i] = generator() & 1u ? entry : -entry;
+                }
+                samples[probe] = n * LanczosQuadrature(Rows, n, steps, q, previous, w);
+            }
+        });
+
+        for (double sample : samples) Estimate.value += sample;
+        Estimate.value /= options.probes;
+        if (options.probes > 1) {
+            double variance = 0.0;
+            for (double sample : samples) {
+                variance += (sample - Estimate.value) * (sample - Estimate.value);
+            }
+            variance /= options.probes - 1;
+            Estimate.standardError = std::sqrt(variance / options.probes);
+        }
+        return Estimate;
+    }
+}
@@ -0,0 +1,82 @@
+/*! \file log_determinant.hpp
+ * \brief Logarithms of determinants of symmetric positive definite matrices.
+ *
+ * The determinant of a large matrix over- or underflows long before its logarithm does,
+ * so \f$ \log |A| = 2 \sum_i \log L_{ii} \f$ is summed from the diagonal of a Cholesky
+ * factor L directly, never through the product of the diagonal.
+ *
+ * Matrices too large to factorize are estimated by stochastic Lanczos quadrature:
+ * \f$ \log |A| = \mathrm{tr} \log A \f$, and the trace is the mean of \f$ z^T \log(A) z \f$
+ * over random probe vectors z of entries \f$ \pm 1 \f$ (Hutchinson). Every quadratic form
+ * is the Gauss quadrature of a few Lanczos steps from z: with the eigenvalues
+ * \f$ \theta_k \f$ of the Lanczos matrix and the first components \f$ \tau_k \f$ of its
+ * eigenvectors, \f$ z^T \log(A) z \approx \|z\|^2 \sum_k \tau_k^2 \log \theta_k \f$. Only
+ * products with A are needed. Probes run in parallel, each from its own generator seeded
+ * by the seed and its index, so estimates only depend on the seed.
+ */
+
+#ifndef LINEARALGEBRA_LOGDETERMINANT_HPP
+#define LINEARALGEBRA_LOGDETERMINANT_HPP
+
+#include "globals.hpp"
+#include "matrix.hpp"
+#include "sparse_matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief \f$ \log |L L^T| \f$ from the Cholesky factor L, as returned by CholeskyDecompose.
+     * @throw std::length_error L is not square.
+     * @throw std::domain_error A diagonal entry of L is not positive.
+     */
+    double CholeskyLogDeterminant(const matrix &L);
+
+    /*!
+     * \brief \f$ \log |L L^T| \f$ from the sparse Cholesky factor L, as returned by CholeskyDecompose.
+     * @throw std::length_error L is not square.
+     * @throw std::domain_error A diagonal entry of L is not positive, or missing.
+     */
+    double CholeskyLogDeterminant(const sparse_matrix &L);
+
+    /*!
+     * \brief Probes and Lanczos steps of StochasticLogDeterminant.
+     */
+    struct stochastic_log_determinant_options {
+        /*!
+         * \brief Number of probe vectors, the error decreasing with its square root.
+         */
+        unsigned int probes;
+        /*!
+         * \brief Lanczos steps per probe, further limited by the dimension of A.
+         */
+        unsigned int lanczosSteps;
+        /*!
+         * \brief Seed of the probe vectors.
+         */
+        unsigned int seed;
+
+        stochastic_log_determinant_options() : probes(32), lanczosSteps(30), seed(1) {}
+    };
+
+    /*!
+     * \brief Estimate of a log determinant, with the standard error of the mean over the probes.
+     */
+    struct log_determinant_estimate {
+        double value;
+        /*!
+         * \brief Standard error of value from the spread of the probes, zero for a single probe.
+         */
+        double standardError;
+    };
+
+    /*!
+     * \brief Estimate \f$ \log |A| \f$ of a symmetric positive definite sparse matrix by stochastic Lanczos quadrature.
+     * @throw std::length_error A is not square.
+     * @throw std::invalid_argument No probes or no Lanczos steps requested.
+     * @throw std::domain_error A turns out not to be positive definite.
+     */
+    log_determinant_estimate StochasticLogDeterminant(const sparse_matrix &A,
+                                                      const stochastic_log_determinant_options &options =
+                                                      stochastic_log_determinant_options());
+}
+
+#endif //LINEARALGEBRA_LOGDETERMINANT_HPP
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "parallel.hpp"
+#include "dense_kernels.hpp"
+#include "lu_decomposition.hpp"
+
+namespace algebra_lib {
+    lu_decomposition::lu_decomposition(const matrix &A, unsigned int blockSize)
+            : _factors(A.rows(), A.columns()), _permutation(A.rows()), _oddPermutation(false) {
+        if (A.rows() != A.columns()) {
+            throw std::length_error("LU decomposition: matrix is not square.");
+        } else if (blockSize == 0) {
+            throw std::invalid_argument("LU decomposition: block size must be positive.");
+        }
+        const unsigned long n = A.rows();
+        std::iota(_permutation.begin(), _permutation.end(), 0u);
+        if (n == 0) return;
+
+        matrix Work = A;
+        std::vector<double *> r(n);
+        auto rows = Work.begin();
+        for (unsigned long i = 0; i < n; ++i) {
+            r[i] = &rows[i].begin()[0];
+        }
+
+        std::vector<const double *> panelRows;
+        std::vector<const double *> upperRows;
+        std::vector<double *> trailingRows;
+        for (unsigned long panelBegin = 0; panelBegin < n; panelBegin += blockSize) {
+            const unsigned long panelEnd = std::min<unsigned long>(n, panelBegin + blockSize);
+
+            // Unblocked elimination within the panel, rows swapped in full.
+            for (unsigned long j = panelBegin; j < panelEnd; ++j) {
+                unsigned long pivot = j;
+                double largest = std::fabs(r[j][j]);
+                for (unsigned long i = j + 1; i < n; ++i) {
+                    if (std::fabs(r[i][j]) > largest) {
+                        largest = std::fabs(r[i][j]);
+                        pivot = i;
+                    }
+                }
+                if (largest == 0) {
+                    throw std::domain_error("LU decomposition: matrix is singular.");
+                } else if (pivot != j) {
+                    std::swap(r[j], r[pivot]);
+                    std::swap(_permutation[j], _permutation[pivot]);
+                    _oddPermutation = !_oddPermutation;
+                }
+
+                const double *u = r[j];
+                const double inverse = 1 / u[j];
+                ParallelFor(j + 1, n, [&](unsigned long first, unsigned long last) {
+                    for (unsigned long i = first; i < last; ++i) {
+                        double *l = r[i];
+                        l[j] *= inverse;
+                        const double factor = l[j];
+                        for (unsigned long column = j + 1; column < panelEnd; ++column) {
+                            l[column] -= factor * u[column];
+                        }
+                    }
+                }, 256);
+            }
+            if (panelEnd == n) break;
+
+            // Rows of U right of the panel: forward substitution with the unit lower panel.
+            ParallelFor(panelEnd, n, [&](unsigned long first, unsigned long last) {
+                for (unsigned long i = panelBegin + 1; i < panelEnd; ++i) {
+                    double *x = r[i];
+                    for (unsigned long p = panelBegin; p < i; ++p) {
+                        const double factor = x[p];
+                        const double *u = r[p];
+                        for (unsigned long column = first; column < last; ++column) {
+                            x[column] -= factor * u[column];
+                        }
+                    }
+                }
+            }, 256);
+
+            // Trailing matrix minus the panel of L times the rows of U.
+            const unsigned long trailing = n - panelEnd;
+            panelRows.resize(trailing);
+            trailingRows.resize(trailing);
+            upperRows.resize(panelEnd - panelBegin);
+            for (unsigned long i = 0; i < trailing; ++i) {
+                panelRows[i] = r[panelEnd + i] + panelBegin;
+                trailingRows[i] = r[panelEnd + i] + panelEnd;
+            }
+            for (unsigned long p = panelBegin; p < panelEnd; ++p) {
+                upperRows[p - panelBegin] = r[p] + panelEnd;
+            }
+            MultiplyAdd(trailing, trailing, panelEnd - panelBegin, -1.0, panelRows.data(), upperRows.data(),
+                        trailingRows.data());
+        }
+
+        auto factors = _factors.begin();
+        for (unsigned long i = 0; i < n; ++i) {
+            std::copy(r[i], r[i] + n, factors[i].begin());
+        }
+    }
+
+    vector lu_decomposition::Solve(const vector &B) const {
+        if (B.size() != rows()) {
+            throw std::length_error("LU solve: vector and matrix are not compatible in dimension");
+        } else if (!B.isColumn()) {
+            throw std::invalid_argument("LU solve: vector is not a column vector! First transpose it for goodness' sake.");
+        }
+        const unsigned long n = rows();
+        vector X(n, true);
+        auto x = X.begin();
+        auto b = B.begin();
+        auto factors = _factors.begin();
+        for (unsigned long i = 0; i < n; ++i) {
+            auto l = factors[i].begin();
+            double sum = b[_permutation[i]];
+            for (unsigned long p = 0; p < i; ++p) {
+                sum -= l[p] * x[p];
+            }
+            x[i] = sum;
+        }
+        for (unsigned long i = n; i-- > 0;) {
+            auto u = factors[i].begin();
+            double sum = x[i];
+            for (unsigned long p = i + 1; p < n; ++p) {
+                sum -= u[p] * x[p];
+            }
+            x[i] = sum / u[i];
+        }
+        return X;
+    }
+
+    matrix lu_decomposition::Solve(const matrix &B) const {
+        if (B.rows() != rows()) {
+            throw std::length_error("LU solve: matrices are not compatible in dimension");
+        }
+        const unsigned long n = rows();
+        const unsigned long m = B.columns();
+        matrix X(n, m);
+        if (n == 0 or m == 0) return X;
+
+        auto b = B.begin();
+        auto xRows = X.begin();
+        std::vector<double *> x(n);
+        for (unsigned long i = 0; i < n; ++i) {
+            xRows[i] = b[_permutation[i]];
+            x[i] = &xRows[i].begin()[0];
+        }
+        auto factors = _factors.begin();
+        ParallelFor(0, m, [&](unsigned long first, unsigned long last) {
+            for (unsigned long i = 0; i < n; ++i) {
+                auto l = factors[i].begin();
+                double *xi = x[i];
+                for (unsigned long p = 0; p < i; ++p) {
+                    const double factor = l[p];
+                    const double *xp = x[p];
+                    for (unsigned long column = first; column < last; ++column) {
+                        xi[column] -= factor * xp[column];
+                    }
+                }
+            }
+            for (unsigned long i = n; i-- > 0;) {
+                auto u = factors[i].begin();
+                double *xi = x[i];
+                for (unsigned long p = i + 1; p < n; ++p) {
+                    const double factor = u[p];
+                    const double *xp = x[p];
+                    for (unsigned long column = first; column < last; ++column) {
+                        xi[column] -= factor * xp[column];
+                    }
+                }
+                const double inverse = 1 / u[i];
+                for (unsigned long column = first; column < last; ++column) {
+                    xi[column] *= inverse;
+                }
+            }
+        }, 64);
+        return X;
+    }
+
+    double lu_decomposition::Determinant() const {
+        double determinant = _oddPermutation ? -1.0 : 1.0;
+        auto factors = _factors.begin();
+        for (unsigned long i = 0; i < rows(); ++i) {
+            determinant *= factors[i].begin()[i];
+        }
+        return determinant;
+    }
+}
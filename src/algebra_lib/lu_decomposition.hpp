@@ -0,0 +1,76 @@
+/*! \file lu_decomposition.hpp
+ * \brief LU decomposition with partial pivoting of full square matrices.
+ *
+ * For matrices that aren't symmetric positive definite, CholeskyDecompose doesn't apply.
+ * lu_decomposition factorizes \f$ P A = L U \f$ once, after which systems with any number
+ * of right hand sides and the determinant cost \f$ O(n^2) \f$ per column.
+ *
+ * The factorization is blocked and right-looking: a panel of blockSize columns is
+ * factorized with row pivoting, the rows of U right of it are solved, and the trailing
+ * matrix is updated with one product through MultiplyAdd, which runs in parallel and holds
+ * almost all of the work. Row interchanges swap row pointers, never entries.
+ */
+
+#ifndef LINEARALGEBRA_LUDECOMPOSITION_HPP
+#define LINEARALGEBRA_LUDECOMPOSITION_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Factors \f$ P A = L U \f$ of a square matrix, with L unit lower triangular.
+     */
+    class lu_decomposition {
+    public:
+        // Constructors
+        /*!
+         * \brief Factorize A.
+         * @param blockSize Columns per panel, 64 suits most caches.
+         * @throw std::length_error A is not square.
+         * @throw std::invalid_argument blockSize is zero.
+         * @throw std::domain_error A is singular.
+         */
+        explicit lu_decomposition(const matrix &A, unsigned int blockSize = 64);
+
+        // Member functions
+        /*!
+         * \brief Solve \f$ A x = b \f$.
+         * @param B Column vector.
+         * @throw std::length_error B is not of the dimension of A.
+         * @throw std::invalid_argument B is not a column vector.
+         */
+        vector Solve(const vector &B) const;
+
+        /*!
+         * \brief Solve \f$ A X = B \f$ for every column of B, in parallel over the columns.
+         * @throw std::length_error B doesn't have as many rows as A.
+         */
+        matrix Solve(const matrix &B) const;
+
+        /*!
+         * \brief Determinant of A, \f$ \pm \prod_i U_{ii} \f$.
+         */
+        double Determinant() const;
+
+        /*!
+         * \brief U on and above the diagonal, L below it. The unit diagonal of L isn't stored.
+         */
+        const matrix &factors() const { return _factors; }
+
+        /*!
+         * \brief Row i of \f$ P A \f$ is row permutation()[i] of A.
+         */
+        const std::vector<unsigned int> &permutation() const { return _permutation; }
+
+        unsigned long rows() const { return _factors.rows(); }
+
+    private:
+        matrix _factors;
+        std::vector<unsigned int> _permutation;
+        bool _oddPermutation;
+    };
+}
+
+#endif //LINEARALGEBRA_LUDECOMPOSITION_HPP
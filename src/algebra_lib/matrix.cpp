@@ -2,21 +2,22 @@
 // Created by Lars Gebraad on 16-8-17.
 //
 
+#include <algorithm>
 #include <cmath>
+#include "parallel.hpp"
 #include "matrix.hpp"
 
 namespace algebra_lib {
     matrix::matrix(unsigned long rows, unsigned long columns) {
         _rows = rows;
         _columns = columns;
-        _matrixContents =
-                std::vector<algebra_lib::vector>(_rows, algebra_lib::vector(_columns, false));
+        _matrixContents = std::make_shared<contentVectorVector>(_rows, algebra_lib::vector(_columns, false));
     }
 
     matrix::matrix() {
         _rows = 2;
         _columns = 2;
-        _matrixContents = std::vector<algebra_lib::vector>(2, algebra_lib::vector(2, false));
+        _matrixContents = std::make_shared<contentVectorVector>(2, algebra_lib::vector(2, false));
     }
 
     vector &matrix::operator[](int i) {
@@ -26,7 +27,7 @@ namespace algebra_lib {
             throw std::out_of_range("Exceeded amount of elements.");
         }
 
-        return _matrixContents[i];
+        return MutableRows()[i];
     }
 
     const vector &matrix::operator[](int i) const {
@@ -36,7 +37,7 @@ namespace algebra_lib {
             throw std::out_of_range("Exceeded amount of elements.");
         }
 
-        return _matrixContents[i];
+        return (*_matrixContents)[i];
     }
 
     vector &matrix::operator()(int i) {
@@ -46,7 +47,7 @@ namespace algebra_lib {
             throw std::out_of_range("Exceeded amount of elements.");
         }
 
-        return _matrixContents[i];
+        return MutableRows()[i];
     }
 
     const vector &matrix::operator()(int i) const {
@@ -56,17 +57,11 @@ namespace algebra_lib {
             throw std::out_of_range("Exceeded amount of elements.");
         }
 
-        return _matrixContents[i];
+        return (*_matrixContents)[i];
     }
 
     vector matrix::getColumn(int i) {
-        vector Column(rows(), true);
-        int row = 0;
-        for (auto &&item : (*this)) {
-            Column[row] = item[i];
-            row++;
-        }
-        return Column;
+        return static_cast<const matrix *>(this)->getColumn(i);
     }
 
     const vector matrix::getColumn(int i) const {
@@ -79,44 +74,50 @@ namespace algebra_lib {
         return Column;
     }
 
+    contentVectorVector &matrix::MutableRows() {
+        if (_matrixContents.use_count() > 1)
+            _matrixContents = std::make_shared<contentVectorVector>(*_matrixContents);
+        return *_matrixContents;
+    }
+
     contentVectorVector::iterator matrix::begin() {
-        return _matrixContents.begin();
+        return MutableRows().begin();
     }
 
     contentVectorVector::iterator matrix::end() {
-        return _matrixContents.end();
+        return MutableRows().end();
     }
 
     contentVectorVector::const_iterator matrix::begin() const {
-        return _matrixContents.begin();
+        return _matrixContents->begin();
     }
 
     contentVectorVector::const_iterator matrix::end() const {
-        return _matrixContents.end();
+        return _matrixContents->end();
     }
 
     contentVectorVector::reverse_iterator matrix::rbegin() {
-        return _matrixContents.rbegin();
+        return MutableRows().rbegin();
     }
 
     contentVectorVector::reverse_iterator matrix::rend() {
-        return _matrixContents.rend();
+        return MutableRows().rend();
     }
 
     contentVectorVector::const_iterator matrix::cbegin() const noexcept {
-        return _matrixContents.cbegin();
+        return _matrixContents->cbegin();
     }
 
     contentVectorVector::const_iterator matrix::cend() const noexcept {
-        return _matrixContents.cend();
+        return _matrixContents->cend();
     }
 
     contentVectorVector::const_reverse_iterator matrix::crbegin() const noexcept {
-        return _matrixContents.crbegin();
+        return _matrixContents->crbegin();
     }
 
     contentVectorVector::const_reverse_iterator matrix::crend() const noexcept {
-        return _matrixContents.crend();
+        return _matrixContents->crend();
     }
 
     matrix matrix::InvertMatrixElements(bool preserveZero) const {
@@ -147,12 +148,64 @@ namespace algebra_lib {
     matrix matrix::Transpose() const {
         matrix Mt(columns(), rows());
 
-        for (int rowMt = 0; rowMt < Mt.rows(); ++rowMt) {
-            Mt[rowMt] = (*this).getColumn(rowMt);
-        }
+        // Tiles of the transpose are filled in parallel. A tile reads tileSize rows of this
+        // matrix, which stay in cache, instead of striding through all rows per entry.
+        const unsigned long tileSize = 64;
+        auto target = Mt.begin();
+        ParallelFor(0, (columns() + tileSize - 1) / tileSize, [&](unsigned long first, unsigned long last) {
+            for (unsigned long tileRow = first; tileRow < last; ++tileRow) {
+                unsigned long rowBegin = tileRow * tileSize;
+                unsigned long rowEnd = std::min(rowBegin + tileSize, columns());
+                for (unsigned long columnBegin = 0; columnBegin < rows(); columnBegin += tileSize) {
+                    unsigned long columnEnd = std::min(columnBegin + tileSize, rows());
+                    TransposeTile(target, rowBegin, rowEnd, columnBegin, columnEnd);
+                }
+            }
+        });
         return Mt;
     }
 
+    void matrix::TransposeTile(contentVectorVector::iterator target, unsigned long rowBegin, unsigned long rowEnd,
+                               unsigned long columnBegin, unsigned long columnEnd) const {
+        const contentVectorVector &source = *_matrixContents;
+        unsigned long row = rowBegin;
+        // Blocks of 4 x 4 are read into registers and written back transposed, so every
+        // read and write touches four consecutive entries of a row.
+        for (; row + 4 <= rowEnd; row += 4) {
+            unsigned long column = columnBegin;
+            for (; column + 4 <= columnEnd; column += 4) {
+                auto s0 = source[column].begin() + row;
+                auto s1 = source[column + 1].begin() + row;
+                auto s2 = source[column + 2].begin() + row;
+                auto s3 = source[column + 3].begin() + row;
+                double a00 = s0[0], a01 = s0[1], a02 = s0[2], a03 = s0[3];
+                double a10 = s1[0], a11 = s1[1], a12 = s1[2], a13 = s1[3];
+                double a20 = s2[0], a21 = s2[1], a22 = s2[2], a23 = s2[3];
+                double a30 = s3[0], a31 = s3[1], a32 = s3[2], a33 = s3[3];
+                auto t0 = target[row].begin() + column;
+                auto t1 = target[row + 1].begin() + column;
+                auto t2 = target[row + 2].begin() + column;
+                auto t3 = target[row + 3].begin() + column;
+                t0[0] = a00, t0[1] = a10, t0[2] = a20, t0[3] = a30;
+                t1[0] = a01, t1[1] = a11, t1[2] = a21, t1[3] = a31;
+                t2[0] = a02, t2[1] = a12, t2[2] = a22, t2[3] = a32;
+                t3[0] = a03, t3[1] = a13, t3[2] = a23, t3[3] = a33;
+            }
+            for (; column < columnEnd; ++column) {
+                auto s = source[column].begin() + row;
+                for (unsigned long k = 0; k < 4; ++k) {
+                    target[row + k].begin()[column] = s[k];
+                }
+            }
+        }
+        for (; row < rowEnd; ++row) {
+            auto t = target[row].begin();
+            for (unsigned long column = columnBegin; column < columnEnd; ++column) {
+                t[column] = source[column].begin()[row];
+            }
+        }
+    }
+
     matrix &matrix::TransposeSelf() {
         (*this) = (*this).Transpose();
         return (*this);
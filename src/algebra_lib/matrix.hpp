@@ -1,12 +1,18 @@
 #ifndef LINEARALGEBRA_MATRIX_HPP
 #define LINEARALGEBRA_MATRIX_HPP
 
+#include <memory>
 #include "globals.hpp"
 #include "vector.hpp"
 
 namespace algebra_lib {
     /*!
      * \brief Class for full matrices.
+     *
+     * Copies share their rows until one of them is modified, so copying costs \f$ O(1) \f$.
+     * The first access through a non-const accessor or iterator of a copy duplicates the
+     * rows. References and iterators obtained that way are not tracked, so don't hold on to
+     * them across a copy.
      */
     class matrix {
     public:
@@ -28,6 +34,11 @@ namespace algebra_lib {
          */
         matrix(unsigned long rows, unsigned long columns);
 
+        // Copies are cheap, and no moves are declared so a moved from matrix stays valid.
+        matrix(const matrix &) = default;
+
+        matrix &operator=(const matrix &) = default;
+
         // Member functions
         matrix InvertLowerTriangular();
         matrix InvertLowerTriangular() const;
@@ -158,6 +169,22 @@ namespace algebra_lib {
         contentVectorVector::const_reverse_iterator crend() const noexcept;
 
     private:
+        /*!
+         * \brief Rows for modification, detached from copies sharing them.
+         */
+        contentVectorVector &MutableRows();
+
+        /*!
+         * \brief Write the transpose of a tile of this matrix into the rows of another.
+         * @param target Rows of the transposed matrix.
+         * @param rowBegin First row of the tile in the transposed matrix.
+         * @param rowEnd One past the last row of the tile in the transposed matrix.
+         * @param columnBegin First column of the tile in the transposed matrix.
+         * @param columnEnd One past the last column of the tile in the transposed matrix.
+         */
+        void TransposeTile(contentVectorVector::iterator target, unsigned long rowBegin, unsigned long rowEnd,
+                           unsigned long columnBegin, unsigned long columnEnd) const;
+
         // Private fields
         /*!
          * \brief Columns in matrix. Can not be changed after initialization.
@@ -170,9 +197,9 @@ namespace algebra_lib {
         unsigned long _rows;
 
         /**
-         * \brief Instance of std::vector<Vector> which contains matrix rows.
+         * \brief Instance of std::vector<Vector> which contains matrix rows, shared between copies.
          */
-        contentVectorVector _matrixContents;
+        std::shared_ptr<contentVectorVector> _matrixContents;
 
     };
 }
@@ -0,0 +1,204 @@
+#include <algorithm>
+#include "parallel.hpp"
+#include "full_algebra.hpp"
+#include "mixed_algebra.hpp"
+
+namespace algebra_lib {
+    vector ToFull(const sparse_vector &U) {
+        vector Full(U.size(), U.isColumn());
+        auto full = Full.begin();
+        for (auto const &entry : U) {
+            full[entry.first] = entry.second;
+        }
+        return Full;
+    }
+
+    matrix ToFull(const sparse_matrix &A) {
+        matrix Full(A.rows(), A.columns());
+        for (auto const &row : A) {
+            auto full = Full[row.first].begin();
+            for (auto const &entry : row.second) {
+                full[entry.first] = entry.second;
+            }
+        }
+        return Full;
+    }
+
+    sparse_vector ToSparse(const vector &U) {
+        sparse_vector Sparse(static_cast<unsigned int>(U.size()), U.isColumn());
+        unsigned int index = 0;
+        for (double element : U) {
+            if (element != 0)
+                Sparse.Append(index, element);
+            ++index;
+        }
+        return Sparse;
+    }
+
+    sparse_matrix ToSparse(const matrix &A) {
+        sparse_matrix Sparse(static_cast<unsigned int>(A.rows()), static_cast<unsigned int>(A.columns()));
+        unsigned int rowIndex = 0;
+        for (auto const &row : A) {
+            sparse_vector Row = ToSparse(row);
+            if (Row.nonZeros() > 0)
+                Sparse.AppendRow(rowIndex, std::move(Row));
+            ++rowIndex;
+        }
+        return Sparse;
+    }
+
+    unsigned long NonZeros(const vector &U) {
+        unsigned long nonZeros = 0;
+        for (double element : U) {
+            if (element != 0) ++nonZeros;
+        }
+        return nonZeros;
+    }
+
+    vector operator*(const sparse_matrix &A, const vector &U) {
+        if (A.columns() != U.size()) {
+            throw std::length_error(
+                    "Left multiplication with matrix: vector and matrix are not compatible in dimension");
+        } else if (!U.isColumn()) {
+            throw std::invalid_argument(
+                    "Left multiplication with matrix: vector is not a column vector! First transpose it for goodness' sake.");
+        }
+
+        vector Product(A.rows(), true);
+        auto product = Product.begin();
+        auto u = U.begin();
+        for (auto const &row : A) {
+            double sum = 0.0;
+            for (auto const &entry : row.second) {
+                sum += entry.second * u[entry.first];
+            }
+            product[row.first] = sum;
+        }
+        return Product;
+    }
+
+    vector operator*(const vector &U, const sparse_matrix &A) {
+        if (A.rows() != U.size()) {
+            throw std::length_error(
+                    "Right multiplication with matrix: vector and matrix are not compatible in dimension");
+        } else if (U.isColumn()) {
+            throw std::invalid_argument(
+                    "Right multiplication with matrix: vector is not a row vector! First transpose it for goodness' "
+                            "sake.");
+        }
+
+        // Accumulate u_i times row i of A, so A is only traversed by rows.
+        vector Product(A.columns(), false);
+        auto product = Product.begin();
+        auto u = U.begin();
+        for (auto const &row : A) {
+            double factor = u[row.first];
+            if (factor == 0) continue;
+            for (auto const &entry : row.second) {
+                product[entry.first] += factor * entry.second;
+            }
+        }
+        return Product;
+    }
+
+    double operator*(const sparse_vector &U, const vector &V) {
+        if (U.size() != V.size()) throw std::length_error("Vectors are not the same dimension");
+
+        double sum = 0.0;
+        auto v = V.begin();
+        for (auto const &entry : U) {
+            sum += entry.second * v[entry.first];
+        }
+        return sum;
+    }
+
+    double operator*(const vector &U, const sparse_vector &V) {
+        return V * U;
+    }
+
+    vector operator+(const vector &U, const sparse_vector &V) {
+        if (U.size() != V.size()) throw std::length_error("Vectors are not the same dimension");
+
+        vector Sum = U;
+        auto sum = Sum.begin();
+        for (auto const &entry : V) {
+            sum[entry.first] += entry.second;
+        }
+        return Sum;
+    }
+
+    vector operator+(const sparse_vector &U, const vector &V) {
+        vector Sum = V + U;
+        if (Sum.isColumn() != U.isColumn()) Sum.TransposeSelf();
+        return Sum;
+    }
+
+    vector operator-(const vector &U, const sparse_vector &V) {
+        if (U.size() != V.size()) throw std::length_error("Vectors are not the same dimension");
+
+        vector Difference = U;
+        auto difference = Difference.begin();
+        for (auto const &entry : V) {
+            difference[entry.first] -= entry.second;
+        }
+        return Difference;
+    }
+
+    vector operator-(const sparse_vector &U, const vector &V) {
+        if (U.size() != V.size()) throw std::length_error("Vectors are not the same dimension");
+
+        vector Difference = V * -1.0;
+        if (Difference.isColumn() != U.isColumn()) Difference.TransposeSelf();
+        auto difference = Difference.begin();
+        for (auto const &entry : U) {
+            difference[entry.first] += entry.second;
+        }
+        return Difference;
+    }
+
+    sparse_vector ElementWiseMultiplication(const sparse_vector &U, const vector &V) {
+        if (U.size() != V.size()) throw std::length_error("Vectors are not the same dimension");
+
+        sparse_vector Product(U.size(), U.isColumn());
+        auto v = V.begin();
+        for (auto const &entry : U) {
+            double product = entry.second * v[entry.first];
+            if (product != 0)
+                Product.Append(entry.first, product);
+        }
+        return Product;
+    }
+
+    sparse_row_partition::sparse_row_partition(const sparse_matrix &A, unsigned long parts) : _n(A.rows()) {
+        for (auto const &row : A) {
+            _storedRows.emplace_back(row.first, &row.second);
+        }
+        _parts = parts ? parts : std::max(1ul, std::min(static_cast<unsigned long>(ParallelThreads()), _n / 4096));
+    }
+
+    double sparse_row_partition::MultiplyDot(const double *x, double *y) const {
+        if (_storedRows.size() < _n) std::fill(y, y + _n, 0.0);
+        std::vector<double> partial(_parts);
+        ParallelFor(0, _parts, [&](unsigned long first, unsigned long last) {
+            for (unsigned long part = first; part < last; ++part) {
+                double dot = 0.0;
+                for (std::size_t row = _storedRows.size() * part / _parts;
+                     row < _storedRows.size() * (part + 1) / _parts; ++row) {
+                    const sparse_vector &Row = *_storedRows[row].second;
+                    const unsigned int *indices = Row.indices();
+                    const double *values = Row.values();
+                    double sum = 0.0;
+                    for (unsigned int entry = 0; entry < Row.nonZeros(); ++entry) {
+                        sum += values[entry] * x[indices[entry]];
+                    }
+                    y[_storedRows[row].first] = sum;
+                    dot += x[_storedRows[row].first] * sum;
+                }
+                partial[part] = dot;
+            }
+        });
+        double total = 0.0;
+        for (double value : partial) total += value;
+        return total;
+    }
+}
@@ -0,0 +1,139 @@
+/*! \file mixed_algebra.hpp
+ * \brief Functions for AlgebraLib combining sparse and full classes.
+ *
+ * Conversions between sparse and full vectors, and products and sums mixing the two.
+ * All products with a full vector return a full vector, as sparsity of the result
+ * can't be expected.
+ */
+
+#ifndef LINEARALGEBRA_MIXEDALGEBRA_HPP
+#define LINEARALGEBRA_MIXEDALGEBRA_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "sparse_vector.hpp"
+#include "sparse_matrix.hpp"
+
+namespace algebra_lib {
+    /**
+     * \brief Convert sparse vector to full vector of the same shape.
+     */
+    vector ToFull(const sparse_vector &U);
+
+    /**
+     * \brief Convert sparse matrix to full matrix.
+     */
+    matrix ToFull(const sparse_matrix &A);
+
+    /**
+     * \brief Convert full vector to sparse vector of the same shape, storing only non-zero entries.
+     */
+    sparse_vector ToSparse(const vector &U);
+
+    /**
+     * \brief Convert full matrix to sparse matrix, storing only non-zero entries.
+     */
+    sparse_matrix ToSparse(const matrix &A);
+
+    /**
+     * \brief Number of non-zero entries of a full vector.
+     */
+    unsigned long NonZeros(const vector &U);
+
+    /**
+     *  \brief Matrix vector product.
+     * @param A \f$ m \times n \f$ sparse matrix
+     * @param U \f$ n \times 1 \f$ (column) vector
+     * @return \f$ m \times 1 \f$ (column) vector
+     * @throw std::length_error A and U are not of compatible dimension.
+     * @throw std::invalid_argument U is not a column vector.
+     */
+    vector operator*(const sparse_matrix &A, const vector &U);
+
+    /**
+     *  \brief Vector matrix product.
+     * @param U \f$ 1 \times n \f$ (row) vector
+     * @param A \f$ n \times l \f$ sparse matrix
+     * @return \f$ 1 \times l \f$ (row) vector
+     * @throw std::length_error U and A are not of compatible dimension.
+     * @throw std::invalid_argument U is not a row vector.
+     */
+    vector operator*(const vector &U, const sparse_matrix &A);
+
+    /**
+     * \brief Vector dot product.
+     * @throw std::length_error U and V are not of compatible dimension.
+     */
+    double operator*(const sparse_vector &U, const vector &V);
+
+    /**
+     * \brief Vector dot product.
+     * @throw std::length_error U and V are not of compatible dimension.
+     */
+    double operator*(const vector &U, const sparse_vector &V);
+
+    /**
+     * \brief Vector sum.
+     * @return Full vector, same shape as U.
+     * @throw std::length_error U and V are not of compatible dimension.
+     */
+    vector operator+(const vector &U, const sparse_vector &V);
+
+    /**
+     * \brief Vector sum.
+     * @return Full vector, same shape as U.
+     * @throw std::length_error U and V are not of compatible dimension.
+     */
+    vector operator+(const sparse_vector &U, const vector &V);
+
+    /**
+     * \brief Vector difference.
+     * @return Full vector, same shape as U.
+     * @throw std::length_error U and V are not of compatible dimension.
+     */
+    vector operator-(const vector &U, const sparse_vector &V);
+
+    /**
+     * \brief Vector difference.
+     * @return Full vector, same shape as U.
+     * @throw std::length_error U and V are not of compatible dimension.
+     */
+    vector operator-(const sparse_vector &U, const vector &V);
+
+    /**
+     * \brief Element wise product, only non-zero where U is.
+     * @return Sparse vector, same shape as U.
+     * @throw std::length_error U and V are not of compatible dimension.
+     */
+    sparse_vector ElementWiseMultiplication(const sparse_vector &U, const vector &V);
+
+    /**
+     * \brief Stored rows of a square sparse matrix in fixed parts, for the repeated products of iterative methods.
+     *
+     * Every part sums into its own slot, so results don't depend on how the parts are
+     * scheduled, only on their number. The matrix must outlive the partition.
+     */
+    class sparse_row_partition {
+    public:
+        /**
+         * @param A Square sparse matrix.
+         * @param parts Number of parts, zero for one per worker thread and 4096 rows, at least one.
+         */
+        explicit sparse_row_partition(const sparse_matrix &A, unsigned long parts = 0);
+
+        unsigned long parts() const { return _parts; }
+
+        /**
+         * \brief y = A x, returning \f$ x^T y \f$. x and y hold A.rows() entries each.
+         */
+        double MultiplyDot(const double *x, double *y) const;
+
+    private:
+        unsigned long _n;
+        unsigned long _parts;
+        std::vector<std::pair<unsigned int, const sparse_vector *>> _storedRows;
+    };
+}
+
+#endif //LINEARALGEBRA_MIXEDALGEBRA_HPP
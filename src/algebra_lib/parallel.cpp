@@ -0,0 +1,135 @@
+#include <cstdlib>
+#include <exception>
+#include <algorithm>
+#include "parallel.hpp"
+#include "pool_allocator.hpp"
+
+namespace algebra_lib {
+    namespace {
+        thread_local bool insideWorker = false;
+
+        unsigned int DefaultPoolSize() {
+            // Allow overriding the pool size, e.g. to pin a run to fewer cores than the node has.
+            const char *environment = std::getenv("ALGEBRA_LIB_THREADS");
+            if (environment != nullptr) {
+                long requested = std::strtol(environment, nullptr, 10);
+                if (requested > 0)
+                    return static_cast<unsigned int>(requested);
+            }
+            unsigned int hardware = std::thread::hardware_concurrency();
+            return hardware == 0 ? 1 : hardware;
+        }
+    }
+
+    thread_pool::thread_pool(unsigned int threads) {
+        _stopping = false;
+        if (threads == 0) threads = 1;
+        for (unsigned int i = 0; i < threads; ++i) {
+            _workers.emplace_back(&thread_pool::Work, this);
+        }
+    }
+
+    thread_pool::~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _condition.notify_all();
+        for (std::thread &worker : _workers) {
+            worker.join();
+        }
+    }
+
+    thread_pool &thread_pool::Instance() {
+        static thread_pool pool(DefaultPoolSize());
+        return pool;
+    }
+
+    void thread_pool::Submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tasks.push_back(std::move(task));
+        }
+        _condition.notify_one();
+    }
+
+    bool thread_pool::InsideWorker() {
+        return insideWorker;
+    }
+
+    void thread_pool::Work() {
+        insideWorker = true;
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _condition.wait(lock, [this] { return _stopping or !_tasks.empty(); });
+                if (_stopping and _tasks.empty())
+                    return;
+                task = std::move(_tasks.front());
+                _tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    unsigned int ParallelThreads() {
+        return thread_pool::Instance().size();
+    }
+
+    void ParallelFor(unsigned long begin, unsigned long end,
+                     const std::function<void(unsigned long, unsigned long)> &body,
+                     unsigned long minimumChunk) {
+        if (end <= begin) return;
+        if (minimumChunk == 0) minimumChunk = 1;
+
+        unsigned long length = end - begin;
+        unsigned long chunks = std::min<unsigned long>(ParallelThreads(), (length + minimumChunk - 1) / minimumChunk);
+
+        // Nested calls from a worker run inline; waiting on the pool from inside the pool could deadlock.
+        if (chunks <= 1 or thread_pool::InsideWorker()) {
+            body(begin, end);
+            return;
+        }
+
+        std::mutex doneMutex;
+        std::condition_variable doneCondition;
+        unsigned long remaining = chunks - 1;
+        std::exception_ptr failure;
+
+        unsigned long chunkSize = length / chunks;
+        unsigned long leftover = length % chunks;
+        unsigned long chunkBegin = begin;
+        // Workers allocate from the arena of the caller, if it has one.
+        arena_scope *arena = arena_scope::Current();
+
+        for (unsigned long chunk = 0; chunk < chunks - 1; ++chunk) {
+            unsigned long chunkEnd = chunkBegin + chunkSize + (chunk < leftover ? 1 : 0);
+            thread_pool::Instance().Submit([&, chunkBegin, chunkEnd]() {
+                std::exception_ptr caught;
+                try {
+                    arena_binding binding(arena);
+                    body(chunkBegin, chunkEnd);
+                } catch (...) {
+                    caught = std::current_exception();
+                }
+                std::lock_guard<std::mutex> lock(doneMutex);
+                if (caught and !failure) failure = caught;
+                if (--remaining == 0) doneCondition.notify_one();
+            });
+            chunkBegin = chunkEnd;
+        }
+
+        // The calling thread takes the last chunk itself.
+        try {
+            body(chunkBegin, end);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (!failure) failure = std::current_exception();
+        }
+
+        std::unique_lock<std::mutex> lock(doneMutex);
+        doneCondition.wait(lock, [&] { return remaining == 0; });
+        if (failure) std::rethrow_exception(failure);
+    }
+}
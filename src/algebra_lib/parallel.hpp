@@ -0,0 +1,88 @@
+/*! \file parallel.hpp
+ * \brief Shared worker threads for the parallel kernels of AlgebraLib.
+ *
+ * Spawning a std::thread per call (as ParallelMatrixProduct does) is fine for one large
+ * product, but kernels that are called many times in a row (block decoding, solver
+ * iterations) should not pay for thread creation every time. All of them go through
+ * ParallelFor, which hands contiguous chunks of an index range to one process wide pool.
+ *
+ */
+
+#ifndef LINEARALGEBRA_PARALLEL_HPP
+#define LINEARALGEBRA_PARALLEL_HPP
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include "globals.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Fixed set of worker threads executing queued tasks.
+     *
+     * Use thread_pool::Instance() rather than creating pools yourself. Tasks submitted
+     * from within a worker are executed inline by ParallelFor, so nested parallel kernels
+     * can't deadlock the pool.
+     */
+    class thread_pool {
+    public:
+        explicit thread_pool(unsigned int threads);
+
+        ~thread_pool();
+
+        thread_pool(const thread_pool &) = delete;
+
+        thread_pool &operator=(const thread_pool &) = delete;
+
+        /*!
+         * \brief Process wide pool, sized to std::thread::hardware_concurrency().
+         */
+        static thread_pool &Instance();
+
+        /*!
+         * \brief Queue a task for execution by one of the workers.
+         */
+        void Submit(std::function<void()> task);
+
+        unsigned int size() const { return static_cast<unsigned int>(_workers.size()); }
+
+        /*!
+         * \brief True if the calling thread is a worker of any pool.
+         */
+        static bool InsideWorker();
+
+    private:
+        void Work();
+
+        std::vector<std::thread> _workers;
+        std::deque<std::function<void()>> _tasks;
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        bool _stopping;
+    };
+
+    /*!
+     * \brief Number of chunks ParallelFor will split work into.
+     * @return Worker count of the pool, at least 1.
+     */
+    unsigned int ParallelThreads();
+
+    /*!
+     * \brief Execute body(chunkBegin, chunkEnd) over [begin, end) in parallel.
+     * @param begin First index of the range.
+     * @param end One past the last index of the range.
+     * @param body Called with disjoint, contiguous sub-ranges. Must be thread safe.
+     * @param minimumChunk Ranges shorter than this are not split further.
+     *
+     * Blocks until every chunk has finished. Exceptions thrown in a chunk are rethrown
+     * on the calling thread. Chunks allocate from the arena_scope of the calling thread,
+     * if any, whichever thread runs them.
+     */
+    void ParallelFor(unsigned long begin, unsigned long end,
+                     const std::function<void(unsigned long, unsigned long)> &body,
+                     unsigned long minimumChunk = 1);
+}
+
+#endif //LINEARALGEBRA_PARALLEL_HPP
@@ -0,0 +1,356 @@
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <mutex>
+#include "pool_allocator.hpp"
+
+namespace algebra_lib {
+    namespace {
+        // Blocks up to largestPooled bytes are pooled, in size classes of granularity bytes.
+        const std::size_t granularity = 16;
+        const std::size_t largestPooled = 256;
+        const std::size_t sizeClasses = largestPooled / granularity;
+        // Pooled and small arena blocks are carved from segments of this size, aligned to it.
+        const std::size_t segmentBytes = 64 * 1024;
+        // Segments the pools take from the system at once.
+        const std::size_t poolSlabSegments = 16;
+        // Blocks move between a thread and the shared lists in batches of this size.
+        const std::size_t transferBatch = 128;
+
+        /*
+         * Start of every segment, naming the arena its blocks belong to, or nullptr for the
+         * pools. Padded so that blocks keep the alignment of malloc.
+         */
+        struct segment_header {
+            arena_scope *owner;
+        };
+
+        const std::size_t segmentHeaderBytes = granularity;
+        static_assert(sizeof(segment_header) <= segmentHeaderBytes, "segment header doesn't fit");
+
+        /*
+         * In front of every block larger than largestPooled, naming its arena like the
+         * segment header does. Arenas chain their large blocks through next.
+         */
+        struct large_header {
+            arena_scope *owner;
+            large_header *next;
+        };
+
+        const std::size_t largeHeaderBytes = granularity;
+        static_assert(sizeof(large_header) <= largeHeaderBytes, "large block header doesn't fit");
+
+        segment_header *SegmentOf(const void *pointer) {
+            return reinterpret_cast<segment_header *>(reinterpret_cast<std::uintptr_t>(pointer) &
+                                                      ~static_cast<std::uintptr_t>(segmentBytes - 1));
+        }
+
+        large_header *LargeHeaderOf(void *pointer) {
+            return reinterpret_cast<large_header *>(static_cast<char *>(pointer) - largeHeaderBytes);
+        }
+
+        /*
+         * At least segments aligned segments, in one allocation from the system returned
+         * in raw for freeing it.
+         */
+        char *AlignedSegments(std::size_t segments, void *&raw) {
+            raw = ::operator new((segments + 1) * segmentBytes);
+            std::uintptr_t address = reinterpret_cast<std::uintptr_t>(raw);
+            address = (address + segmentBytes - 1) & ~static_cast<std::uintptr_t>(segmentBytes - 1);
+            return reinterpret_cast<char *>(address);
+        }
+
+        struct free_block {
+            free_block *next;
+        };
+
+        struct free_list {
+            free_block *head;
+            std::size_t count;
+
+            void Push(free_block *block) {
+                block->next = head;
+                head = block;
+                ++count;
+            }
+
+            free_block *Pop() {
+                free_block *block = head;
+                head = block->next;
+                --count;
+                return block;
+            }
+
+            // Move up to blocks entries from the front of this list to the front of other.
+            void MoveTo(free_list &other, std::size_t blocks) {
+                while (blocks-- > 0 and head != nullptr) {
+                    other.Push(Pop());
+                }
+            }
+        };
+
+        /*
+         * Lists and segments shared by all threads. Intentionally never destroyed: threads
+         * may still return blocks to it while static objects are being torn down.
+         */
+        struct shared_lists {
+            std::mutex mutex;
+            free_list lists[sizeClasses];
+            char *nextSegment;
+            char *segmentsEnd;
+
+            shared_lists() : nextSegment(nullptr), segmentsEnd(nullptr) {
+                for (auto &list : lists) {
+                    list.head = nullptr;
+                    list.count = 0;
+                }
+            }
+
+            // A fresh segment of the pools. Call with the mutex held.
+            char *Segment() {
+                if (nextSegment == segmentsEnd) {
+                    void *raw;
+                    nextSegment = AlignedSegments(poolSlabSegments, raw);
+                    segmentsEnd = nextSegment + poolSlabSegments * segmentBytes;
+                }
+                char *segment = nextSegment;
+                nextSegment += segmentBytes;
+                reinterpret_cast<segment_header *>(segment)->owner = nullptr;
+                return segment;
+            }
+        };
+
+        shared_lists &Shared() {
+            static shared_lists *shared = new shared_lists();
+            return *shared;
+        }
+
+        struct thread_cache {
+            free_list lists[sizeClasses];
+
+            thread_cache() {
+                for (auto &list : lists) {
+                    list.head = nullptr;
+                    list.count = 0;
+                }
+            }
+
+            ~thread_cache() {
+                shared_lists &shared = Shared();
+                std::lock_guard<std::mutex> lock(shared.mutex);
+                for (std::size_t sizeClass = 0; sizeClass < sizeClasses; ++sizeClass) {
+                    lists[sizeClass].MoveTo(shared.lists[sizeClass], lists[sizeClass].count);
+                }
+            }
+
+            void Refill(std::size_t sizeClass) {
+                free_list &list = lists[sizeClass];
+                char *segment;
+                {
+                    shared_lists &shared = Shared();
+                    std::lock_guard<std::mutex> lock(shared.mutex);
+                    shared.lists[sizeClass].MoveTo(list, transferBatch);
+                    if (list.head != nullptr)
+                        return;
+                    segment = shared.Segment();
+                }
+
+                std::size_t blockBytes = (sizeClass + 1) * granularity;
+                for (std::size_t offset = segmentHeaderBytes; offset + blockBytes <= segmentBytes; offset += blockBytes) {
+                    list.Push(reinterpret_cast<free_block *>(segment + offset));
+                }
+            }
+
+            void Release(std::size_t sizeClass) {
+                shared_lists &shared = Shared();
+                std::lock_guard<std::mutex> lock(shared.mutex);
+                lists[sizeClass].MoveTo(shared.lists[sizeClass], transferBatch);
+            }
+        };
+
+        /*
+         * Where a thread carves small blocks from for one arena, identified by its id
+         * rather than its address, which a later arena may reuse. The blocks and bytes
+         * handed out are only added to the arena when the thread lets go of it, saving
+         * every allocation an atomic update.
+         */
+        struct arena_cursor {
+            arena_scope *arena;
+            unsigned long id;
+            char *position;
+            char *end;
+            long pendingBlocks;
+            std::size_t pendingBytes;
+        };
+
+        std::atomic<unsigned long> nextArenaId(1);
+
+        thread_local thread_cache cache;
+        thread_local arena_scope *currentArena = nullptr;
+        thread_local arena_cursor cursor = {nullptr, 0, nullptr, nullptr, 0, 0};
+
+        std::size_t SizeClass(std::size_t bytes) {
+            return bytes == 0 ? 0 : (bytes - 1) / granularity;
+        }
+    }
+
+    void *PoolAllocate(std::size_t bytes) {
+        if (currentArena != nullptr)
+            return currentArena->Allocate(bytes);
+        if (bytes > largestPooled) {
+            large_header *header = static_cast<large_header *>(::operator new(largeHeaderBytes + bytes));
+            header->owner = nullptr;
+            return reinterpret_cast<char *>(header) + largeHeaderBytes;
+        }
+
+        std::size_t sizeClass = SizeClass(bytes);
+        if (cache.lists[sizeClass].head == nullptr)
+            cache.Refill(sizeClass);
+        return cache.lists[sizeClass].Pop();
+    }
+
+    void PoolDeallocate(void *pointer, std::size_t bytes) noexcept {
+        if (pointer == nullptr)
+            return;
+        if (bytes > largestPooled) {
+            large_header *header = LargeHeaderOf(pointer);
+            if (header->owner != nullptr)
+                header->owner->_live.fetch_sub(1, std::memory_order_relaxed);
+            else
+                ::operator delete(header);
+            return;
+        }
+        arena_scope *owner = SegmentOf(pointer)->owner;
+        if (owner != nullptr) {
+            owner->_live.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+
+        std::size_t sizeClass = SizeClass(bytes);
+        cache.lists[sizeClass].Push(static_cast<free_block *>(pointer));
+        if (cache.lists[sizeClass].count > 2 * transferBatch)
+            cache.Release(sizeClass);
+    }
+
+    arena_scope::arena_scope(std::size_t chunkBytes)
+            : _id(nextArenaId.fetch_add(1, std::memory_order_relaxed)), _nextSegment(nullptr), _segmentsEnd(nullptr),
+              _nextSlabBytes(chunkBytes < segmentBytes ? segmentBytes : chunkBytes), _large(nullptr), _live(0), _used(0),
+              _outer(currentArena) {
+        currentArena = this;
+    }
+
+    arena_scope::~arena_scope() {
+        if (cursor.id == _id) {
+            FlushCursor();
+            cursor.arena = nullptr;
+            cursor.id = 0;
+        }
+        currentArena = _outer;
+        // A block still live here belongs to a container that outlives the scope, typically
+        // one made before it that grew inside it. Rather than leave it dangling, stop.
+        if (_live.load(std::memory_order_acquire) != 0) {
+            std::fputs("arena_scope ends with blocks still in use\n", stderr);
+            std::terminate();
+        }
+        for (void *large = _large; large != nullptr;) {
+            void *next = static_cast<large_header *>(large)->next;
+            ::operator delete(large);
+            large = next;
+        }
+        for (void *slab : _slabs) {
+            ::operator delete(slab);
+        }
+    }
+
+    arena_scope *arena_scope::Current() {
+        return currentArena;
+    }
+
+    void arena_scope::FlushCursor() {
+        if (cursor.pendingBlocks != 0) {
+            cursor.arena->_live.fetch_add(cursor.pendingBlocks, std::memory_order_relaxed);
+            cursor.pendingBlocks = 0;
+        }
+        if (cursor.pendingBytes != 0) {
+            cursor.arena->_used.fetch_add(cursor.pendingBytes, std::memory_order_relaxed);
+            cursor.pendingBytes = 0;
+        }
+    }
+
+    char *arena_scope::Segment() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_nextSegment == _segmentsEnd) {
+            std::size_t segments = _nextSlabBytes / segmentBytes;
+            void *raw;
+            _nextSegment = AlignedSegments(segments, raw);
+            _slabs.push_back(raw);
+            _segmentsEnd = _nextSegment + segments * segmentBytes;
+            _nextSlabBytes *= 2;
+        }
+        char *segment = _nextSegment;
+        _nextSegment += segmentBytes;
+        reinterpret_cast<segment_header *>(segment)->owner = this;
+        return segment;
+    }
+
+    void *arena_scope::AllocateLarge(std::size_t bytes) {
+        large_header *header = static_cast<large_header *>(::operator new(largeHeaderBytes + bytes));
+        header->owner = this;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            header->next = static_cast<large_header *>(_large);
+            _large = header;
+        }
+        _live.fetch_add(1, std::memory_order_relaxed);
+        _used.fetch_add(bytes, std::memory_order_relaxed);
+        return reinterpret_cast<char *>(header) + largeHeaderBytes;
+    }
+
+    void *arena_scope::Allocate(std::size_t bytes) {
+        if (bytes > largestPooled)
+            return AllocateLarge(bytes);
+        // Keep every block aligned like malloc would.
+        bytes = bytes == 0 ? granularity : (bytes + granularity - 1) / granularity * granularity;
+
+        if (cursor.id != _id) {
+            if (cursor.arena != nullptr) FlushCursor();
+            cursor.arena = this;
+            cursor.id = _id;
+            cursor.position = nullptr;
+            cursor.end = nullptr;
+        }
+        if (static_cast<std::size_t>(cursor.end - cursor.position) < bytes) {
+            char *segment = Segment();
+            cursor.position = segment + segmentHeaderBytes;
+            cursor.end = segment + segmentBytes;
+        }
+        void *block = cursor.position;
+        cursor.position += bytes;
+        ++cursor.pendingBlocks;
+        cursor.pendingBytes += bytes;
+        return block;
+    }
+
+    std::size_t arena_scope::live() const {
+        long live = _live.load(std::memory_order_relaxed);
+        if (cursor.id == _id) live += cursor.pendingBlocks;
+        return static_cast<std::size_t>(live);
+    }
+
+    std::size_t arena_scope::used() const {
+        std::size_t used = _used.load(std::memory_order_relaxed);
+        if (cursor.id == _id) used += cursor.pendingBytes;
+        return used;
+    }
+
+    arena_binding::arena_binding(arena_scope *arena) : _arena(arena), _previous(currentArena) {
+        currentArena = arena;
+    }
+
+    arena_binding::~arena_binding() {
+        // The arena may end as soon as this thread lets go of it, so its counts must be complete.
+        if (_arena != nullptr and cursor.id == _arena->_id)
+            arena_scope::FlushCursor();
+        currentArena = _previous;
+    }
+}
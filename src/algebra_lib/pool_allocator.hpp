@@ -0,0 +1,199 @@
+/*! \file pool_allocator.hpp
+ * \brief Allocator for the nodes of the sparse containers.
+ *
+ * Sparse vectors and matrices allocate one small block per stored entry. Through the
+ * global allocator, building a product or a transpose costs millions of malloc/free
+ * pairs that contend under multithreading. pool_allocator serves these blocks from
+ * per-thread free lists of fixed size classes instead, and only touches a lock when a
+ * thread's list runs empty or grows too long.
+ *
+ * For bulk build phases, an arena_scope redirects the pool allocations of the current
+ * thread, and of the ParallelFor workers running chunks for it, to a monotonic arena.
+ * Frees of arena blocks only count them as returned, and the memory of the arena is
+ * released all at once when the scope ends.
+ *
+ * Pooled blocks and small arena blocks are carved from segments aligned to their size,
+ * whose header names the arena owning them, if any. Larger blocks carry that header
+ * themselves. Either way a free finds the owner of its block in constant time, on any
+ * thread.
+ *
+ * The allocator of the sparse containers is chosen at compile time through
+ * ALGEBRA_LIB_SPARSE_ALLOCATOR; define it as std::allocator to go back to the global
+ * allocator.
+ */
+
+#ifndef LINEARALGEBRA_POOLALLOCATOR_HPP
+#define LINEARALGEBRA_POOLALLOCATOR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <memory>
+#include <vector>
+
+namespace algebra_lib {
+    /*!
+     * \brief Allocate bytes from the pool of the calling thread (or its active arena).
+     * @throw std::bad_alloc Out of memory.
+     */
+    void *PoolAllocate(std::size_t bytes);
+
+    /*!
+     * \brief Return a block obtained from PoolAllocate with the same number of bytes.
+     */
+    void PoolDeallocate(void *pointer, std::size_t bytes) noexcept;
+
+    /*!
+     * \brief Standard conforming allocator drawing from PoolAllocate.
+     *
+     * Stateless, so every instance compares equal and blocks may be freed on any thread.
+     */
+    template<typename T>
+    class pool_allocator {
+    public:
+        typedef T value_type;
+
+        pool_allocator() noexcept {}
+
+        template<typename U>
+        pool_allocator(const pool_allocator<U> &) noexcept {}
+
+        T *allocate(std::size_t n) {
+            return static_cast<T *>(PoolAllocate(n * sizeof(T)));
+        }
+
+        void deallocate(T *pointer, std::size_t n) noexcept {
+            PoolDeallocate(pointer, n * sizeof(T));
+        }
+    };
+
+    template<typename T, typename U>
+    bool operator==(const pool_allocator<T> &, const pool_allocator<U> &) noexcept { return true; }
+
+    template<typename T, typename U>
+    bool operator!=(const pool_allocator<T> &, const pool_allocator<U> &) noexcept { return false; }
+
+    /*!
+     * \brief Redirects pool allocations of the current thread to a monotonic arena while alive.
+     *
+     * Intended for temporaries that are built and dropped in one phase:
+     *
+     *     {
+     *         arena_scope arena;
+     *         sparse_matrix Work = A.Transpose() * A;
+     *         ...
+     *     } // Work destroyed, then all of its blocks released at once.
+     *
+     * ParallelFor binds the arena on the workers running its chunks, so kernels that build
+     * their result in parallel, such as sparse_matrix::Transpose and the sparse products,
+     * allocate from it as well. Threads started otherwise, such as those of
+     * ParallelMatrixProduct, keep allocating from the pools. Blocks may be freed on any
+     * thread.
+     *
+     * Every pool allocation of these threads is redirected, not only those of containers
+     * made inside the scope: a container made before it that grows inside it gets an arena
+     * block. Every block handed out must be returned before the scope ends. A block still
+     * in use then would dangle, so the destructor calls std::terminate instead.
+     *
+     * Scopes may be nested; the innermost one is used.
+     */
+    class arena_scope {
+    public:
+        /*!
+         * @param chunkBytes Memory the arena takes at first, at least one 64 KiB segment.
+         * Every time it runs out, it takes twice as much as the time before.
+         */
+        explicit arena_scope(std::size_t chunkBytes = 1 << 20);
+
+        ~arena_scope();
+
+        arena_scope(const arena_scope &) = delete;
+
+        arena_scope &operator=(const arena_scope &) = delete;
+
+        /*!
+         * \brief Allocate from the arena, on any thread. Return the block through PoolDeallocate.
+         * @throw std::bad_alloc Out of memory.
+         */
+        void *Allocate(std::size_t bytes);
+
+        /*!
+         * \brief Blocks handed out by this arena and not returned yet.
+         *
+         * Exact once the threads allocating from the arena are done with it, as they are
+         * after ParallelFor returns.
+         */
+        std::size_t live() const;
+
+        /*!
+         * \brief Bytes handed out by this arena so far, with the same caveat as live().
+         */
+        std::size_t used() const;
+
+        /*!
+         * \brief Innermost arena bound on the calling thread, nullptr if none.
+         */
+        static arena_scope *Current();
+
+    private:
+        friend class arena_binding;
+
+        friend void PoolDeallocate(void *pointer, std::size_t bytes) noexcept;
+
+        /*!
+         * \brief Add the blocks and bytes the calling thread handed out to the counts of their arena.
+         */
+        static void FlushCursor();
+
+        char *Segment();
+
+        void *AllocateLarge(std::size_t bytes);
+
+        const unsigned long _id;
+        std::mutex _mutex;
+        std::vector<void *> _slabs;
+        char *_nextSegment;
+        char *_segmentsEnd;
+        std::size_t _nextSlabBytes;
+        // Chain of the blocks too large for segments, through their headers.
+        void *_large;
+        std::atomic<long> _live;
+        std::atomic<std::size_t> _used;
+        arena_scope *_outer;
+    };
+
+    /*!
+     * \brief Binds an arena, or none for nullptr, on the calling thread while alive, without owning it.
+     *
+     * ParallelFor binds the arena of its caller on the workers running its chunks.
+     */
+    class arena_binding {
+    public:
+        explicit arena_binding(arena_scope *arena);
+
+        ~arena_binding();
+
+        arena_binding(const arena_binding &) = delete;
+
+        arena_binding &operator=(const arena_binding &) = delete;
+
+    private:
+        arena_scope *_arena;
+        arena_scope *_previous;
+    };
+}
+
+#ifndef ALGEBRA_LIB_SPARSE_ALLOCATOR
+#define ALGEBRA_LIB_SPARSE_ALLOCATOR algebra_lib::pool_allocator
+#endif
+
+namespace algebra_lib {
+    /*!
+     * \brief Allocator used by the storage of sparse_vector and sparse_matrix.
+     */
+    template<typename T>
+    using sparseAllocator = ALGEBRA_LIB_SPARSE_ALLOCATOR<T>;
+}
+
+#endif //LINEARALGEBRA_POOLALLOCATOR_HPP
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include "parallel.hpp"
+#include "symmetric_matrix.hpp"
+#include "preconditioner.hpp"
+
+namespace algebra_lib {
+    namespace {
+        diagonal_matrix Diagonal(const sparse_matrix &A) {
+            if (A.rows() != A.columns()) {
+                throw std::length_error("Preconditioner: matrix is not square.");
+            }
+            diagonal_matrix D(A.rows());
+            for (auto const &row : A) {
+                auto entry = std::lower_bound(row.second.indices(), row.second.indices() + row.second.nonZeros(),
+                                              row.first);
+                if (entry != row.second.indices() + row.second.nonZeros() and *entry == row.first)
+                    D[row.first] = row.second.values()[entry - row.second.indices()];
+            }
+            return D;
+        }
+    }
+
+    jacobi_preconditioner::jacobi_preconditioner(const sparse_matrix &A) : _inverse(Diagonal(A).Inverse()) {}
+
+    void jacobi_preconditioner::Apply(const vector &R, vector &Z) const {
+        auto r = R.begin();
+        auto z = Z.begin();
+        auto d = _inverse.diagonal().begin();
+        ParallelFor(0, R.size(), [&](unsigned long first, unsigned long last) {
+            for (unsigned long i = first; i < last; ++i) {
+                z[i] = d[i] * r[i];
+            }
+        }, 16384);
+    }
+
+    block_jacobi_preconditioner::block_jacobi_preconditioner(const sparse_matrix &A, unsigned int blockSize)
+            : _dimension(A.rows()), _blockSize(blockSize) {
+        if (A.rows() != A.columns()) {
+            throw std::length_error("Preconditioner: matrix is not square.");
+        } else if (blockSize == 0) {
+            throw std::invalid_argument("Block Jacobi preconditioner: block size must be positive.");
+        }
+
+        std::vector<const sparse_vector *> storedRows(_dimension, nullptr);
+        for (auto const &row : A) {
+            storedRows[row.first] = &row.second;
+        }
+
+        // Every full block takes the same packed space, so block b starts at b times that.
+        const unsigned long packedBlock = static_cast<unsigned long>(blockSize) * (blockSize + 1) / 2;
+        const unsigned long blocks = (_dimension + blockSize - 1) / blockSize;
+        _factors.assign(blocks * packedBlock, 0.0);
+        ParallelFor(0, blocks, [&](unsigned long first, unsigned long last) {
+            for (unsigned long block = first; block < last; ++block) {
+                unsigned int begin = static_cast<unsigned int>(block * blockSize);
+                unsigned int size = std::min(blockSize, _dimension - begin);
+                symmetric_matrix Block(size);
+                for (unsigned int row = 0; row < size; ++row) {
+                    const sparse_vector *Row = storedRows[begin + row];
+                    if (Row == nullptr) continue;
+                    for (auto const &entry : *Row) {
+                        if (entry.first > begin + row) break;
+                        if (entry.first >= begin) Block(row, entry.first - begin) = entry.second;
+                    }
+                }
+                matrix L = Block.CholeskyDecompose();
+                double *packed = _factors.data() + block * packedBlock;
+                for (unsigned int row = 0; row < size; ++row) {
+                    auto l = L[row].begin();
+                    packed = std::copy(l, l + row + 1, packed);
+                }
+            }
+        }, 16);
+    }
+
+    void block_jacobi_preconditioner::Apply(const vector &R, vector &Z) const {
+        const unsigned long packedBlock = static_cast<unsigned long>(_blockSize) * (_blockSize + 1) / 2;
+        const unsigned long blocks = (_dimension + _blockSize - 1) / _blockSize;
+        auto r = R.begin();
+        auto z = Z.begin();
+        ParallelFor(0, blocks, [&](unsigned long first, unsigned long last) {
+            for (unsigned long block = first; block < last; ++block) {
+                unsigned long begin = block * _blockSize;
+                unsigned int size = static_cast<unsigned int>(std::min<unsigned long>(_blockSize, _dimension - begin));
+                const double *factor = _factors.data() + block * packedBlock;
+                auto x = z + static_cast<long>(begin);
+                // L y = r by rows, then L^T x = y by columns of L^T, which are rows of L.
+                const double *l = factor;
+                for (unsigned int i = 0; i < size; l += ++i) {
+                    double sum = r[begin + i];
+                    for (unsigned int j = 0; j < i; ++j) {
+                        sum -= l[j] * x[j];
+                    }
+                    x[i] = sum / l[i];
+                }
+                for (unsigned int i = size; i-- > 0;) {
+                    l = factor + static_cast<unsigned long>(i) * (i + 1) / 2;
+                    x[i] /= l[i];
+                    for (unsigned int j = 0; j < i; ++j) {
+                        x[j] -= l[j] * x[i];
+                    }
+                }
+            }
+        }, 64);
+    }
+
+    incomplete_cholesky_preconditioner::incomplete_cholesky_preconditioner(const sparse_matrix &L) : _plan(L) {}
+
+    void incomplete_cholesky_preconditioner::Apply(const vector &R, vector &Z) const {
+        _plan.Solve(R, Z);
+        _plan.SolveTransposed(Z, Z);
+    }
+}
@@ -0,0 +1,97 @@
+/*! \file preconditioner.hpp
+ * \brief Preconditioners for the iterative solvers.
+ *
+ * A preconditioner approximates \f$ A^{-1} \f$ for a symmetric positive definite A. The
+ * solvers only call Apply, once per iteration, into a vector they allocated up front, so
+ * applying a preconditioner doesn't allocate.
+ */
+
+#ifndef LINEARALGEBRA_PRECONDITIONER_HPP
+#define LINEARALGEBRA_PRECONDITIONER_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "sparse_matrix.hpp"
+#include "diagonal_matrix.hpp"
+#include "triangular_solve.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Interface of preconditioners M, approximating the inverse of a symmetric positive definite matrix.
+     */
+    class preconditioner {
+    public:
+        virtual ~preconditioner() = default;
+
+        /*!
+         * \brief Z = M R.
+         * @param R Column vector, typically a residual.
+         * @param Z Column vector of the same dimension as R, overwritten.
+         */
+        virtual void Apply(const vector &R, vector &Z) const = 0;
+    };
+
+    /*!
+     * \brief Inverse of the diagonal of A.
+     */
+    class jacobi_preconditioner : public preconditioner {
+    public:
+        /*!
+         * @throw std::length_error A is not square.
+         * @throw std::domain_error A diagonal entry of A is zero.
+         */
+        explicit jacobi_preconditioner(const sparse_matrix &A);
+
+        void Apply(const vector &R, vector &Z) const override;
+
+    private:
+        diagonal_matrix _inverse;
+    };
+
+    /*!
+     * \brief Inverse of the diagonal blocks of A, through their Cholesky factors.
+     *
+     * Blocks are consecutive ranges of blockSize rows, the last one possibly smaller.
+     * Entries of A outside the diagonal blocks are ignored.
+     */
+    class block_jacobi_preconditioner : public preconditioner {
+    public:
+        /*!
+         * @throw std::length_error A is not square.
+         * @throw std::invalid_argument blockSize is zero.
+         * @throw std::domain_error A diagonal block of A is not positive definite.
+         */
+        block_jacobi_preconditioner(const sparse_matrix &A, unsigned int blockSize);
+
+        void Apply(const vector &R, vector &Z) const override;
+
+    private:
+        unsigned int _dimension;
+        unsigned int _blockSize;
+        // Packed lower triangles of the block factors, one after the other.
+        std::vector<double> _factors;
+    };
+
+    /*!
+     * \brief \f$ (L L^T)^{-1} \f$ for a given lower triangular L, applied by forward and back substitution.
+     *
+     * L is typically an incomplete Cholesky factor of A. Both substitutions are level
+     * scheduled, with the plan made once on construction.
+     */
+    class incomplete_cholesky_preconditioner : public preconditioner {
+    public:
+        /*!
+         * @param L Lower triangular matrix with non-zero diagonal. Entries above the diagonal are ignored.
+         * @throw std::length_error L is not square.
+         * @throw std::domain_error A diagonal entry of L is zero.
+         */
+        explicit incomplete_cholesky_preconditioner(const sparse_matrix &L);
+
+        void Apply(const vector &R, vector &Z) const override;
+
+    private:
+        triangular_solve_plan _plan;
+    };
+}
+
+#endif //LINEARALGEBRA_PRECONDITIONER_HPP
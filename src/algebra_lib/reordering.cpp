@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include "parallel.hpp"
+#include "reordering.hpp"
+
+namespace algebra_lib {
+    namespace {
+        typedef std::vector<std::vector<unsigned int>> adjacencyLists;
+
+        /*
+         * Neighbours of every node in the graph of A + A^T, sorted, without the node itself.
+         */
+        adjacencyLists SymmetricPattern(const sparse_matrix &A) {
+            if (A.rows() != A.columns()) {
+                throw std::length_error("Reordering: matrix is not square.");
+            }
+            adjacencyLists adjacency(A.rows());
+            for (auto const &row : A) {
+                for (auto const &entry : row.second) {
+                    if (entry.first == row.first or entry.second == 0) continue;
+                    adjacency[row.first].push_back(entry.first);
+                    adjacency[entry.first].push_back(row.first);
+                }
+            }
+            ParallelFor(0, adjacency.size(), [&](unsigned long first, unsigned long last) {
+                for (unsigned long node = first; node < last; ++node) {
+                    std::vector<unsigned int> &neighbours = adjacency[node];
+                    std::sort(neighbours.begin(), neighbours.end());
+                    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+                }
+            }, 1024);
+            return adjacency;
+        }
+
+        /*
+         * Breadth first search from root, visiting the neighbours of a node in order of
+         * increasing degree. Appends the visited nodes to order, sets their distance from
+         * root and returns the number of levels. distance must be -1 for unvisited nodes.
+         */
+        unsigned int BreadthFirst(const adjacencyLists &adjacency, unsigned int root, std::vector<int> &distance,
+                                  std::vector<unsigned int> &order) {
+            std::size_t head = order.size();
+            order.push_back(root);
+            distance[root] = 0;
+            int deepest = 0;
+            while (head < order.size()) {
+                unsigned int node = order[head++];
+                std::size_t next = order.size();
+                for (unsigned int neighbour : adjacency[node]) {
+                    if (distance[neighbour] >= 0) continue;
+                    distance[neighbour] = distance[node] + 1;
+                    deepest = distance[neighbour];
+                    order.push_back(neighbour);
+                }
+                std::stable_sort(order.begin() + next, order.end(), [&adjacency](unsigned int a, unsigned int b) {
+                    return adjacency[a].size() < adjacency[b].size();
+                });
+            }
+            return static_cast<unsigned int>(deepest + 1);
+        }
+
+        /*
+         * George and Liu: move the root to a node of least degree in the last level for as
+         * long as that adds levels.
+         */
+        unsigned int PseudoPeripheralNode(const adjacencyLists &adjacency, unsigned int start,
+                                          std::vector<int> &distance) {
+            std::vector<unsigned int> visited;
+            std::vector<unsigned int> candidateVisited;
+            unsigned int root = start;
+            unsigned int levels = BreadthFirst(adjacency, root, distance, visited);
+            while (true) {
+                unsigned int candidate = visited.back();
+                for (unsigned int node : visited) {
+                    if (distance[node] == static_cast<int>(levels - 1) and
+                        adjacency[node].size() < adjacency[candidate].size())
+                        candidate = node;
+                }
+                for (unsigned int node : visited) {
+                    distance[node] = -1;
+                }
+
+                candidateVisited.clear();
+                unsigned int candidateLevels = BreadthFirst(adjacency, candidate, distance, candidateVisited);
+                if (candidateLevels <= levels) {
+                    for (unsigned int node : candidateVisited) {
+                        distance[node] = -1;
+                    }
+                    return root;
+                }
+                root = candidate;
+                levels = candidateLevels;
+                visited.swap(candidateVisited);
+            }
+        }
+    }
+
+    std::vector<unsigned int> ReverseCuthillMcKee(const sparse_matrix &A) {
+        adjacencyLists adjacency = SymmetricPattern(A);
+        const unsigned int n = A.rows();
+        // distance is reset after every search for a root, numbered keeps the distances of
+        // the final searches and so marks the nodes that have a number.
+        std::vector<int> distance(n, -1);
+        std::vector<int> numbered(n, -1);
+        std::vector<unsigned int> order;
+        order.reserve(n);
+        for (unsigned int node = 0; node < n; ++node) {
+            if (numbered[node] >= 0) continue;
+            BreadthFirst(adjacency, PseudoPeripheralNode(adjacency, node, distance), numbered, order);
+        }
+        std::reverse(order.begin(), order.end());
+        return order;
+    }
+
+    std::vector<unsigned int> ApproximateMinimumDegree(const sparse_matrix &A) {
+        const unsigned int n = A.rows();
+        // Quotient graph: every uneliminated variable keeps its variable neighbours and its
+        // elements, every eliminated variable that isn't absorbed yet is an element with
+        // the variables it connects.
+        adjacencyLists variables = SymmetricPattern(A);
+        adjacencyLists elements(n);
+        adjacencyLists elementVariables(n);
+        std::vector<char> eliminated(n, 0);
+        std::vector<char> absorbed(n, 0);
+        std::vector<unsigned int> degree(n);
+        std::vector<unsigned int> inPivot(n, n);
+        std::vector<long> external(n, -1);
+        std::vector<unsigned int> touched;
+        std::vector<unsigned int> pivotVariables;
+
+        typedef std::pair<unsigned int, unsigned int> degreeNode;
+        std::priority_queue<degreeNode, std::vector<degreeNode>, std::greater<degreeNode>> candidates;
+        for (unsigned int node = 0; node < n; ++node) {
+            degree[node] = static_cast<unsigned int>(variables[node].size());
+            candidates.emplace(degree[node], node);
+        }
+
+        std::vector<unsigned int> order;
+        order.reserve(n);
+        for (unsigned int k = 0; k < n; ++k) {
+            // Entries whose degree has changed since they were queued are stale.
+            unsigned int pivot;
+            do {
+                pivot = candidates.top().second;
+                unsigned int queuedDegree = candidates.top().first;
+                candidates.pop();
+                if (!eliminated[pivot] and queuedDegree == degree[pivot]) break;
+            } while (true);
+            eliminated[pivot] = 1;
+            order.push_back(pivot);
+
+            // The new element joins the pivot's variables and the variables of its elements,
+            // which it absorbs.
+            pivotVariables.clear();
+            inPivot[pivot] = k;
+            for (unsigned int variable : variables[pivot]) {
+                if (eliminated[variable] or inPivot[variable] == k) continue;
+                inPivot[variable] = k;
+                pivotVariables.push_back(variable);
+            }
+            for (unsigned int element : elements[pivot]) {
+                if (absorbed[element]) continue;
+                for (unsigned int variable : elementVariables[element]) {
+                    if (eliminated[variable] or inPivot[variable] == k) continue;
+                    inPivot[variable] = k;
+                    pivotVariables.push_back(variable);
+                }
+                absorbed[element] = 1;
+                std::vector<unsigned int>().swap(elementVariables[element]);
+            }
+            elementVariables[pivot] = pivotVariables;
+            std::vector<unsigned int>().swap(variables[pivot]);
+            std::vector<unsigned int>().swap(elements[pivot]);
+
+            // |L_e \ L_p| for every element e next to the new element.
+            touched.clear();
+            for (unsigned int variable : pivotVariables) {
+                for (unsigned int element : elements[variable]) {
+                    if (absorbed[element]) continue;
+                    if (external[element] < 0) {
+                        std::vector<unsigned int> &members = elementVariables[element];
+                        members.erase(std::remove_if(members.begin(), members.end(), [&eliminated](unsigned int v) {
+                            return eliminated[v] != 0;
+                        }), members.end());
+                        external[element] = static_cast<long>(members.size());
+                        touched.push_back(element);
+                    }
+                    --external[element];
+                }
+            }
+
+            // Variables of the new element: drop absorbed elements and the edges the new
+            // element covers, and bound their degree as AMD does.
+            const unsigned long remaining = n - k - 1;
+            for (unsigned int variable : pivotVariables) {
+                std::vector<unsigned int> &variableElements = elements[variable];
+                variableElements.erase(std::remove_if(variableElements.begin(), variableElements.end(),
+                                                      [&absorbed](unsigned int e) { return absorbed[e] != 0; }),
+                                       variableElements.end());
+                std::vector<unsigned int> &neighbours = variables[variable];
+                neighbours.erase(std::remove_if(neighbours.begin(), neighbours.end(), [&](unsigned int v) {
+                    return eliminated[v] != 0 or inPivot[v] == k;
+                }), neighbours.end());
+
+                unsigned long bound = neighbours.size() + pivotVariables.size() - 1;
+                for (unsigned int element : variableElements) {
+                    bound += static_cast<unsigned long>(external[element]);
+                }
+                variableElements.push_back(pivot);
+                bound = std::min(bound, remaining);
+                bound = std::min(bound, static_cast<unsigned long>(degree[variable]) + pivotVariables.size() - 1);
+                degree[variable] = static_cast<unsigned int>(bound);
+                candidates.emplace(degree[variable], variable);
+            }
+            for (unsigned int element : touched) {
+                external[element] = -1;
+            }
+        }
+        return order;
+    }
+
+    std::vector<unsigned int> InvertPermutation(const std::vector<unsigned int> &permutation) {
+        std::vector<unsigned int> inverse(permutation.size(), static_cast<unsigned int>(permutation.size()));
+        for (unsigned int i = 0; i < permutation.size(); ++i) {
+            if (permutation[i] >= permutation.size() or inverse[permutation[i]] != permutation.size()) {
+                throw std::invalid_argument("Permutation: indices are not a permutation.");
+            }
+            inverse[permutation[i]] = i;
+        }
+        return inverse;
+    }
+
+    sparse_matrix PermuteSymmetric(const sparse_matrix &A, const std::vector<unsigned int> &permutation) {
+        if (A.rows() != A.columns() or A.rows() != permutation.size()) {
+            throw std::length_error("Permutation: matrix and permutation are not compatible in dimension");
+        }
+        std::vector<unsigned int> inverse = InvertPermutation(permutation);
+        std::vector<const sparse_vector *> storedRows(A.rows(), nullptr);
+        for (auto const &row : A) {
+            storedRows[row.first] = &row.second;
+        }
+
+        std::vector<sparse_vector> permutedRows(A.rows());
+        ParallelFor(0, A.rows(), [&](unsigned long first, unsigned long last) {
+            std::vector<std::pair<unsigned int, double>> entries;
+            for (unsigned long row = first; row < last; ++row) {
+                const sparse_vector *Row = storedRows[permutation[row]];
+                if (Row == nullptr or Row->nonZeros() == 0) continue;
+                entries.clear();
+                for (auto const &entry : *Row) {
+                    entries.emplace_back(inverse[entry.first], entry.second);
+                }
+                std::sort(entries.begin(), entries.end());
+                sparse_vector Permuted(A.columns(), false);
+                Permuted.Reserve(static_cast<unsigned int>(entries.size()));
+                for (auto const &entry : entries) {
+                    Permuted.Append(entry.first, entry.second);
+                }
+                permutedRows[row] = std::move(Permuted);
+            }
+        }, 256);
+
+        sparse_matrix Permuted(A.rows(), A.columns());
+        for (unsigned int row = 0; row < A.rows(); ++row) {
+            if (storedRows[permutation[row]] != nullptr and storedRows[permutation[row]]->nonZeros() > 0)
+                Permuted.AppendRow(row, std::move(permutedRows[row]));
+        }
+        return Permuted;
+    }
+
+    vector Permute(const vector &U, const std::vector<unsigned int> &permutation) {
+        if (U.size() != permutation.size()) {
+            throw std::length_error("Permutation: vector and permutation are not compatible in dimension");
+        }
+        vector Permuted(U.size(), U.isColumn());
+        auto u = U.begin();
+        auto permuted = Permuted.begin();
+        for (unsigned long i = 0; i < U.size(); ++i) {
+            permuted[i] = u[permutation[i]];
+        }
+        return Permuted;
+    }
+
+    vector InversePermute(const vector &U, const std::vector<unsigned int> &permutation) {
+        if (U.size() != permutation.size()) {
+            throw std::length_error("Permutation: vector and permutation are not compatible in dimension");
+        }
+        vector Permuted(U.size(), U.isColumn());
+        auto u = U.begin();
+        auto permuted = Permuted.begin();
+        for (unsigned long i = 0; i < U.size(); ++i) {
+            permuted[permutation[i]] = u[i];
+        }
+        return Permuted;
+    }
+
+    unsigned int Bandwidth(const sparse_matrix &A) {
+        unsigned int bandwidth = 0;
+        for (auto const &row : A) {
+            if (row.second.nonZeros() == 0) continue;
+            unsigned int first = row.second.begin()->first;
+            unsigned int last = row.second.rbegin()->first;
+            if (first < row.first) bandwidth = std::max(bandwidth, row.first - first);
+            if (last > row.first) bandwidth = std::max(bandwidth, last - row.first);
+        }
+        return bandwidth;
+    }
+}
@@ -0,0 +1,69 @@
+/*! \file reordering.hpp
+ * \brief Bandwidth and fill reducing orderings, and symmetric permutations.
+ *
+ * The ordering of the unknowns decides how much a Cholesky factor fills in, and how far
+ * apart the entries of x are that a row of a product reads. Reverse Cuthill-McKee numbers
+ * the unknowns breadth first, which keeps them within a narrow band: good for products,
+ * band_matrix and triangular solves. Approximate minimum degree eliminates the unknown
+ * of least (estimated) degree first, which keeps the fill of a factor small.
+ *
+ * A permutation p lists the old index of every new index: row i of \f$ P A P^T \f$ is row
+ * \f$ p_i \f$ of A, and \f$ (P x)_i = x_{p_i} \f$. Orderings are computed from the pattern
+ * of \f$ A + A^T \f$, so A doesn't need to be stored symmetrically.
+ */
+
+#ifndef LINEARALGEBRA_REORDERING_HPP
+#define LINEARALGEBRA_REORDERING_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "sparse_matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Reverse Cuthill-McKee ordering, every connected component started from a pseudo-peripheral node.
+     * @throw std::length_error A is not square.
+     */
+    std::vector<unsigned int> ReverseCuthillMcKee(const sparse_matrix &A);
+
+    /*!
+     * \brief Approximate minimum degree ordering.
+     *
+     * Eliminates on the quotient graph, absorbing elements and bounding the degrees of the
+     * neighbours of a pivot as in AMD, but without supervariable detection.
+     * @throw std::length_error A is not square.
+     */
+    std::vector<unsigned int> ApproximateMinimumDegree(const sparse_matrix &A);
+
+    /*!
+     * \brief Inverse permutation q, with \f$ q_{p_i} = i \f$.
+     * @throw std::invalid_argument permutation is not a permutation.
+     */
+    std::vector<unsigned int> InvertPermutation(const std::vector<unsigned int> &permutation);
+
+    /*!
+     * \brief Symmetric permutation \f$ P A P^T \f$.
+     * @throw std::length_error A is not square, or not of the dimension of permutation.
+     * @throw std::invalid_argument permutation is not a permutation.
+     */
+    sparse_matrix PermuteSymmetric(const sparse_matrix &A, const std::vector<unsigned int> &permutation);
+
+    /*!
+     * \brief Permuted vector \f$ P u \f$.
+     * @throw std::length_error U is not of the dimension of permutation.
+     */
+    vector Permute(const vector &U, const std::vector<unsigned int> &permutation);
+
+    /*!
+     * \brief Vector permuted back, \f$ P^T u \f$.
+     * @throw std::length_error U is not of the dimension of permutation.
+     */
+    vector InversePermute(const vector &U, const std::vector<unsigned int> &permutation);
+
+    /*!
+     * \brief Largest distance \f$ |i - j| \f$ of a stored entry from the diagonal.
+     */
+    unsigned int Bandwidth(const sparse_matrix &A);
+}
+
+#endif //LINEARALGEBRA_REORDERING_HPP
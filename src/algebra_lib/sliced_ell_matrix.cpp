@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <numeric>
+#include "parallel.hpp"
+#include "mixed_algebra.hpp"
+#include "sliced_ell_matrix.hpp"
+
+namespace algebra_lib {
+    namespace {
+        void CheckChunking(unsigned int chunkRows, unsigned int sortWindow) {
+            if (chunkRows == 0 or sortWindow == 0 or sortWindow % chunkRows != 0) {
+                throw std::invalid_argument(
+                        "Sliced ELLPACK: sort window must be a positive multiple of the positive chunk size.");
+            }
+        }
+
+        std::vector<unsigned int> RowLengths(const sparse_matrix &A) {
+            std::vector<unsigned int> lengths(A.rows(), 0);
+            for (auto const &row : A) {
+                lengths[row.first] = row.second.nonZeros();
+            }
+            return lengths;
+        }
+
+        /*
+         * Rows sorted by decreasing length within every window, padded with rows() to a
+         * whole number of chunks.
+         */
+        std::vector<unsigned int> SortedRowOrder(const std::vector<unsigned int> &lengths,
+                                                 unsigned int chunkRows, unsigned int sortWindow) {
+            unsigned long rows = lengths.size();
+            unsigned long slots = (rows + chunkRows - 1) / chunkRows * chunkRows;
+            std::vector<unsigned int> order(slots, static_cast<unsigned int>(rows));
+            std::iota(order.begin(), order.begin() + rows, 0u);
+            for (unsigned long window = 0; window < rows; window += sortWindow) {
+                std::stable_sort(order.begin() + window, order.begin() + std::min(rows, window + sortWindow),
+                                 [&lengths](unsigned int a, unsigned int b) { return lengths[a] > lengths[b]; });
+            }
+            return order;
+        }
+
+        unsigned int ChunkWidth(const std::vector<unsigned int> &lengths, const std::vector<unsigned int> &order,
+                                unsigned long chunk, unsigned int chunkRows) {
+            unsigned int width = 0;
+            for (unsigned long lane = chunk * chunkRows; lane < (chunk + 1) * chunkRows; ++lane) {
+                if (order[lane] < lengths.size()) width = std::max(width, lengths[order[lane]]);
+            }
+            return width;
+        }
+
+        /*
+         * Kernels are templates on the chunk size, Fixed = 0 meaning the size is only known
+         * at run time. The inner loop runs over the lanes of a chunk, with constant trip
+         * count for a fixed size so the compiler can vectorize it.
+         */
+        template<unsigned int Fixed>
+        void MultiplyChunks(const sliced_ell_matrix &A, contentVectorDouble::const_iterator u,
+                            contentVectorDouble::iterator y, unsigned long first, unsigned long last) {
+            const unsigned int c = Fixed ? Fixed : A.chunkRows();
+            const unsigned long *offsets = A.chunkOffsets().data();
+            const unsigned int *widths = A.chunkWidths().data();
+            const unsigned int *order = A.rowOrder().data();
+            const unsigned int *laneLengths = A.laneLengths().data();
+            const unsigned int *columnIndices = A.columnIndices().data();
+            const double *values = A.values().data();
+            double fixedSum[Fixed ? Fixed : 1];
+            std::vector<double> dynamicSum(Fixed ? 0 : c);
+            double *sum = Fixed ? fixedSum : dynamicSum.data();
+            for (unsigned long chunk = first; chunk < last; ++chunk) {
+                std::fill(sum, sum + c, 0.0);
+                const unsigned int *column = columnIndices + offsets[chunk];
+                const double *value = values + offsets[chunk];
+                const unsigned int *length = laneLengths + chunk * c;
+                // Up to the shortest lane every lane holds an entry. Past it, padding is skipped
+                // rather than multiplied, so an Inf or NaN in u can't leak into rows without
+                // an entry in its column.
+                const unsigned int full = *std::min_element(length, length + c);
+                unsigned int j = 0;
+                for (; j < full; ++j, column += c, value += c) {
+                    for (unsigned int lane = 0; lane < c; ++lane) {
+                        sum[lane] += value[lane] * u[column[lane]];
+                    }
+                }
+                for (; j < widths[chunk]; ++j, column += c, value += c) {
+                    for (unsigned int lane = 0; lane < c; ++lane) {
+                        if (j < length[lane]) sum[lane] += value[lane] * u[column[lane]];
+                    }
+                }
+                for (unsigned int lane = 0; lane < c; ++lane) {
+                    unsigned int row = order[chunk * c + lane];
+                    if (row < A.rows()) y[row] = sum[lane];
+                }
+            }
+        }
+
+        typedef void (*chunkKernel)(const sliced_ell_matrix &, contentVectorDouble::const_iterator,
+                                    contentVectorDouble::iterator, unsigned long, unsigned long);
+
+        chunkKernel SelectChunkKernel(unsigned int chunkRows) {
+            switch (chunkRows) {
+                case 4: return MultiplyChunks<4>;
+                case 8: return MultiplyChunks<8>;
+                case 16: return MultiplyChunks<16>;
+                case 32: return MultiplyChunks<32>;
+                default: return MultiplyChunks<0>;
+            }
+        }
+    }
+
+    sliced_ell_matrix::sliced_ell_matrix(const sparse_matrix &A, unsigned int chunkRows, unsigned int sortWindow)
+            : _rows(A.rows()), _columns(A.columns()), _chunkRows(chunkRows), _sortWindow(sortWindow), _nonZeros(0) {
+        CheckChunking(chunkRows, sortWindow);
+
+        std::vector<const sparse_vector *> storedRows(_rows, nullptr);
+        for (auto const &row : A) {
+            storedRows[row.first] = &row.second;
+        }
+        std::vector<unsigned int> lengths = RowLengths(A);
+        _nonZeros = std::accumulate(lengths.begin(), lengths.end(), 0ul);
+        _rowOrder = SortedRowOrder(lengths, chunkRows, sortWindow);
+
+        unsigned long chunks = _rowOrder.size() / chunkRows;
+        _chunkWidths.resize(chunks);
+        _chunkOffsets.assign(chunks + 1, 0);
+        for (unsigned long chunk = 0; chunk < chunks; ++chunk) {
+            _chunkWidths[chunk] = ChunkWidth(lengths, _rowOrder, chunk, chunkRows);
+            _chunkOffsets[chunk + 1] = _chunkOffsets[chunk] + static_cast<unsigned long>(_chunkWidths[chunk]) * chunkRows;
+        }
+
+        // Padding points at column 0 with value 0. The kernels stop every lane at its length.
+        _laneLengths.resize(_rowOrder.size());
+        for (unsigned long lane = 0; lane < _rowOrder.size(); ++lane) {
+            _laneLengths[lane] = _rowOrder[lane] < _rows ? lengths[_rowOrder[lane]] : 0;
+        }
+        _columnIndices.assign(_chunkOffsets[chunks], 0);
+        _values.assign(_chunkOffsets[chunks], 0.0);
+        ParallelFor(0, chunks, [&](unsigned long first, unsigned long last) {
+            for (unsigned long chunk = first; chunk < last; ++chunk) {
+                for (unsigned int lane = 0; lane < _chunkRows; ++lane) {
+                    unsigned int row = _rowOrder[chunk * _chunkRows + lane];
+                    if (row >= _rows or storedRows[row] == nullptr) continue;
+                    unsigned long position = _chunkOffsets[chunk] + lane;
+                    for (auto const &entry : *storedRows[row]) {
+                        _columnIndices[position] = entry.first;
+                        _values[position] = entry.second;
+                        position += _chunkRows;
+                    }
+                }
+            }
+        }, 64);
+    }
+
+    sparse_matrix sliced_ell_matrix::ToSparse() const {
+        std::vector<unsigned long> laneOf(_rows);
+        for (unsigned long lane = 0; lane < _rowOrder.size(); ++lane) {
+            if (_rowOrder[lane] < _rows) laneOf[_rowOrder[lane]] = lane;
+        }
+
+        sparse_matrix Sparse(_rows, _columns);
+        for (unsigned int row = 0; row < _rows; ++row) {
+            unsigned long chunk = laneOf[row] / _chunkRows;
+            unsigned long position = _chunkOffsets[chunk] + laneOf[row] % _chunkRows;
+            sparse_vector Row(_columns, false);
+            for (unsigned int j = 0; j < _laneLengths[laneOf[row]]; ++j, position += _chunkRows) {
+                if (_values[position] != 0)
+                    Row.Append(_columnIndices[position], _values[position]);
+            }
+            if (Row.nonZeros() > 0)
+                Sparse.AppendRow(row, std::move(Row));
+        }
+        return Sparse;
+    }
+
+    vector operator*(const sliced_ell_matrix &A, const vector &U) {
+        if (A.columns() != U.size()) {
+            throw std::length_error(
+                    "Left multiplication with matrix: vector and matrix are not compatible in dimension");
+        } else if (!U.isColumn()) {
+            throw std::invalid_argument(
+                    "Left multiplication with matrix: vector is not a column vector! First transpose it for goodness' sake.");
+        }
+
+        vector Product(A.rows(), true);
+        chunkKernel kernel = SelectChunkKernel(A.chunkRows());
+        auto u = U.begin();
+        auto y = Product.begin();
+        ParallelFor(0, A.chunks(), [&](unsigned long first, unsigned long last) {
+            kernel(A, u, y, first, last);
+        }, 64);
+        return Product;
+    }
+
+    sparse_vector operator*(const sliced_ell_matrix &A, const sparse_vector &U) {
+        if (A.columns() != U.size()) {
+            throw std::length_error(
+                    "Left multiplication with matrix: vector and matrix are not compatible in dimension");
+        } else if (!U.isColumn()) {
+            throw std::invalid_argument(
+                    "Left multiplication with matrix: vector is not a column vector! First transpose it for goodness' sake.");
+        }
+        // The kernels gather from u by column index, so u is expanded first.
+        return ToSparse(A * ToFull(U));
+    }
+
+    double SlicedEllPadding(const sparse_matrix &A, unsigned int chunkRows, unsigned int sortWindow) {
+        CheckChunking(chunkRows, sortWindow);
+        std::vector<unsigned int> lengths = RowLengths(A);
+        unsigned long nonZeros = std::accumulate(lengths.begin(), lengths.end(), 0ul);
+        if (nonZeros == 0) return 0.0;
+
+        std::vector<unsigned int> order = SortedRowOrder(lengths, chunkRows, sortWindow);
+        unsigned long stored = 0;
+        for (unsigned long chunk = 0; chunk < order.size() / chunkRows; ++chunk) {
+            stored += static_cast<unsigned long>(ChunkWidth(lengths, order, chunk, chunkRows)) * chunkRows;
+        }
+        return static_cast<double>(stored - nonZeros) / nonZeros;
+    }
+
+    bool PreferSlicedEll(const sparse_matrix &A, unsigned int chunkRows, unsigned int sortWindow) {
+        // Rows this long keep the lanes of compressed rows busy by themselves.
+        const double longRow = 64.0;
+        const double maximumPadding = 0.25;
+
+        if (A.rows() < chunkRows) return false;
+        double nonZeros = 0.0;
+        for (auto const &row : A) {
+            nonZeros += row.second.nonZeros();
+        }
+        if (nonZeros == 0 or nonZeros / A.rows() >= longRow) return false;
+        return SlicedEllPadding(A, chunkRows, sortWindow) <= maximumPadding;
+    }
+}
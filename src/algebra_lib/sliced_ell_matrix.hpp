@@ -0,0 +1,142 @@
+/*! \file sliced_ell_matrix.hpp
+ * \brief Sliced ELLPACK (SELL-C-\f$ \sigma \f$) matrices.
+ *
+ * In compressed rows the inner loop of a matrix vector product runs along one row, so rows
+ * of different lengths leave vector lanes idle. Sliced ELLPACK cuts the rows into chunks
+ * of C rows and stores every chunk column major, padded to its longest row: the inner loop
+ * then runs across the C rows of a chunk, one row per lane. Sorting the rows by length
+ * within windows of \f$ \sigma \f$ rows groups rows of similar length into a chunk and
+ * keeps the padding small. PreferSlicedEll tells from the row lengths whether the format
+ * pays off for a given matrix.
+ */
+
+#ifndef LINEARALGEBRA_SLICEDELLMATRIX_HPP
+#define LINEARALGEBRA_SLICEDELLMATRIX_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "sparse_vector.hpp"
+#include "sparse_matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Class for sparse matrices in sliced ELLPACK storage, read only.
+     */
+    class sliced_ell_matrix {
+    public:
+        // Constructors
+        /*!
+         * \brief Convert a sparse matrix.
+         * @param A Sparse matrix.
+         * @param chunkRows Rows per chunk, C. Chunks of 4, 8, 16 and 32 rows get kernels with
+         * the chunk size fixed at compile time.
+         * @param sortWindow Rows are sorted by length within windows of this many rows, \f$ \sigma \f$.
+         * @throw std::invalid_argument chunkRows is zero, or sortWindow isn't a positive multiple of chunkRows.
+         */
+        explicit sliced_ell_matrix(const sparse_matrix &A, unsigned int chunkRows = 8, unsigned int sortWindow = 256);
+
+        // Member functions
+        unsigned int rows() const { return _rows; }
+
+        unsigned int columns() const { return _columns; }
+
+        unsigned int chunkRows() const { return _chunkRows; }
+
+        unsigned int sortWindow() const { return _sortWindow; }
+
+        unsigned long chunks() const { return _chunkWidths.size(); }
+
+        /*!
+         * \brief Number of entries of the converted matrix.
+         */
+        unsigned long nonZeros() const { return _nonZeros; }
+
+        /*!
+         * \brief Number of stored entries, padding included.
+         */
+        unsigned long storedEntries() const { return _values.size(); }
+
+        /*!
+         * \brief Convert to a sparse matrix, leaving out zero entries.
+         */
+        sparse_matrix ToSparse() const;
+
+        // Raw sliced ELLPACK arrays
+        /*!
+         * \brief Offsets of the chunks in columnIndices() and values(), chunks() + 1 long.
+         */
+        const std::vector<unsigned long> &chunkOffsets() const { return _chunkOffsets; }
+
+        /*!
+         * \brief Length of the longest row of every chunk.
+         */
+        const std::vector<unsigned int> &chunkWidths() const { return _chunkWidths; }
+
+        /*!
+         * \brief Original row of every lane, chunks() * chunkRows() long. Lanes past the last row hold rows().
+         */
+        const std::vector<unsigned int> &rowOrder() const { return _rowOrder; }
+
+        /*!
+         * \brief Entries of the row in every lane, chunks() * chunkRows() long. Slots past it are padding.
+         */
+        const std::vector<unsigned int> &laneLengths() const { return _laneLengths; }
+
+        /*!
+         * \brief Column of every stored entry, chunk after chunk, each column major.
+         */
+        const std::vector<unsigned int> &columnIndices() const { return _columnIndices; }
+
+        const std::vector<double> &values() const { return _values; }
+
+    private:
+        unsigned int _rows;
+        unsigned int _columns;
+        unsigned int _chunkRows;
+        unsigned int _sortWindow;
+        unsigned long _nonZeros;
+        std::vector<unsigned long> _chunkOffsets;
+        std::vector<unsigned int> _chunkWidths;
+        std::vector<unsigned int> _rowOrder;
+        std::vector<unsigned int> _laneLengths;
+        std::vector<unsigned int> _columnIndices;
+        std::vector<double> _values;
+    };
+
+    /**
+     *  \brief Sliced ELLPACK matrix vector product.
+     * @param A \f$ m \times n \f$ sliced ELLPACK matrix
+     * @param U \f$ n \times 1 \f$ (column) vector
+     * @return \f$ m \times 1 \f$ (column) vector
+     * @throw std::length_error A and U are not of compatible dimension.
+     * @throw std::invalid_argument U is not a column vector.
+     */
+    vector operator*(const sliced_ell_matrix &A, const vector &U);
+
+    /**
+     *  \brief Sliced ELLPACK matrix vector product.
+     * @param A \f$ m \times n \f$ sliced ELLPACK matrix
+     * @param U \f$ n \times 1 \f$ (column) sparse vector
+     * @return \f$ m \times 1 \f$ (column) sparse vector
+     * @throw std::length_error A and U are not of compatible dimension.
+     * @throw std::invalid_argument U is not a column vector.
+     */
+    sparse_vector operator*(const sliced_ell_matrix &A, const sparse_vector &U);
+
+    /*!
+     * \brief Padding entries sliced ELLPACK would store for A, per entry of A.
+     *
+     * Computed from the row lengths only, without converting A.
+     */
+    double SlicedEllPadding(const sparse_matrix &A, unsigned int chunkRows = 8, unsigned int sortWindow = 256);
+
+    /*!
+     * \brief Whether products with A are expected to be faster in sliced ELLPACK than in compressed rows.
+     *
+     * True when the padding stays below a quarter of the entries and the rows are short
+     * enough for the row by row loop of compressed rows to leave lanes idle.
+     */
+    bool PreferSlicedEll(const sparse_matrix &A, unsigned int chunkRows = 8, unsigned int sortWindow = 256);
+}
+
+#endif //LINEARALGEBRA_SLICEDELLMATRIX_HPP
@@ -4,10 +4,115 @@
 
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 #include "sparse_algebra.hpp"
 
 // --- Algebra functions
 namespace algebra_lib {
+    namespace {
+        /*
+         * If one vector stores this many times more entries than the other, the kernels below
+         * look the entries of the sparser one up in the denser one, instead of walking both.
+         */
+        const unsigned int sparseSearchRatio = 16;
+
+        /*
+         * Position of the first of the count sorted indices not below key, searching from
+         * position onwards with doubling steps, then bisecting the last step. Costs
+         * O(log d) for a distance d to the result, so a sequence of increasing keys costs
+         * O(n log(N / n)) in total instead of O(n log N).
+         */
+        unsigned int Gallop(const unsigned int *indices, unsigned int count, unsigned int position,
+                            unsigned int key) {
+            unsigned int step = 1;
+            unsigned int low = position;
+            while (position < count and indices[position] < key) {
+                low = position + 1;
+                position += step;
+                step *= 2;
+            }
+            unsigned int high = position < count ? position : count;
+            return static_cast<unsigned int>(std::lower_bound(indices + low, indices + high, key) - indices);
+        }
+
+        /*
+         * Calls visit(index, u, v) for every index stored in both U and V, in increasing order.
+         */
+        template<typename Visitor>
+        void IntersectSorted(const sparse_vector &U, const sparse_vector &V, Visitor visit) {
+            if (U.nonZeros() > sparseSearchRatio * V.nonZeros()) {
+                const unsigned int *indicesU = U.indices();
+                const double *valuesU = U.values();
+                unsigned int position = 0;
+                for (auto const &entryV : V) {
+                    position = Gallop(indicesU, U.nonZeros(), position, entryV.first);
+                    if (position == U.nonZeros()) return;
+                    if (indicesU[position] == entryV.first)
+                        visit(entryV.first, valuesU[position], entryV.second);
+                }
+                return;
+            } else if (V.nonZeros() > sparseSearchRatio * U.nonZeros()) {
+                const unsigned int *indicesV = V.indices();
+                const double *valuesV = V.values();
+                unsigned int position = 0;
+                for (auto const &entryU : U) {
+                    position = Gallop(indicesV, V.nonZeros(), position, entryU.first);
+                    if (position == V.nonZeros()) return;
+                    if (indicesV[position] == entryU.first)
+                        visit(entryU.first, entryU.second, valuesV[position]);
+                }
+                return;
+            }
+
+            auto u = U.begin();
+            auto v = V.begin();
+            while (u != U.end() and v != V.end()) {
+                if (u->first < v->first) {
+                    ++u;
+                } else if (v->first < u->first) {
+                    ++v;
+                } else {
+                    visit(u->first, u->second, v->second);
+                    ++u;
+                    ++v;
+                }
+            }
+        }
+
+        /*
+         * Union of the entries of U and V, combine(u, v) giving the value of every index, with
+         * zero for the side that doesn't store it. Entries that cancel out are not stored.
+         */
+        template<typename Combine>
+        sparse_vector MergeSorted(const sparse_vector &U, const sparse_vector &V, Combine combine) {
+            sparse_vector S(U.size(), U.isColumn());
+
+            auto u = U.begin();
+            auto v = V.begin();
+            while (u != U.end() or v != V.end()) {
+                unsigned int index;
+                double value;
+                if (v == V.end() or (u != U.end() and u->first < v->first)) {
+                    index = u->first;
+                    value = combine(u->second, 0.0);
+                    ++u;
+                } else if (u == U.end() or v->first < u->first) {
+                    index = v->first;
+                    value = combine(0.0, v->second);
+                    ++v;
+                } else {
+                    index = u->first;
+                    value = combine(u->second, v->second);
+                    ++u;
+                    ++v;
+                }
+                if (value != 0)
+                    S.Append(index, value);
+            }
+            return S;
+        }
+    }
+
 
     sparse_matrix operator*(const sparse_matrix &A, const sparse_matrix &B) {
 
@@ -48,38 +153,28 @@ namespace algebra_lib {
 
     double operator*(const sparse_vector &U, const sparse_vector &V) {
         if (U.size() != V.size()) throw std::length_error("Vectors are not the same dimension");
+
         double sum = 0.0;
-        for (auto const &entryU : U) {
-            auto lookup = V.find(entryU.first);
-            if (lookup != V.end()) {
-                sum += entryU.second * lookup->second;
-            }
-        }
+        IntersectSorted(U, V, [&sum](unsigned int, double u, double v) {
+            sum += u * v;
+        });
         return sum;
     }
 
     sparse_vector operator+(const sparse_vector &U, const sparse_vector &V) {
         if (U.size() != V.size()) throw std::length_error("Vectors are not the same dimension");
-        sparse_vector S = U;
-        for (auto const &entryV : V) {
-            S(entryV.first) += entryV.second;
-        }
-        return S;
+        return MergeSorted(U, V, [](double u, double v) { return u + v; });
     }
 
     sparse_vector operator-(const sparse_vector &U, const sparse_vector &V) {
         if (U.size() != V.size()) throw std::length_error("Vectors are not the same dimension");
-        sparse_vector S = U;
-        for (auto const &entryV : V) {
-            S(entryV.first) -= entryV.second;
-        }
-        return S;
+        return MergeSorted(U, V, [](double u, double v) { return u - v; });
     }
 
     sparse_vector operator*(const sparse_vector &U, const double m) {
-        sparse_vector V = U;
-        for (auto &entry : V) {
-            V(entry.first) = entry.second / m;
+        sparse_vector V(U.size(), U.isColumn());
+        for (auto const &entry : U) {
+            V.Append(entry.first, entry.second * m);
         }
         return V;
     }
@@ -89,9 +184,9 @@ namespace algebra_lib {
     }
 
     sparse_vector operator/(const sparse_vector &U, const double m) {
-        sparse_vector V = U;
-        for (auto &entry : V) {
-            V(entry.first) = entry.second / m;
+        sparse_vector V(U.size(), U.isColumn());
+        for (auto const &entry : U) {
+            V.Append(entry.first, entry.second / m);
         }
         return V;
     }
@@ -116,12 +211,11 @@ namespace algebra_lib {
     }
 
     sparse_matrix operator*(const sparse_matrix &A, const double &b) {
-        sparse_matrix B = A;
+        // Scaling every entry, so build the rows anew instead of copying A and overwriting them.
+        sparse_matrix B(A.rows(), A.columns());
 
-        for (auto &&row : B) {
-            for (auto element : row.second) {
-                element.second *= b;
-            }
+        for (auto &&row : A) {
+            B.AppendRow(row.first, row.second * b);
         }
 
         return B;
@@ -168,14 +262,13 @@ namespace algebra_lib {
     sparse_vector ElementWiseMultiplication(const sparse_vector &U, const sparse_vector &V) {
         if (U.size() != V.size()) throw std::length_error("Vectors are not the same dimension");
 
-        sparse_vector P = U;
-
-        for (auto &&element : P) {
-            P(element.first) *= V[element.first];
-            if (P[element.first] == 0)
-                P.eraseEntry(element.first);
-        }
-
+        // Only indices stored in both vectors can be non-zero.
+        sparse_vector P(U.size(), U.isColumn());
+        IntersectSorted(U, V, [&P](unsigned int index, double u, double v) {
+            double product = u * v;
+            if (product != 0)
+                P.Append(index, product);
+        });
         return P;
     }
 
@@ -278,7 +371,7 @@ namespace algebra_lib {
 
         outfile << M.rows() << " " << M.columns() << std::endl;
         for (int row = 0; row < M.rows(); row++) {
-            for (int column = 0; row < M.columns(); column++) {
+            for (int column = 0; column < M.columns(); column++) {
                 outfile << M[row][column] << " ";
             }
             outfile << std::endl;
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include "parallel.hpp"
+#include "sparse_builder.hpp"
+
+namespace algebra_lib {
+    namespace {
+        // Bits needed to represent every value below count.
+        unsigned int BitsFor(unsigned int count) {
+            unsigned int bits = 0;
+            while (bits < 32 and (static_cast<unsigned long long>(1) << bits) < count) {
+                ++bits;
+            }
+            return bits;
+        }
+
+        const unsigned int radixBits = 11;
+        const unsigned int radixBuckets = 1u << radixBits;
+    }
+
+    sparse_matrix_builder::sparse_matrix_builder(unsigned int rows, unsigned int columns, unsigned int slots) {
+        _rows = rows;
+        _columns = columns;
+        _columnBits = BitsFor(columns);
+        _slots.resize(slots == 0 ? 1 : slots);
+    }
+
+    std::size_t sparse_matrix_builder::size() const {
+        std::size_t triplets = 0;
+        for (auto const &slot : _slots) {
+            triplets += slot.size();
+        }
+        return triplets;
+    }
+
+    void sparse_matrix_builder::Reserve(std::size_t triplets, unsigned int slot) {
+        _slots.at(slot).reserve(triplets);
+    }
+
+    void sparse_matrix_builder::Clear() {
+        for (auto &slot : _slots) {
+            slot.clear();
+        }
+    }
+
+    sparse_matrix sparse_matrix_builder::Build(bool dropZeros) const {
+        const std::size_t triplets = size();
+        sparse_matrix Built(_rows, _columns);
+        if (triplets == 0)
+            return Built;
+
+        // Gather all slots into one array.
+        std::vector<triplet> keys(triplets);
+        std::vector<std::size_t> slotOffsets(_slots.size() + 1, 0);
+        for (std::size_t slot = 0; slot < _slots.size(); ++slot) {
+            slotOffsets[slot + 1] = slotOffsets[slot] + _slots[slot].size();
+        }
+        ParallelFor(0, _slots.size(), [&](unsigned long first, unsigned long last) {
+            for (unsigned long slot = first; slot < last; ++slot) {
+                std::copy(_slots[slot].begin(), _slots[slot].end(), keys.begin() + slotOffsets[slot]);
+            }
+        });
+
+        // Parallel LSD radix sort on (row, column). Every part histograms its own range of the
+        // array, so the scatter of a pass is stable and needs no synchronisation.
+        const unsigned int keyBits = BitsFor(_rows) + _columnBits;
+        const unsigned int parts = std::max<unsigned int>(1, std::min<std::size_t>(ParallelThreads(),
+                                                                                   triplets / 65536 + 1));
+        std::vector<std::size_t> partBegin(parts + 1);
+        for (unsigned int part = 0; part <= parts; ++part) {
+            partBegin[part] = triplets * part / parts;
+        }
+
+        std::vector<triplet> buffer(triplets);
+        std::vector<std::vector<std::size_t>> histograms(parts, std::vector<std::size_t>(radixBuckets));
+
+        for (unsigned int shift = 0; shift < keyBits; shift += radixBits) {
+            ParallelFor(0, parts, [&](unsigned long first, unsigned long last) {
+                for (unsigned long part = first; part < last; ++part) {
+                    std::vector<std::size_t> &histogram = histograms[part];
+                    std::fill(histogram.begin(), histogram.end(), 0);
+                    for (std::size_t item = partBegin[part]; item < partBegin[part + 1]; ++item) {
+                        ++histogram[(keys[item].key >> shift) & (radixBuckets - 1)];
+                    }
+                }
+            });
+
+            // Turn counts into scatter offsets, digit major, part minor. Skip passes with a single digit.
+            std::size_t offset = 0;
+            bool singleDigit = false;
+            for (unsigned int digit = 0; digit < radixBuckets; ++digit) {
+                std::size_t digitCount = 0;
+                for (unsigned int part = 0; part < parts; ++part) {
+                    std::size_t count = histograms[part][digit];
+                    histograms[part][digit] = offset;
+                    offset += count;
+                    digitCount += count;
+                }
+                if (digitCount == triplets) singleDigit = true;
+            }
+            if (singleDigit)
+                continue;
+
+            ParallelFor(0, parts, [&](unsigned long first, unsigned long last) {
+                for (unsigned long part = first; part < last; ++part) {
+                    std::vector<std::size_t> &offsets = histograms[part];
+                    for (std::size_t item = partBegin[part]; item < partBegin[part + 1]; ++item) {
+                        buffer[offsets[(keys[item].key >> shift) & (radixBuckets - 1)]++] = keys[item];
+                    }
+                }
+            });
+            keys.swap(buffer);
+        }
+
+        // Split the sorted array on row boundaries, and assemble the rows of every part in parallel.
+        const unsigned long long columnMask = (static_cast<unsigned long long>(1) << _columnBits) - 1;
+        for (unsigned int part = 1; part < parts; ++part) {
+            std::size_t item = std::max(partBegin[part], partBegin[part - 1]);
+            while (item > partBegin[part - 1] and item < triplets and
+                   (keys[item].key >> _columnBits) == (keys[item - 1].key >> _columnBits)) {
+                ++item;
+            }
+            partBegin[part] = item;
+        }
+
+        std::vector<std::vector<std::pair<unsigned int, sparse_vector>>> assembled(parts);
+        ParallelFor(0, parts, [&](unsigned long first, unsigned long last) {
+            for (unsigned long part = first; part < last; ++part) {
+                std::size_t item = partBegin[part];
+                while (item < partBegin[part + 1]) {
+                    unsigned int row = static_cast<unsigned int>(keys[item].key >> _columnBits);
+                    sparse_vector Row(_columns, false);
+                    while (item < partBegin[part + 1] and (keys[item].key >> _columnBits) == row) {
+                        unsigned long long key = keys[item].key;
+                        double sum = 0.0;
+                        for (; item < partBegin[part + 1] and keys[item].key == key; ++item) {
+                            sum += keys[item].value;
+                        }
+                        if (!(dropZeros and sum == 0.0))
+                            Row.Append(static_cast<unsigned int>(key & columnMask), sum);
+                    }
+                    if (Row.nonZeros() > 0)
+                        assembled[part].emplace_back(row, std::move(Row));
+                }
+            }
+        });
+
+        for (auto &part : assembled) {
+            for (auto &row : part) {
+                Built.AppendRow(row.first, std::move(row.second));
+            }
+        }
+        return Built;
+    }
+}
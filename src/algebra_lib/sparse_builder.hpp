@@ -0,0 +1,85 @@
+/*! \file sparse_builder.hpp
+ * \brief Bulk construction of sparse matrices from (row, column, value) triplets.
+ *
+ * Filling a sparse_matrix through operator()(i)(j) costs two lookups and a node
+ * allocation per entry, in random order. sparse_matrix_builder instead collects
+ * triplets in any order (from several threads if needed), radix sorts them, sums
+ * duplicates and emits every row in a single in-order pass.
+ */
+
+#ifndef LINEARALGEBRA_SPARSEBUILDER_HPP
+#define LINEARALGEBRA_SPARSEBUILDER_HPP
+
+#include <stdexcept>
+#include "globals.hpp"
+#include "sparse_matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Collects triplets and assembles them into a sparse_matrix.
+     *
+     * Triplets are added to one of a fixed number of slots. Different slots may be filled
+     * concurrently from different threads; a single slot is not thread safe.
+     */
+    class sparse_matrix_builder {
+    public:
+        /*!
+         * @param rows Rows of the matrix to build.
+         * @param columns Columns of the matrix to build.
+         * @param slots Number of independently fillable triplet buffers, usually one per thread.
+         */
+        sparse_matrix_builder(unsigned int rows, unsigned int columns, unsigned int slots = 1);
+
+        unsigned int rows() const { return _rows; }
+
+        unsigned int columns() const { return _columns; }
+
+        unsigned int slots() const { return static_cast<unsigned int>(_slots.size()); }
+
+        /*!
+         * \brief Number of triplets collected so far, duplicates included.
+         */
+        std::size_t size() const;
+
+        /*!
+         * \brief Reserve room for a number of triplets in a slot.
+         */
+        void Reserve(std::size_t triplets, unsigned int slot = 0);
+
+        /*!
+         * \brief Add value to entry (row, column). Triplets for the same entry are summed.
+         * @throw std::out_of_range Entry outside matrix, or slot doesn't exist.
+         */
+        void Add(unsigned int row, unsigned int column, double value, unsigned int slot = 0) {
+            if (row >= _rows or column >= _columns) {
+                throw std::out_of_range("Exceeded matrix bounds");
+            }
+            _slots.at(slot).push_back(triplet{(static_cast<unsigned long long>(row) << _columnBits) | column, value});
+        }
+
+        /*!
+         * \brief Sort, sum duplicates and assemble the matrix. The builder keeps its triplets.
+         * @param dropZeros Don't store entries which sum to exactly zero.
+         * @return \f$ rows \times columns \f$ sparse matrix
+         */
+        sparse_matrix Build(bool dropZeros = true) const;
+
+        /*!
+         * \brief Remove all triplets, keeping the allocated buffers.
+         */
+        void Clear();
+
+    private:
+        struct triplet {
+            unsigned long long key;
+            double value;
+        };
+
+        unsigned int _rows;
+        unsigned int _columns;
+        unsigned int _columnBits;
+        std::vector<std::vector<triplet>> _slots;
+    };
+}
+
+#endif //LINEARALGEBRA_SPARSEBUILDER_HPP
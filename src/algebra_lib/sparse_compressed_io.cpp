@@ -0,0 +1,222 @@
+#include "parallel.hpp"
+#include "sparse_compressed_io.hpp"
+
+namespace algebra_lib {
+    namespace {
+        const char compressedMagic[4] = {'A', 'L', 'S', 'C'};
+        const unsigned int compressedVersion = 1;
+        const unsigned int flagCompressedValues = 1;
+        // magic, version, flags, rows, columns, rowsPerBlock, blocks
+        const unsigned long long headerBytes = 4 + 6 * 4;
+
+        void PutFixed(std::vector<unsigned char> &buffer, unsigned long long value, unsigned int bytes) {
+            for (unsigned int byte = 0; byte < bytes; ++byte) {
+                buffer.push_back(static_cast<unsigned char>(value >> (8 * byte)));
+            }
+        }
+
+        unsigned long long GetFixed(const unsigned char *buffer, unsigned int bytes) {
+            unsigned long long value = 0;
+            for (unsigned int byte = 0; byte < bytes; ++byte) {
+                value |= static_cast<unsigned long long>(buffer[byte]) << (8 * byte);
+            }
+            return value;
+        }
+
+        void PutVarint(std::vector<unsigned char> &buffer, unsigned long long value) {
+            while (value >= 0x80u) {
+                buffer.push_back(static_cast<unsigned char>(value | 0x80u));
+                value >>= 7;
+            }
+            buffer.push_back(static_cast<unsigned char>(value));
+        }
+
+        void PutCompressedValue(std::vector<unsigned char> &buffer, double value, unsigned long long &previousBits) {
+            unsigned long long bits;
+            std::memcpy(&bits, &value, sizeof(double));
+            unsigned long long difference = bits ^ previousBits;
+            previousBits = bits;
+
+            unsigned int leading = 0;
+            while (leading < 8 and ((difference >> (8 * (7 - leading))) & 0xffu) == 0) {
+                ++leading;
+            }
+            unsigned int trailing = 0;
+            while (leading + trailing < 8 and ((difference >> (8 * trailing)) & 0xffu) == 0) {
+                ++trailing;
+            }
+
+            buffer.push_back(static_cast<unsigned char>((leading << 4) | trailing));
+            for (unsigned int byte = trailing; byte < 8 - leading; ++byte) {
+                buffer.push_back(static_cast<unsigned char>(difference >> (8 * byte)));
+            }
+        }
+
+        void EncodeRow(std::vector<unsigned char> &buffer, const sparse_vector &Row, bool compressValues) {
+            PutVarint(buffer, Row.nonZeros());
+
+            bool first = true;
+            unsigned int previousColumn = 0;
+            for (auto const &entry : Row) {
+                PutVarint(buffer, first ? entry.first : entry.first - previousColumn - 1);
+                previousColumn = entry.first;
+                first = false;
+            }
+
+            unsigned long long previousBits = 0;
+            for (auto const &entry : Row) {
+                if (compressValues) {
+                    PutCompressedValue(buffer, entry.second, previousBits);
+                } else {
+                    unsigned long long bits;
+                    std::memcpy(&bits, &entry.second, sizeof(double));
+                    PutFixed(buffer, bits, 8);
+                }
+            }
+        }
+    }
+
+    void WriteCompressedMatrix(const sparse_matrix &M, const char *filename, bool compressValues,
+                               unsigned int rowsPerBlock) {
+        if (rowsPerBlock == 0) {
+            throw std::invalid_argument("Compressed matrix: rows per block must be positive.");
+        }
+
+        unsigned int blocks = (M.rows() + rowsPerBlock - 1) / rowsPerBlock;
+
+        // Gather the stored rows of every block, so blocks can be encoded independently.
+        std::vector<std::vector<const std::pair<const unsigned int, sparse_vector> *>> blockRows(blocks);
+        for (auto const &row : M) {
+            blockRows[row.first / rowsPerBlock].push_back(&row);
+        }
+
+        std::vector<std::vector<unsigned char>> encoded(blocks);
+        ParallelFor(0, blocks, [&](unsigned long first, unsigned long last) {
+            for (unsigned long block = first; block < last; ++block) {
+                std::vector<unsigned char> &buffer = encoded[block];
+                auto stored = blockRows[block].begin();
+                unsigned long long endRow = std::min<unsigned long long>((block + 1) * rowsPerBlock, M.rows());
+                for (unsigned long long row = block * rowsPerBlock; row < endRow; ++row) {
+                    if (stored != blockRows[block].end() and (*stored)->first == row) {
+                        EncodeRow(buffer, (*stored)->second, compressValues);
+                        ++stored;
+                    } else {
+                        PutVarint(buffer, 0);
+                    }
+                }
+            }
+        });
+
+        std::vector<unsigned char> header;
+        header.insert(header.end(), compressedMagic, compressedMagic + 4);
+        PutFixed(header, compressedVersion, 4);
+        PutFixed(header, compressValues ? flagCompressedValues : 0, 4);
+        PutFixed(header, M.rows(), 4);
+        PutFixed(header, M.columns(), 4);
+        PutFixed(header, rowsPerBlock, 4);
+        PutFixed(header, blocks, 4);
+
+        unsigned long long offset = headerBytes + 8ull * (blocks + 1);
+        for (unsigned int block = 0; block <= blocks; ++block) {
+            PutFixed(header, offset, 8);
+            if (block < blocks)
+                offset += encoded[block].size();
+        }
+
+        std::ofstream outfile(filename, std::ios::binary);
+        if (!outfile.is_open()) {
+            throw std::invalid_argument(
+                    std::string("File ") + std::string(filename) + std::string(" can't be opened for writing!"));
+        }
+        outfile.write(reinterpret_cast<const char *>(header.data()), header.size());
+        for (auto const &buffer : encoded) {
+            outfile.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+        }
+        outfile.close();
+    }
+
+    compressed_matrix_header ReadCompressedHeader(std::istream &infile, const char *filename) {
+        unsigned char fixed[headerBytes];
+        infile.read(reinterpret_cast<char *>(fixed), headerBytes);
+        if (!infile or std::memcmp(fixed, compressedMagic, 4) != 0) {
+            throw std::invalid_argument(
+                    std::string("File ") + std::string(filename) + std::string(" is not a compressed sparse matrix!"));
+        }
+        if (GetFixed(fixed + 4, 4) != compressedVersion) {
+            throw std::invalid_argument(
+                    std::string("File ") + std::string(filename) + std::string(" has an unsupported version!"));
+        }
+
+        compressed_matrix_header header;
+        header.compressedValues = (GetFixed(fixed + 8, 4) & flagCompressedValues) != 0;
+        header.rows = static_cast<unsigned int>(GetFixed(fixed + 12, 4));
+        header.columns = static_cast<unsigned int>(GetFixed(fixed + 16, 4));
+        header.rowsPerBlock = static_cast<unsigned int>(GetFixed(fixed + 20, 4));
+        header.blocks = static_cast<unsigned int>(GetFixed(fixed + 24, 4));
+
+        if (header.rowsPerBlock == 0 or
+            header.blocks != (static_cast<unsigned long long>(header.rows) + header.rowsPerBlock - 1) /
+                             header.rowsPerBlock) {
+            throw std::invalid_argument(
+                    std::string("File ") + std::string(filename) + std::string(" has a corrupt header!"));
+        }
+
+        std::vector<unsigned char> table(8ull * (header.blocks + 1));
+        infile.read(reinterpret_cast<char *>(table.data()), table.size());
+        if (!infile) {
+            throw std::invalid_argument(
+                    std::string("File ") + std::string(filename) + std::string(" has a truncated block table!"));
+        }
+        header.blockOffsets.resize(header.blocks + 1);
+        for (unsigned int block = 0; block <= header.blocks; ++block) {
+            header.blockOffsets[block] = GetFixed(table.data() + 8 * block, 8);
+            if (block > 0 and header.blockOffsets[block] < header.blockOffsets[block - 1]) {
+                throw std::invalid_argument(
+                        std::string("File ") + std::string(filename) + std::string(" has a corrupt block table!"));
+            }
+        }
+        return header;
+    }
+
+    sparse_matrix ReadCompressedSparseMatrix(const char *filename) {
+        std::ifstream infile(filename, std::ios::binary);
+
+        if (!infile.is_open()) {
+            throw std::invalid_argument(
+                    std::string("File ") + std::string(filename) + std::string(" doesn't exist! Terminating..."));
+        }
+
+        const compressed_matrix_header header = ReadCompressedHeader(infile, filename);
+        infile.close();
+
+        std::vector<sparse_vector> rows(header.rows, sparse_vector(header.columns, false));
+
+        // Every chunk of blocks is read through its own stream, and decoded into its own rows.
+        ParallelFor(0, header.blocks, [&](unsigned long first, unsigned long last) {
+            std::ifstream chunkFile(filename, std::ios::binary);
+            unsigned long long begin = header.blockOffsets[first];
+            std::vector<char> data(header.blockOffsets[last] - begin);
+            chunkFile.seekg(begin);
+            chunkFile.read(data.data(), data.size());
+            if (!chunkFile) {
+                throw std::invalid_argument(
+                        std::string("File ") + std::string(filename) + std::string(" is truncated!"));
+            }
+
+            for (unsigned long block = first; block < last; ++block) {
+                DecodeCompressedBlock(header, block, data.data() + (header.blockOffsets[block] - begin),
+                                      header.blockOffsets[block + 1] - header.blockOffsets[block],
+                                      [&rows](unsigned int row, unsigned int column, double value) {
+                                          rows[row](column) = value;
+                                      });
+            }
+        });
+
+        sparse_matrix ReadMatrix(header.rows, header.columns);
+        for (unsigned int row = 0; row < header.rows; ++row) {
+            if (rows[row].nonZeros() > 0)
+                ReadMatrix(row) = std::move(rows[row]);
+        }
+        return ReadMatrix;
+    }
+}
@@ -0,0 +1,166 @@
+/*! \file sparse_compressed_io.hpp
+ * \brief Compact binary storage for sparse matrices.
+ *
+ * ReadSparseMatrix and WriteMatrix store every entry as text, zeros included. The
+ * format here only stores non-zero entries, grouped in blocks of rows:
+ *
+ * - a header with the magic "ALSC", version, flags, dimensions and rows per block,
+ * - a table of byte offsets, one per block plus the end of the last block,
+ * - the blocks. Every row in a block stores its number of entries and the gaps between
+ *   successive column indices as LEB128 varints, followed by its values.
+ *
+ * Values are stored as raw little endian doubles, or, when compression is requested,
+ * XOR'ed with the previous value of the row and stripped of leading and trailing zero
+ * bytes. Banded and block structured matrices typically store their indices in one byte
+ * per entry. Since every block can be located through the offset table, blocks are
+ * decoded in parallel, and can be streamed one at a time.
+ */
+
+#ifndef LINEARALGEBRA_SPARSECOMPRESSEDIO_HPP
+#define LINEARALGEBRA_SPARSECOMPRESSEDIO_HPP
+
+#include <cstring>
+#include <stdexcept>
+#include "globals.hpp"
+#include "sparse_matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Header of a compressed sparse matrix file.
+     */
+    struct compressed_matrix_header {
+        unsigned int rows;
+        unsigned int columns;
+        unsigned int rowsPerBlock;
+        unsigned int blocks;
+        bool compressedValues;
+        /*!
+         * \brief Byte offset of every block in the file, plus the end of the last block.
+         */
+        std::vector<unsigned long long> blockOffsets;
+
+        unsigned int BlockFirstRow(unsigned int block) const { return block * rowsPerBlock; }
+
+        unsigned int BlockEndRow(unsigned int block) const {
+            unsigned long long end = static_cast<unsigned long long>(block + 1) * rowsPerBlock;
+            return end > rows ? rows : static_cast<unsigned int>(end);
+        }
+    };
+
+    /**
+     * \brief Write matrix in the compressed binary format.
+     * @param M sparse matrix
+     * @param filename output file
+     * @param compressValues XOR compress the values of every row.
+     * @param rowsPerBlock Number of rows in every independently decodable block.
+     * @throw std::invalid_argument File can't be opened.
+     */
+    void WriteCompressedMatrix(const sparse_matrix &M, const char *filename, bool compressValues = false,
+                               unsigned int rowsPerBlock = 4096);
+
+    /**
+     * \brief Read a matrix written by WriteCompressedMatrix, decoding blocks in parallel.
+     * @param filename input file
+     * @return sparse matrix
+     * @throw std::invalid_argument File doesn't exist or is not a compressed sparse matrix.
+     */
+    sparse_matrix ReadCompressedSparseMatrix(const char *filename);
+
+    /**
+     * \brief Read header and block offset table of a compressed matrix file.
+     * @param infile Stream positioned at the start of the file.
+     * @param filename Name of the file, used in error messages.
+     * @throw std::invalid_argument Stream doesn't contain a compressed sparse matrix.
+     */
+    compressed_matrix_header ReadCompressedHeader(std::istream &infile, const char *filename);
+
+    /*!
+     * \brief Decode a LEB128 varint, advancing position.
+     * @throw std::invalid_argument Varint runs past end.
+     */
+    inline unsigned long long DecodeVarint(const unsigned char *&position, const unsigned char *end) {
+        unsigned long long value = 0;
+        unsigned int shift = 0;
+        while (position < end and shift < 64) {
+            unsigned char byte = *position++;
+            value |= static_cast<unsigned long long>(byte & 0x7fu) << shift;
+            if ((byte & 0x80u) == 0)
+                return value;
+            shift += 7;
+        }
+        throw std::invalid_argument("Compressed matrix: truncated or corrupt block.");
+    }
+
+    /*!
+     * \brief Decode one value, advancing position.
+     * @param previousBits Bits of the previous value in the row, updated. Only used for compressed values.
+     */
+    inline double DecodeCompressedValue(const unsigned char *&position, const unsigned char *end, bool compressed,
+                                        unsigned long long &previousBits) {
+        unsigned long long bits = 0;
+        if (!compressed) {
+            if (end - position < 8)
+                throw std::invalid_argument("Compressed matrix: truncated or corrupt block.");
+            for (unsigned int byte = 0; byte < 8; ++byte) {
+                bits |= static_cast<unsigned long long>(position[byte]) << (8 * byte);
+            }
+            position += 8;
+        } else {
+            if (position >= end)
+                throw std::invalid_argument("Compressed matrix: truncated or corrupt block.");
+            unsigned int leading = *position >> 4;
+            unsigned int trailing = *position & 0x0fu;
+            ++position;
+            if (leading + trailing > 8 or end - position < 8 - leading - trailing)
+                throw std::invalid_argument("Compressed matrix: truncated or corrupt block.");
+            unsigned long long difference = 0;
+            for (unsigned int byte = trailing; byte < 8 - leading; ++byte) {
+                difference |= static_cast<unsigned long long>(*position++) << (8 * byte);
+            }
+            bits = previousBits ^ difference;
+            previousBits = bits;
+        }
+        double value;
+        std::memcpy(&value, &bits, sizeof(double));
+        return value;
+    }
+
+    /*!
+     * \brief Decode one block, calling visit(row, column, value) for every stored entry.
+     * @param header Header of the file the block was read from.
+     * @param block Index of the block.
+     * @param data Bytes of the block, from blockOffsets[block] up to blockOffsets[block + 1].
+     * @param length Number of bytes in data.
+     * @param visit Called in row major order.
+     * @throw std::invalid_argument Block is corrupt.
+     */
+    template<typename Visitor>
+    void DecodeCompressedBlock(const compressed_matrix_header &header, unsigned int block, const char *data,
+                               unsigned long long length, Visitor visit) {
+        const unsigned char *position = reinterpret_cast<const unsigned char *>(data);
+        const unsigned char *end = position + length;
+
+        for (unsigned int row = header.BlockFirstRow(block); row < header.BlockEndRow(block); ++row) {
+            unsigned long long entries = DecodeVarint(position, end);
+            unsigned long long column = 0;
+            unsigned long long previousBits = 0;
+            const unsigned char *indices = position;
+            // Skip ahead over the indices, values are stored after them.
+            for (unsigned long long entry = 0; entry < entries; ++entry) {
+                DecodeVarint(position, end);
+            }
+            for (unsigned long long entry = 0; entry < entries; ++entry) {
+                unsigned long long gap = DecodeVarint(indices, end);
+                column = entry == 0 ? gap : column + gap + 1;
+                if (column >= header.columns)
+                    throw std::invalid_argument("Compressed matrix: column index exceeds matrix dimension.");
+                visit(row, static_cast<unsigned int>(column),
+                      DecodeCompressedValue(position, end, header.compressedValues, previousBits));
+            }
+        }
+        if (position != end)
+            throw std::invalid_argument("Compressed matrix: truncated or corrupt block.");
+    }
+}
+
+#endif //LINEARALGEBRA_SPARSECOMPRESSEDIO_HPP
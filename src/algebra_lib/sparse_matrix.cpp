@@ -2,18 +2,23 @@
 // Created by Lars Gebraad on 14-8-17.
 //
 
+#include <algorithm>
 #include <iostream>
 #include <cmath>
+#include "parallel.hpp"
 #include "sparse_matrix.hpp"
+#include "mixed_algebra.hpp"
+#include "triangular_solve.hpp"
 
 namespace algebra_lib {
 
-    sparse_matrix::sparse_matrix() {
+    sparse_matrix::sparse_matrix() : _matrixMap(std::make_shared<sparseContentMatrixDouble>()) {
         _rows = 2;
         _columns = 2;
     }
 
-    sparse_matrix::sparse_matrix(unsigned int rows, unsigned int columns) {
+    sparse_matrix::sparse_matrix(unsigned int rows, unsigned int columns)
+            : _matrixMap(std::make_shared<sparseContentMatrixDouble>()) {
         _rows = rows;
         _columns = columns;
     }
@@ -31,7 +36,7 @@ namespace algebra_lib {
         }
 
         try {
-            return _matrixMap.at(i);
+            return _matrixMap->at(i);
         } catch (std::out_of_range &e) {
             return sparse_vector(columns(), false);
         }
@@ -45,10 +50,12 @@ namespace algebra_lib {
         }
 
         // Row doesn't exist, accessing for assignment, so create the row.
-        if (_matrixMap.find(i) == _matrixMap.end())
-            _matrixMap[i] = sparse_vector(columns(), false);
+        sparseContentMatrixDouble &rowMap = MutableRows();
+        auto lookup = rowMap.lower_bound(i);
+        if (lookup == rowMap.end() or lookup->first != i)
+            lookup = rowMap.emplace_hint(lookup, i, sparse_vector(columns(), false));
 
-        return _matrixMap[i];
+        return lookup->second;
     }
 
     const sparse_vector sparse_matrix::operator()(unsigned int i) const {
@@ -65,7 +72,7 @@ namespace algebra_lib {
 
     const sparse_vector sparse_matrix::GetSparseColumn(unsigned int column) const {
         sparse_vector P(rows(), true);
-        for (auto &row : _matrixMap) {
+        for (auto &row : *_matrixMap) {
             try {
                 double entry = row.second[column];
                 if (entry != 0)
@@ -89,42 +96,123 @@ namespace algebra_lib {
     }
 
     sparse_matrix sparse_matrix::Transpose() {
-        sparse_matrix T(columns(), rows());
-
-        for (auto row: _matrixMap) {
-            for (auto column: row.second) {
-                if (column.second != 0)
-                    T(column.first)(row.first) = column.second;
-            }
-        }
-
-        return T;
+        return static_cast<const sparse_matrix *>(this)->Transpose();
     }
 
     const sparse_matrix sparse_matrix::Transpose() const {
-        sparse_matrix T(columns(), rows());
+        std::vector<std::pair<unsigned int, const sparse_vector *>> storedRows;
+        storedRows.reserve(_matrixMap->size());
+        unsigned long storedEntries = 0;
+        for (auto const &row : *_matrixMap) {
+            storedRows.emplace_back(row.first, &row.second);
+            storedEntries += row.second.nonZeros();
+        }
 
-        for (auto row: _matrixMap) {
-            for (auto column: row.second) {
-                if (column.second != 0)
-                    T(column.first)(row.first) = column.second;
+        // The counts take memory and time in the number of columns. With far fewer entries
+        // than columns, sorting (column, row) pairs only costs in the number of entries.
+        if (storedEntries < columns() / 8) {
+            std::vector<std::pair<std::pair<unsigned int, unsigned int>, double>> entries;
+            entries.reserve(storedEntries);
+            for (auto const &row : storedRows) {
+                for (auto const &entry : *row.second) {
+                    if (entry.second != 0) entries.emplace_back(std::make_pair(entry.first, row.first), entry.second);
+                }
             }
+            std::sort(entries.begin(), entries.end(),
+                      [](const std::pair<std::pair<unsigned int, unsigned int>, double> &a,
+                         const std::pair<std::pair<unsigned int, unsigned int>, double> &b) {
+                          return a.first < b.first;
+                      });
+
+            sparse_matrix T(columns(), rows());
+            for (std::size_t begin = 0, end = 0; begin < entries.size(); begin = end) {
+                while (end < entries.size() and entries[end].first.first == entries[begin].first.first) ++end;
+                sparse_vector Row(rows(), false);
+                Row.Reserve(static_cast<unsigned int>(end - begin));
+                for (std::size_t position = begin; position < end; ++position) {
+                    Row.Append(entries[position].first.second, entries[position].second);
+                }
+                T.AppendRow(entries[begin].first.first, std::move(Row));
+            }
+            return T;
         }
 
+        // Counting sort of the entries by column, in three parallel passes over parts of
+        // the rows: count the entries per column, scatter them to their offsets, and
+        // assemble the rows of the transpose. Parts keep their rows in order, so every
+        // column comes out sorted without any comparisons.
+        unsigned long parts = std::max(1ul, std::min(static_cast<unsigned long>(ParallelThreads()),
+                                                     static_cast<unsigned long>(storedRows.size())));
+        std::vector<std::vector<unsigned long>> offsets(parts);
+        ParallelFor(0, parts, [&](unsigned long first, unsigned long last) {
+            for (unsigned long part = first; part < last; ++part) {
+                offsets[part].assign(columns(), 0);
+                for (std::size_t row = storedRows.size() * part / parts;
+                     row < storedRows.size() * (part + 1) / parts; ++row) {
+                    for (auto const &entry : *storedRows[row].second) {
+                        if (entry.second != 0) ++offsets[part][entry.first];
+                    }
+                }
+            }
+        });
+
+        // Turn the counts into offsets, column major so that parts follow each other within a column.
+        std::vector<unsigned long> columnBegin(columns() + 1, 0);
+        unsigned long entries = 0;
+        for (unsigned int column = 0; column < columns(); ++column) {
+            columnBegin[column] = entries;
+            for (unsigned long part = 0; part < parts; ++part) {
+                unsigned long count = offsets[part][column];
+                offsets[part][column] = entries;
+                entries += count;
+            }
+        }
+        columnBegin[columns()] = entries;
+
+        std::vector<unsigned int> entryRows(entries);
+        std::vector<double> entryValues(entries);
+        ParallelFor(0, parts, [&](unsigned long first, unsigned long last) {
+            for (unsigned long part = first; part < last; ++part) {
+                std::vector<unsigned long> &offset = offsets[part];
+                for (std::size_t row = storedRows.size() * part / parts;
+                     row < storedRows.size() * (part + 1) / parts; ++row) {
+                    for (auto const &entry : *storedRows[row].second) {
+                        if (entry.second == 0) continue;
+                        unsigned long position = offset[entry.first]++;
+                        entryRows[position] = storedRows[row].first;
+                        entryValues[position] = entry.second;
+                    }
+                }
+            }
+        });
+
+        // Rows of the transpose are only built for the columns holding entries.
+        std::vector<unsigned int> filledColumns;
+        for (unsigned int column = 0; column < columns(); ++column) {
+            if (columnBegin[column] != columnBegin[column + 1]) filledColumns.push_back(column);
+        }
+        std::vector<sparse_vector> transposedRows(filledColumns.size());
+        ParallelFor(0, filledColumns.size(), [&](unsigned long first, unsigned long last) {
+            for (unsigned long filled = first; filled < last; ++filled) {
+                const unsigned int column = filledColumns[filled];
+                sparse_vector Row(rows(), false);
+                Row.Reserve(static_cast<unsigned int>(columnBegin[column + 1] - columnBegin[column]));
+                for (unsigned long position = columnBegin[column]; position < columnBegin[column + 1]; ++position) {
+                    Row.Append(entryRows[position], entryValues[position]);
+                }
+                transposedRows[filled] = std::move(Row);
+            }
+        }, 256);
+
+        sparse_matrix T(columns(), rows());
+        for (std::size_t filled = 0; filled < filledColumns.size(); ++filled) {
+            T.AppendRow(filledColumns[filled], std::move(transposedRows[filled]));
+        }
         return T;
     }
 
     sparse_matrix sparse_matrix::TransposeSelf() {
-        // Does not provide performance increase//less required memory over
-        // sparse_matrix = sparse_matrix::Transpose().
-        sparse_matrix T(columns(), rows());
-        for (auto row: _matrixMap) {
-            for (auto column: row.second) {
-                if (column.second != 0)
-                    T(column.first)(row.first) = column.second;
-            }
-        }
-        (*this) = T;
+        (*this) = Transpose();
         return (*this);
     }
 
@@ -143,47 +231,62 @@ namespace algebra_lib {
     }
 
     sparse_matrix sparse_matrix::SetSparseColumn(sparse_vector Vector, unsigned int column) {
+        // The copy shares all rows, only those written to below get their own storage.
         sparse_matrix VectorModified = (*this);
-        for (auto &&item : Vector) {
-            if (item.second != 0) {
-                VectorModified(item.first)(column) = item.second;
-            } else {
-                VectorModified(item.first).eraseEntry(column);
-            }
-        }
+        VectorModified.SetSparseColumnSelf(std::move(Vector), column);
         return VectorModified;
     }
 
+    sparse_vector &sparse_matrix::AppendRow(unsigned int row, sparse_vector Row) {
+        if (row >= rows()) {
+            throw std::out_of_range("Exceeded number of rows");
+        } else if (!_matrixMap->empty() and row <= _matrixMap->rbegin()->first) {
+            throw std::invalid_argument("Appending to sparse matrix: row is not past the last stored row.");
+        } else if (Row.size() != columns()) {
+            throw std::invalid_argument("Appending to sparse matrix: row and matrix are not compatible in dimension.");
+        }
+        if (Row.isColumn())
+            Row.TransposeSelf();
+        sparseContentMatrixDouble &rowMap = MutableRows();
+        return rowMap.emplace_hint(rowMap.end(), row, std::move(Row))->second;
+    }
+
+    sparseContentMatrixDouble &sparse_matrix::MutableRows() {
+        if (_matrixMap.use_count() > 1)
+            _matrixMap = std::make_shared<sparseContentMatrixDouble>(*_matrixMap);
+        return *_matrixMap;
+    }
+
     sparseContentMatrixDouble::const_iterator sparse_matrix::begin() const {
-        return _matrixMap.begin();
+        return _matrixMap->begin();
     }
 
     sparseContentMatrixDouble::const_iterator sparse_matrix::end() const {
-        return _matrixMap.end();
+        return _matrixMap->end();
     }
 
     sparseContentMatrixDouble::reverse_iterator sparse_matrix::rbegin() {
-        return _matrixMap.rbegin();
+        return MutableRows().rbegin();
     }
 
     sparseContentMatrixDouble::reverse_iterator sparse_matrix::rend() {
-        return _matrixMap.rend();
+        return MutableRows().rend();
     }
 
     sparseContentMatrixDouble::const_iterator sparse_matrix::cbegin() const noexcept {
-        return _matrixMap.cbegin();
+        return _matrixMap->cbegin();
     }
 
     sparseContentMatrixDouble::const_iterator sparse_matrix::cend() const noexcept {
-        return _matrixMap.cend();
+        return _matrixMap->cend();
     }
 
     sparseContentMatrixDouble::const_reverse_iterator sparse_matrix::crbegin() const noexcept {
-        return _matrixMap.crbegin();
+        return _matrixMap->crbegin();
     }
 
     sparseContentMatrixDouble::const_reverse_iterator sparse_matrix::crend() const noexcept {
-        return _matrixMap.crend();
+        return _matrixMap->crend();
     }
 
     sparse_matrix sparse_matrix::InvertLowerTriangular() {
@@ -196,12 +299,15 @@ namespace algebra_lib {
         }
 
         sparse_matrix Inverse(rows(), columns());
+        triangular_solve_plan Plan(*this);
+        vector X(rows(), true);
 
         for (unsigned int column = 0; column < Inverse.columns(); ++column) {
-            sparse_vector RHS(Inverse.rows(), true);
-            RHS(column) = 1.0;
+            vector RHS(Inverse.rows(), true);
+            RHS[column] = 1.0;
 
-            Inverse.SetSparseColumnSelf(SolveLowerTriangular(RHS), column);
+            Plan.Solve(RHS, X);
+            Inverse.SetSparseColumnSelf(ToSparse(X), column);
         }
         return Inverse;
     }
@@ -211,12 +317,19 @@ namespace algebra_lib {
     }
 
     sparse_matrix sparse_matrix::InvertMatrixElements(bool preserveZero) const {
-        sparse_matrix iM = (*this);
+        // Every entry changes, so build the rows anew instead of copying and overwriting them.
+        sparse_matrix iM(rows(), columns());
         for (auto &&row : (*this)) {
+            sparse_vector Row(columns(), false);
+            Row.Reserve(row.second.nonZeros());
             for (auto &&element : row.second) {
-                if (!(preserveZero and element.second == 0))
-                    iM(row.first)(element.first) = 1.0 / element.second;
+                if (preserveZero and element.second == 0) {
+                    Row.Append(element.first, 0.0);
+                } else {
+                    Row.Append(element.first, 1.0 / element.second);
+                }
             }
+            iM.AppendRow(row.first, std::move(Row));
         }
         return iM;
     }
@@ -291,26 +404,17 @@ namespace algebra_lib {
             throw std::length_error("Solving lower triangular matrix: matrix is not square.");
         }
 
-        sparse_vector X(columns(), true);
-
-        X(0) = (Y[0] / (*this)[0][0]);
-
-        for (unsigned int i = 1; i < X.size(); ++i) {
-            double sum = 0.0;
-
-            for (unsigned int j = 0; j < i; ++j) {
-                sum += (*this)[i][j] * X[j];
-            }
-
-            X(i) = (Y[i] - sum) / (*this)[i][i];
-        }
-        return X;
+        // Through a plan, so only stored entries are visited instead of every (i, j) below the diagonal.
+        return ToSparse(triangular_solve_plan(*this).Solve(ToFull(Y)));
     }
 
     sparse_matrix &sparse_matrix::Unit() {
-        for (auto it : (*this)){
-            it.second = sparse_vector(columns(), false);
-            it.second(it.first) = 1.0;
+        // Every row holds a single entry, which is stored inline in the row.
+        _matrixMap = std::make_shared<sparseContentMatrixDouble>();
+        for (unsigned int i = 0; i < rows() and i < columns(); ++i) {
+            sparse_vector Row(columns(), false);
+            Row.Append(i, 1.0);
+            AppendRow(i, std::move(Row));
         }
         return (*this);
     }
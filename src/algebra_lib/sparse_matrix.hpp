@@ -1,15 +1,24 @@
 #ifndef LINEARALGEBRA_sparse_matrix_H
 #define LINEARALGEBRA_sparse_matrix_H
 
+#include <memory>
 #include "globals.hpp"
 #include "sparse_vector.hpp"
 
 namespace algebra_lib {
+    // Type definitions
+    typedef std::map<unsigned int, sparse_vector, std::less<unsigned int>,
+            sparseAllocator<std::pair<const unsigned int, sparse_vector>>> sparseContentMatrixDouble;
+
     /*!
      * \brief Class for sparse matrices.
+     *
+     * Copies share their rows until modified, so copying costs \f$ O(1) \f$. The first
+     * modification of a copy duplicates the row map, which shares the entry storage of every
+     * row (see sparse_storage.hpp); only the rows that are then written to get copied.
+     * References obtained through operator() are not tracked, so don't hold on to them
+     * across a copy.
      */
-    // Type definitions
-    typedef std::map<unsigned int, sparse_vector> sparseContentMatrixDouble;
     class sparse_matrix {
     public:
         // todo Create non-zero column index in sparse_matrix to speed up the iterations here, possibly during reference access.
@@ -18,6 +27,11 @@ namespace algebra_lib {
         sparse_matrix();
         sparse_matrix(unsigned int rows, unsigned int columns);
 
+        // Copies are cheap, and no moves are declared so a moved from matrix stays valid.
+        sparse_matrix(const sparse_matrix &) = default;
+
+        sparse_matrix &operator=(const sparse_matrix &) = default;
+
         // Getters and setters using operators
         sparse_vector operator[](unsigned int i);
 
@@ -35,6 +49,16 @@ namespace algebra_lib {
 
         sparse_matrix SetSparseColumn(sparse_vector Vector, unsigned int column);
 
+        /*!
+         * \brief Store a row behind all stored rows, without searching.
+         * @param row Must exceed the largest stored row index.
+         * @param Row Row vector of matching dimension.
+         * @return Reference to the stored row.
+         * @throw std::out_of_range row exceeds the number of rows.
+         * @throw std::invalid_argument row doesn't exceed the largest stored row, or Row has the wrong dimension.
+         */
+        sparse_vector &AppendRow(unsigned int row, sparse_vector Row);
+
         sparseContentMatrixDouble::const_iterator begin() const;
 
         sparseContentMatrixDouble::const_iterator end() const;
@@ -80,7 +104,12 @@ namespace algebra_lib {
         friend std::ostream &operator<<(std::ostream &stream, const sparse_matrix &sparse_matrix);
 
     private:
-        sparseContentMatrixDouble _matrixMap;
+        /*!
+         * \brief Row map for modification, detached from copies sharing it.
+         */
+        sparseContentMatrixDouble &MutableRows();
+
+        std::shared_ptr<sparseContentMatrixDouble> _matrixMap;
         unsigned int _rows;
         unsigned int _columns;
 
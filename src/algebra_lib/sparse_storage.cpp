@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include "sparse_storage.hpp"
+
+namespace algebra_lib {
+    namespace {
+        /*
+         * A heap block is one allocation: the reference count, padded to a double, then the
+         * values, then the indices.
+         */
+        std::size_t BlockDoubles(unsigned int capacity) {
+            return 1 + capacity + (capacity + 1) / 2;
+        }
+    }
+
+    const unsigned int sparse_entry_storage::inlineEntries;
+
+    sparse_entry_storage::sparse_entry_storage(const sparse_entry_storage &other)
+            : _size(other._size), _capacity(other._capacity) {
+        if (other.isInline()) {
+            _inline = other._inline;
+        } else {
+            _heap = other._heap;
+            References().fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    sparse_entry_storage::sparse_entry_storage(sparse_entry_storage &&other) noexcept
+            : _size(0), _capacity(inlineEntries) {
+        swap(other);
+    }
+
+    sparse_entry_storage &sparse_entry_storage::operator=(const sparse_entry_storage &other) {
+        if (this != &other) {
+            sparse_entry_storage copy(other);
+            swap(copy);
+        }
+        return (*this);
+    }
+
+    sparse_entry_storage &sparse_entry_storage::operator=(sparse_entry_storage &&other) noexcept {
+        // The old entries go with the temporary, leaving other empty and inline.
+        if (this != &other) {
+            sparse_entry_storage(std::move(other)).swap(*this);
+        }
+        return (*this);
+    }
+
+    sparse_entry_storage::~sparse_entry_storage() {
+        Release();
+    }
+
+    void sparse_entry_storage::reserve(unsigned int entries) {
+        if (entries > _capacity) {
+            Grow(entries);
+        } else {
+            Detach();
+        }
+    }
+
+    void sparse_entry_storage::insert(unsigned int position, unsigned int index, double value) {
+        if (_size == _capacity) Grow(_size + 1);
+        unsigned int *storedIndices = indices();
+        double *storedValues = values();
+        std::copy_backward(storedIndices + position, storedIndices + _size, storedIndices + _size + 1);
+        std::copy_backward(storedValues + position, storedValues + _size, storedValues + _size + 1);
+        storedIndices[position] = index;
+        storedValues[position] = value;
+        ++_size;
+    }
+
+    void sparse_entry_storage::erase(unsigned int position) {
+        unsigned int *storedIndices = indices();
+        double *storedValues = values();
+        std::copy(storedIndices + position + 1, storedIndices + _size, storedIndices + position);
+        std::copy(storedValues + position + 1, storedValues + _size, storedValues + position);
+        --_size;
+    }
+
+    void sparse_entry_storage::swap(sparse_entry_storage &other) noexcept {
+        // Swapping the union as raw bytes is valid for both inline and heap entries.
+        std::swap(_size, other._size);
+        std::swap(_capacity, other._capacity);
+        const std::size_t bytes = sizeof(inline_entries) > sizeof(heap_entries) ? sizeof(inline_entries)
+                                                                                 : sizeof(heap_entries);
+        char entries[bytes];
+        std::memcpy(entries, &_inline, bytes);
+        std::memcpy(&_inline, &other._inline, bytes);
+        std::memcpy(&other._inline, entries, bytes);
+    }
+
+    void sparse_entry_storage::Grow(unsigned int entries) {
+        // Also used to detach a shared block, in which case the capacity is kept.
+        unsigned int capacity = isShared() and entries <= _capacity ? _capacity : std::max(entries, 2 * _capacity);
+        double *block = sparseAllocator<double>().allocate(BlockDoubles(capacity));
+        new(block) std::atomic<unsigned int>(1);
+        heap_entries grown;
+        grown.values = block + 1;
+        grown.indices = reinterpret_cast<unsigned int *>(block + 1 + capacity);
+        const sparse_entry_storage &current = (*this);
+        std::copy(current.indices(), current.indices() + _size, grown.indices);
+        std::copy(current.values(), current.values() + _size, grown.values);
+        Release();
+        _heap = grown;
+        _capacity = capacity;
+    }
+
+    void sparse_entry_storage::Release() {
+        if (!isInline()) {
+            if (References().fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                sparseAllocator<double>().deallocate(_heap.values - 1, BlockDoubles(_capacity));
+            }
+            _capacity = inlineEntries;
+        }
+    }
+}
@@ -0,0 +1,150 @@
+/*! \file sparse_storage.hpp
+ * \brief Entry storage of sparse_vector, keeping short vectors inline.
+ *
+ * Most rows of the sparse matrices we assemble have a handful of entries. Storing those
+ * inside the sparse_vector object itself makes building and copying such matrices free of
+ * heap allocations for the rows. Only when a vector outgrows the inline buffer are its
+ * entries moved to a heap block, which then grows by doubling.
+ *
+ * Heap blocks are shared between copies and reference counted. Copying a long vector, or a
+ * sparse_matrix full of them, only bumps reference counts; a copy gets its own block the
+ * first time it is modified. References and pointers obtained through the non-const
+ * accessors are not tracked, so don't hold on to them across a copy.
+ *
+ * The number of inline entries can be set at compile time through
+ * ALGEBRA_LIB_SPARSE_INLINE_ENTRIES.
+ */
+
+#ifndef LINEARALGEBRA_SPARSESTORAGE_HPP
+#define LINEARALGEBRA_SPARSESTORAGE_HPP
+
+#include <atomic>
+#include "globals.hpp"
+#include "pool_allocator.hpp"
+
+#ifndef ALGEBRA_LIB_SPARSE_INLINE_ENTRIES
+#define ALGEBRA_LIB_SPARSE_INLINE_ENTRIES 4
+#endif
+
+namespace algebra_lib {
+    /*!
+     * \brief Sorted (index, value) entries as two parallel arrays, inline up to a fixed count.
+     *
+     * Only manages memory; keeping the indices sorted is up to the owning sparse_vector.
+     */
+    class sparse_entry_storage {
+    public:
+        static const unsigned int inlineEntries = ALGEBRA_LIB_SPARSE_INLINE_ENTRIES;
+        static_assert(inlineEntries > 0, "ALGEBRA_LIB_SPARSE_INLINE_ENTRIES must be positive");
+
+        sparse_entry_storage() : _size(0), _capacity(inlineEntries) {}
+
+        sparse_entry_storage(const sparse_entry_storage &other);
+
+        sparse_entry_storage(sparse_entry_storage &&other) noexcept;
+
+        sparse_entry_storage &operator=(const sparse_entry_storage &other);
+
+        sparse_entry_storage &operator=(sparse_entry_storage &&other) noexcept;
+
+        ~sparse_entry_storage();
+
+        unsigned int size() const { return _size; }
+
+        bool empty() const { return _size == 0; }
+
+        unsigned int capacity() const { return _capacity; }
+
+        /*!
+         * \brief True if the entries are stored in the object itself.
+         */
+        bool isInline() const { return _capacity == inlineEntries; }
+
+        const unsigned int *indices() const { return isInline() ? _inline.indices : _heap.indices; }
+
+        unsigned int *indices() {
+            Detach();
+            return isInline() ? _inline.indices : _heap.indices;
+        }
+
+        const double *values() const { return isInline() ? _inline.values : _heap.values; }
+
+        double *values() {
+            Detach();
+            return isInline() ? _inline.values : _heap.values;
+        }
+
+        /*!
+         * \brief Make room for a number of entries, moving to the heap if they don't fit inline.
+         */
+        void reserve(unsigned int entries);
+
+        void push_back(unsigned int index, double value) {
+            if (_size == _capacity) Grow(_size + 1);
+            Detach();
+            indices()[_size] = index;
+            values()[_size] = value;
+            ++_size;
+        }
+
+        /*!
+         * \brief Insert an entry before the given position, shifting later entries up.
+         */
+        void insert(unsigned int position, unsigned int index, double value);
+
+        /*!
+         * \brief Remove the entry at the given position, shifting later entries down.
+         */
+        void erase(unsigned int position);
+
+        /*!
+         * \brief Remove all entries, keeping the capacity.
+         */
+        void clear() { _size = 0; }
+
+        /*!
+         * \brief True if the heap block is shared with another copy.
+         */
+        bool isShared() const { return !isInline() and References().load(std::memory_order_acquire) > 1; }
+
+        /*!
+         * \brief Give this copy its own heap block, if it shares one.
+         */
+        void Detach() {
+            if (isShared()) Grow(_capacity);
+        }
+
+        void swap(sparse_entry_storage &other) noexcept;
+
+    private:
+        void Grow(unsigned int entries);
+
+        void Release();
+
+        /*!
+         * \brief Reference count, stored in front of the values of a heap block.
+         */
+        std::atomic<unsigned int> &References() const {
+            return *reinterpret_cast<std::atomic<unsigned int> *>(_heap.values - 1);
+        }
+
+        struct inline_entries {
+            double values[inlineEntries];
+            unsigned int indices[inlineEntries];
+        };
+
+        struct heap_entries {
+            double *values;
+            unsigned int *indices;
+        };
+
+        unsigned int _size;
+        unsigned int _capacity;
+        union {
+            inline_entries _inline;
+            heap_entries _heap;
+        };
+    };
+}
+
+#endif //LINEARALGEBRA_SPARSESTORAGE_HPP
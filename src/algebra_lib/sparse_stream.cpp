@@ -0,0 +1,215 @@
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include "parallel.hpp"
+#include "sparse_stream.hpp"
+
+namespace algebra_lib {
+    sparse_matrix_stream::sparse_matrix_stream(const char *filename, unsigned int blocksInFlight) {
+        std::ifstream infile(filename, std::ios::binary);
+
+        if (!infile.is_open()) {
+            throw std::invalid_argument(
+                    std::string("File ") + std::string(filename) + std::string(" doesn't exist! Terminating..."));
+        }
+
+        _header = ReadCompressedHeader(infile, filename);
+        _filename = filename;
+        _blocksInFlight = blocksInFlight == 0 ? 1 : blocksInFlight;
+    }
+
+    void sparse_matrix_stream::Stream(
+            const std::function<void(unsigned int, const std::vector<char> &, unsigned int)> &process) const {
+        typedef std::pair<unsigned int, std::vector<char>> readBlock;
+
+        std::deque<readBlock> queue;
+        std::mutex queueMutex;
+        std::condition_variable queueCondition;
+        bool readerDone = false;
+        bool consumerDone = false;
+        std::exception_ptr readerFailure;
+
+        // Reader: runs ahead of the multiplication by at most _blocksInFlight blocks.
+        std::thread reader([&]() {
+            try {
+                std::ifstream infile(_filename.c_str(), std::ios::binary);
+                infile.seekg(_header.blockOffsets[0]);
+                for (unsigned int block = 0; block < _header.blocks; ++block) {
+                    std::vector<char> data(_header.blockOffsets[block + 1] - _header.blockOffsets[block]);
+                    infile.read(data.data(), data.size());
+                    if (!infile) {
+                        throw std::invalid_argument(
+                                std::string("File ") + _filename + std::string(" is truncated!"));
+                    }
+
+                    std::unique_lock<std::mutex> lock(queueMutex);
+                    queueCondition.wait(lock, [&] { return queue.size() < _blocksInFlight or consumerDone; });
+                    if (consumerDone) break;
+                    queue.push_back(readBlock(block, std::move(data)));
+                    queueCondition.notify_all();
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                readerFailure = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(queueMutex);
+            readerDone = true;
+            queueCondition.notify_all();
+        });
+
+        std::mutex slotMutex;
+        std::vector<unsigned int> freeSlots;
+        for (unsigned int slot = 0; slot < ParallelThreads(); ++slot) {
+            freeSlots.push_back(ParallelThreads() - 1 - slot);
+        }
+
+        try {
+            while (true) {
+                // Take whatever has arrived, and multiply it while the reader fetches the next blocks.
+                std::vector<readBlock> batch;
+                {
+                    std::unique_lock<std::mutex> lock(queueMutex);
+                    queueCondition.wait(lock, [&] { return !queue.empty() or readerDone; });
+                    if (readerFailure) std::rethrow_exception(readerFailure);
+                    if (queue.empty() and readerDone) break;
+                    while (!queue.empty()) {
+                        batch.push_back(std::move(queue.front()));
+                        queue.pop_front();
+                    }
+                    queueCondition.notify_all();
+                }
+
+                ParallelFor(0, batch.size(), [&](unsigned long first, unsigned long last) {
+                    unsigned int slot;
+                    {
+                        std::lock_guard<std::mutex> lock(slotMutex);
+                        slot = freeSlots.back();
+                        freeSlots.pop_back();
+                    }
+                    try {
+                        for (unsigned long item = first; item < last; ++item) {
+                            process(batch[item].first, batch[item].second, slot);
+                        }
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(slotMutex);
+                        freeSlots.push_back(slot);
+                        throw;
+                    }
+                    std::lock_guard<std::mutex> lock(slotMutex);
+                    freeSlots.push_back(slot);
+                });
+            }
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                consumerDone = true;
+                queueCondition.notify_all();
+            }
+            reader.join();
+            throw;
+        }
+        reader.join();
+    }
+
+    vector sparse_matrix_stream::Multiply(const vector &X) const {
+        if (X.size() != columns()) {
+            throw std::length_error(
+                    "Multiplication with streamed matrix: vector and matrix are not compatible in dimension");
+        } else if (!X.isColumn()) {
+            throw std::invalid_argument(
+                    "Multiplication with streamed matrix: vector is not a column vector! First transpose it for goodness' sake.");
+        }
+
+        const compressed_matrix_header &header = _header;
+        auto x = X.begin();
+        vector AX(rows(), true);
+        auto ax = AX.begin();
+
+        // Rows of a block belong to that block only, so every block writes its own part of A x.
+        Stream([&](unsigned int block, const std::vector<char> &data, unsigned int) {
+            DecodeCompressedBlock(header, block, data.data(), data.size(),
+                                  [&](unsigned int row, unsigned int column, double value) {
+                                      ax[row] += value * x[column];
+                                  });
+        });
+        return AX;
+    }
+
+    vector sparse_matrix_stream::MultiplyTransposed(const vector &Y) const {
+        if (Y.size() != rows()) {
+            throw std::length_error(
+                    "Transposed multiplication with streamed matrix: vector and matrix are not compatible in dimension");
+        } else if (!Y.isColumn()) {
+            throw std::invalid_argument(
+                    "Transposed multiplication with streamed matrix: vector is not a column vector!");
+        }
+
+        const compressed_matrix_header &header = _header;
+        auto y = Y.begin();
+        std::vector<std::vector<double>> partials(ParallelThreads());
+
+        Stream([&](unsigned int block, const std::vector<char> &data, unsigned int slot) {
+            std::vector<double> &partial = partials[slot];
+            if (partial.empty()) partial.assign(header.columns, 0.0);
+            DecodeCompressedBlock(header, block, data.data(), data.size(),
+                                  [&](unsigned int row, unsigned int column, double value) {
+                                      partial[column] += value * y[row];
+                                  });
+        });
+
+        vector ATY(columns(), true);
+        auto aty = ATY.begin();
+        for (auto const &partial : partials) {
+            if (partial.empty()) continue;
+            ParallelFor(0, columns(), [&](unsigned long first, unsigned long last) {
+                for (unsigned long column = first; column < last; ++column) {
+                    aty[column] += partial[column];
+                }
+            }, 4096);
+        }
+        return ATY;
+    }
+
+    void sparse_matrix_stream::MultiplyBoth(const vector &X, const vector &Y, vector &AX, vector &ATY) const {
+        if (X.size() != columns() or Y.size() != rows()) {
+            throw std::length_error(
+                    "Multiplication with streamed matrix: vector and matrix are not compatible in dimension");
+        } else if (!X.isColumn() or !Y.isColumn()) {
+            throw std::invalid_argument(
+                    "Multiplication with streamed matrix: vector is not a column vector! First transpose it for goodness' sake.");
+        }
+
+        const compressed_matrix_header &header = _header;
+        auto x = X.begin();
+        auto y = Y.begin();
+        vector Product(rows(), true);
+        auto ax = Product.begin();
+        std::vector<std::vector<double>> partials(ParallelThreads());
+
+        Stream([&](unsigned int block, const std::vector<char> &data, unsigned int slot) {
+            std::vector<double> &partial = partials[slot];
+            if (partial.empty()) partial.assign(header.columns, 0.0);
+            DecodeCompressedBlock(header, block, data.data(), data.size(),
+                                  [&](unsigned int row, unsigned int column, double value) {
+                                      ax[row] += value * x[column];
+                                      partial[column] += value * y[row];
+                                  });
+        });
+
+        vector TransposedProduct(columns(), true);
+        auto aty = TransposedProduct.begin();
+        for (auto const &partial : partials) {
+            if (partial.empty()) continue;
+            ParallelFor(0, columns(), [&](unsigned long first, unsigned long last) {
+                for (unsigned long column = first; column < last; ++column) {
+                    aty[column] += partial[column];
+                }
+            }, 4096);
+        }
+
+        AX = Product;
+        ATY = TransposedProduct;
+    }
+}
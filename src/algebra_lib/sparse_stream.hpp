@@ -0,0 +1,80 @@
+/*! \file sparse_stream.hpp
+ * \brief Out-of-core sparse matrix vector products.
+ *
+ * A sparse_matrix_stream never holds the matrix in memory. Every product reads the row
+ * blocks of a file written by WriteCompressedMatrix from disk, in order. A reader thread
+ * keeps a number of blocks in flight, so I/O overlaps with the multiplication of the
+ * blocks that have already arrived. Memory use is bounded by the vectors involved plus
+ * the blocks in flight.
+ */
+
+#ifndef LINEARALGEBRA_SPARSESTREAM_HPP
+#define LINEARALGEBRA_SPARSESTREAM_HPP
+
+#include <functional>
+#include <string>
+#include "globals.hpp"
+#include "vector.hpp"
+#include "sparse_compressed_io.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Read only view of a compressed sparse matrix file, supporting streaming products.
+     */
+    class sparse_matrix_stream {
+    public:
+        /*!
+         * \brief Open a file written by WriteCompressedMatrix.
+         * @param filename Compressed matrix file.
+         * @param blocksInFlight Number of blocks the reader may run ahead of the multiplication.
+         * @throw std::invalid_argument File doesn't exist or is not a compressed sparse matrix.
+         */
+        explicit sparse_matrix_stream(const char *filename, unsigned int blocksInFlight = 8);
+
+        unsigned int rows() const { return _header.rows; }
+
+        unsigned int columns() const { return _header.columns; }
+
+        /*!
+         * \brief Matrix vector product \f$ A x \f$ in one pass over the file.
+         * @param X \f$ n \times 1 \f$ (column) vector
+         * @return \f$ m \times 1 \f$ (column) vector
+         * @throw std::length_error A and X are not of compatible dimension.
+         * @throw std::invalid_argument X is not a column vector.
+         */
+        vector Multiply(const vector &X) const;
+
+        /*!
+         * \brief Transposed matrix vector product \f$ A^T y \f$ in one pass over the file.
+         * @param Y \f$ m \times 1 \f$ (column) vector
+         * @return \f$ n \times 1 \f$ (column) vector
+         * @throw std::length_error A and Y are not of compatible dimension.
+         * @throw std::invalid_argument Y is not a column vector.
+         */
+        vector MultiplyTransposed(const vector &Y) const;
+
+        /*!
+         * \brief Both \f$ A x \f$ and \f$ A^T y \f$, sharing a single pass over the file.
+         * @param X \f$ n \times 1 \f$ (column) vector
+         * @param Y \f$ m \times 1 \f$ (column) vector
+         * @param AX Receives \f$ A x \f$.
+         * @param ATY Receives \f$ A^T y \f$.
+         */
+        void MultiplyBoth(const vector &X, const vector &Y, vector &AX, vector &ATY) const;
+
+    private:
+        /*!
+         * \brief Read all blocks in the background and hand them to process in order of arrival.
+         *
+         * process(block, data, slot) runs on the pool; slot is unique among concurrently running
+         * calls and smaller than ParallelThreads(), so it can index per thread accumulators.
+         */
+        void Stream(const std::function<void(unsigned int, const std::vector<char> &, unsigned int)> &process) const;
+
+        std::string _filename;
+        compressed_matrix_header _header;
+        unsigned int _blocksInFlight;
+    };
+}
+
+#endif //LINEARALGEBRA_SPARSESTREAM_HPP
@@ -3,6 +3,7 @@
 //
 
 #include "sparse_algebra.hpp"
+#include <algorithm>
 #include <cmath>
 #include "sparse_vector.hpp"
 
@@ -32,13 +33,11 @@ namespace algebra_lib {
         } else if (i >= _numElements)
             throw std::out_of_range("Exceeded number of elements");
 
-        double val = 0.0;
-        try {
-            return _vectorMap.at(i);
-        } catch (std::out_of_range &e) {
-            val = 0.0;
+        unsigned int position = LowerBound(i);
+        if (position < _entries.size() and _entries.indices()[position] == i) {
+            return _entries.values()[position];
         }
-        return val;
+        return 0.0;
     }
 
     double &sparse_vector::operator()(unsigned int i) {
@@ -47,21 +46,83 @@ namespace algebra_lib {
         } else if (i >= _numElements)
             throw std::out_of_range("Exceeded number of elements");
 
-        // Try to find current key in sparse vector, if it does not exist, we get iterator at end of map.
-        const std::map<unsigned int, double>::iterator &lookup = _vectorMap.find(i);
-        if (lookup != _vectorMap.end()) {
-            return lookup->second;
+        // Most assignments go in increasing index order, so check the end before searching.
+        unsigned int entries = _entries.size();
+        if (entries == 0 or i > _entries.indices()[entries - 1]) {
+            _entries.push_back(i, 0.0);
+            return _entries.values()[entries];
         }
-        return _vectorMap[i];
+        unsigned int position = LowerBound(i);
+        if (_entries.indices()[position] != i) {
+            _entries.insert(position, i, 0.0);
+        }
+        return _entries.values()[position];
     }
 
     const double sparse_vector::operator()(unsigned int i) const {
         return (this)->operator[](i);
     }
 
+    unsigned int sparse_vector::LowerBound(unsigned int i) const {
+        const unsigned int *indices = _entries.indices();
+        return static_cast<unsigned int>(std::lower_bound(indices, indices + _entries.size(), i) - indices);
+    }
+
+    void sparse_vector::Reserve(unsigned int entries) {
+        _entries.reserve(entries);
+    }
+
+    void sparse_vector::Append(unsigned int index, double value) {
+        if (index >= _numElements) {
+            throw std::out_of_range("Exceeded number of elements");
+        } else if (!_entries.empty() and index <= _entries.indices()[_entries.size() - 1]) {
+            throw std::invalid_argument("Appending to sparse vector: index is not past the last stored entry.");
+        }
+        _entries.push_back(index, value);
+    }
+
+    void sparse_vector::InsertBatch(std::vector<std::pair<unsigned int, double>> entries) {
+        for (auto const &entry : entries) {
+            if (entry.first >= _numElements) throw std::out_of_range("Exceeded number of elements");
+        }
+        // Stable, so of equal indices the last written ends up last.
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const std::pair<unsigned int, double> &a, const std::pair<unsigned int, double> &b) {
+                             return a.first < b.first;
+                         });
+
+        sparse_entry_storage merged;
+        merged.reserve(static_cast<unsigned int>(_entries.size() + entries.size()));
+
+        const unsigned int *indices = _entries.indices();
+        const double *values = _entries.values();
+        unsigned int stored = 0;
+        auto entry = entries.begin();
+        while (stored < _entries.size() or entry != entries.end()) {
+            if (entry == entries.end() or (stored < _entries.size() and indices[stored] < entry->first)) {
+                merged.push_back(indices[stored], values[stored]);
+                ++stored;
+                continue;
+            }
+            unsigned int index = entry->first;
+            while (entry + 1 != entries.end() and (entry + 1)->first == index) ++entry;
+            if (stored < _entries.size() and indices[stored] == index) ++stored;
+            merged.push_back(index, entry->second);
+            ++entry;
+        }
+        _entries.swap(merged);
+    }
+
+    void sparse_vector::eraseEntry(unsigned int element) {
+        unsigned int position = LowerBound(element);
+        if (position < _entries.size() and _entries.indices()[position] == element) {
+            _entries.erase(position);
+        }
+    }
+
     sparse_vector sparse_vector::Transpose() const{
         sparse_vector T(_numElements, !_isColumn);
-        T._vectorMap = _vectorMap;
+        T._entries = _entries;
         return T;
     }
 
@@ -72,44 +133,48 @@ namespace algebra_lib {
         return (*this);
     }
 
-    sparseVectorContentDouble::const_iterator sparse_vector::begin() const {
-        return _vectorMap.begin();
+    sparse_vector_iterator sparse_vector::begin() const {
+        return sparse_vector_iterator(_entries.indices(), _entries.values());
     }
 
-    sparseVectorContentDouble::const_iterator sparse_vector::end() const {
-        return _vectorMap.end();
+    sparse_vector_iterator sparse_vector::end() const {
+        return begin() + _entries.size();
     }
 
-    sparseVectorContentDouble::reverse_iterator sparse_vector::rbegin() {
-        return _vectorMap.rbegin();
+    sparse_vector_reverse_iterator sparse_vector::rbegin() const {
+        return sparse_vector_reverse_iterator(end());
     }
 
-    sparseVectorContentDouble::reverse_iterator sparse_vector::rend() {
-        return _vectorMap.rend();
+    sparse_vector_reverse_iterator sparse_vector::rend() const {
+        return sparse_vector_reverse_iterator(begin());
     }
 
-    sparseVectorContentDouble::const_iterator sparse_vector::cbegin() const noexcept {
-        return _vectorMap.cbegin();
+    sparse_vector_iterator sparse_vector::cbegin() const noexcept {
+        return begin();
     }
 
-    sparseVectorContentDouble::const_iterator sparse_vector::cend() const noexcept {
-        return _vectorMap.cend();
+    sparse_vector_iterator sparse_vector::cend() const noexcept {
+        return end();
     }
 
-    sparseVectorContentDouble::const_reverse_iterator sparse_vector::crbegin() const noexcept {
-        return _vectorMap.crbegin();
+    sparse_vector_reverse_iterator sparse_vector::crbegin() const noexcept {
+        return rbegin();
     }
 
-    sparseVectorContentDouble::const_reverse_iterator sparse_vector::crend() const noexcept {
-        return _vectorMap.crend();
+    sparse_vector_reverse_iterator sparse_vector::crend() const noexcept {
+        return rend();
     }
 
     sparse_vector sparse_vector::Normalize() const{
         return (*this) / sqrt((*this) * (*this));
     }
 
-    std::map<unsigned int, double>::const_iterator sparse_vector::find(const unsigned int &key ) const {
-        return _vectorMap.find(key);
+    sparse_vector_iterator sparse_vector::find(const unsigned int &key ) const {
+        unsigned int position = LowerBound(key);
+        if (position < _entries.size() and _entries.indices()[position] == key) {
+            return begin() + position;
+        }
+        return end();
     }
 }
 // --- end of class ---
@@ -1,20 +1,115 @@
 #ifndef LINEARALGEBRA_SPARSEVECTOR_H
 #define LINEARALGEBRA_SPARSEVECTOR_H
 
+#include <iterator>
 #include "globals.hpp"
+#include "sparse_storage.hpp"
 
 namespace algebra_lib {
     /*!
-     * \brief Class for sparse vectors.
+     * \brief Read only iterator over the stored entries of a sparse_vector, in increasing index order.
+     *
+     * Dereferencing yields an (index, value) pair by value, so entry.first and entry.second
+     * work as they would on a map.
      */
-    // Type definitions
-    typedef std::map<unsigned int, double> sparseVectorContentDouble;
-
-    class sparse_vector {
+    class sparse_vector_iterator {
     public:
-        // Fields
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef std::pair<unsigned int, double> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const value_type reference;
+
+        /*!
+         * \brief Makes iterator->first and iterator->second work on the pair returned by value.
+         */
+        struct pointer {
+            value_type entry;
+
+            const value_type *operator->() const { return &entry; }
+        };
+
+        sparse_vector_iterator() : _index(nullptr), _value(nullptr) {}
+
+        sparse_vector_iterator(const unsigned int *index, const double *value) : _index(index), _value(value) {}
+
+        reference operator*() const { return value_type(*_index, *_value); }
+
+        pointer operator->() const { return pointer{value_type(*_index, *_value)}; }
+
+        reference operator[](difference_type offset) const { return value_type(_index[offset], _value[offset]); }
+
+        sparse_vector_iterator &operator++() {
+            ++_index;
+            ++_value;
+            return *this;
+        }
+
+        sparse_vector_iterator operator++(int) {
+            sparse_vector_iterator previous = *this;
+            ++(*this);
+            return previous;
+        }
+
+        sparse_vector_iterator &operator--() {
+            --_index;
+            --_value;
+            return *this;
+        }
+
+        sparse_vector_iterator operator--(int) {
+            sparse_vector_iterator previous = *this;
+            --(*this);
+            return previous;
+        }
+
+        sparse_vector_iterator &operator+=(difference_type offset) {
+            _index += offset;
+            _value += offset;
+            return *this;
+        }
+
+        sparse_vector_iterator &operator-=(difference_type offset) { return (*this) += -offset; }
+
+        sparse_vector_iterator operator+(difference_type offset) const {
+            return sparse_vector_iterator(_index + offset, _value + offset);
+        }
+
+        sparse_vector_iterator operator-(difference_type offset) const {
+            return sparse_vector_iterator(_index - offset, _value - offset);
+        }
 
+        difference_type operator-(const sparse_vector_iterator &other) const { return _index - other._index; }
 
+        bool operator==(const sparse_vector_iterator &other) const { return _index == other._index; }
+
+        bool operator!=(const sparse_vector_iterator &other) const { return _index != other._index; }
+
+        bool operator<(const sparse_vector_iterator &other) const { return _index < other._index; }
+
+        bool operator>(const sparse_vector_iterator &other) const { return _index > other._index; }
+
+        bool operator<=(const sparse_vector_iterator &other) const { return _index <= other._index; }
+
+        bool operator>=(const sparse_vector_iterator &other) const { return _index >= other._index; }
+
+    private:
+        const unsigned int *_index;
+        const double *_value;
+    };
+
+    typedef std::reverse_iterator<sparse_vector_iterator> sparse_vector_reverse_iterator;
+
+    /*!
+     * \brief Class for sparse vectors.
+     *
+     * Entries are stored in two parallel arrays of indices and values, sorted by index,
+     * inside the object itself while there are few of them (see sparse_storage.hpp).
+     * Appending in index order is amortized constant time, lookups are binary searches.
+     * Inserting a single entry out of order shifts all later entries; use InsertBatch
+     * for many out of order writes.
+     */
+    class sparse_vector {
+    public:
         // Constructors
         sparse_vector();
 
@@ -27,25 +122,30 @@ namespace algebra_lib {
 
         const double operator[](unsigned int i) const;
 
+        /*!
+         * \brief Access entry for assignment, storing it if it isn't stored yet.
+         *
+         * The reference is invalidated by the next operation storing or erasing an entry.
+         */
         double &operator()(unsigned int i);
 
         const double operator()(unsigned int i) const;
 
-        sparseVectorContentDouble::const_iterator begin() const;
+        sparse_vector_iterator begin() const;
 
-        sparseVectorContentDouble::const_iterator end() const;
+        sparse_vector_iterator end() const;
 
-        sparseVectorContentDouble::reverse_iterator rbegin();
+        sparse_vector_reverse_iterator rbegin() const;
 
-        sparseVectorContentDouble::reverse_iterator rend();
+        sparse_vector_reverse_iterator rend() const;
 
-        sparseVectorContentDouble::const_iterator cbegin() const noexcept;
+        sparse_vector_iterator cbegin() const noexcept;
 
-        sparseVectorContentDouble::const_iterator cend() const noexcept;
+        sparse_vector_iterator cend() const noexcept;
 
-        sparseVectorContentDouble::const_reverse_iterator crbegin() const noexcept;
+        sparse_vector_reverse_iterator crbegin() const noexcept;
 
-        sparseVectorContentDouble::const_reverse_iterator crend() const noexcept;
+        sparse_vector_reverse_iterator crend() const noexcept;
 
         // Member functions
         sparse_vector Normalize() const;
@@ -54,21 +154,62 @@ namespace algebra_lib {
 
         sparse_vector TransposeSelf();
 
-        std::map<unsigned int, double>::const_iterator find(const unsigned int &key) const;
+        sparse_vector_iterator find(const unsigned int &key) const;
 
         unsigned int size() const { return _numElements; }
 
+        unsigned int nonZeros() const { return _entries.size(); }
+
         bool isColumn() const { return _isColumn; }
 
-        void eraseEntry(unsigned int element) { _vectorMap.erase(element); }
+        void eraseEntry(unsigned int element);
+
+        /*!
+         * \brief Sorted indices of the stored entries, nonZeros() long.
+         */
+        const unsigned int *indices() const { return _entries.indices(); }
+
+        /*!
+         * \brief Values of the stored entries, in the order of indices().
+         */
+        const double *values() const { return _entries.values(); }
+
+        /*!
+         * \brief Reserve room for a number of stored entries.
+         */
+        void Reserve(unsigned int entries);
+
+        /*!
+         * \brief Store an entry behind all stored entries, without searching.
+         * @param index Must exceed the largest stored index.
+         * @param value Value of the entry.
+         * @throw std::out_of_range index exceeds the dimension of the vector.
+         * @throw std::invalid_argument index doesn't exceed the largest stored index.
+         */
+        void Append(unsigned int index, double value);
+
+        /*!
+         * \brief Store many entries in any order, in one merge with the stored entries.
+         *
+         * Equivalent to (*this)(index) = value for every pair, in order, but costs
+         * \f$ O(nnz + k \log k) \f$ instead of \f$ O(k \cdot nnz) \f$.
+         * @param entries (index, value) pairs. Later pairs win over earlier ones with the same index.
+         * @throw std::out_of_range An index exceeds the dimension of the vector.
+         */
+        void InsertBatch(std::vector<std::pair<unsigned int, double>> entries);
 
         // Friend functions
         friend std::ostream &operator<<(std::ostream &stream, const sparse_vector &SparseVector);
 
     private:
+        /*!
+         * \brief Position of the first stored index not below i.
+         */
+        unsigned int LowerBound(unsigned int i) const;
+
         unsigned _numElements;
         bool _isColumn;
-        sparseVectorContentDouble _vectorMap;
+        sparse_entry_storage _entries;
 
     };
 }
@@ -0,0 +1,936 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include "parallel.hpp"
+#include "dense_kernels.hpp"
+#include "symmetric_eigen.hpp"
+
+namespace algebra_lib {
+    namespace {
+        const double epsilon = std::numeric_limits<double>::epsilon();
+
+        // Tridiagonal blocks up to this size are solved by QL within divide and conquer, and
+        // from this size on both halves of a split are solved in parallel.
+        const unsigned long leafSize = 32;
+        const unsigned long parallelSize = 256;
+
+        // Reflections per block of the back transformation.
+        const unsigned long reflectorBlock = 32;
+
+        /*
+         * T = Q^T A Q, with Q the product of the reflections I - scale_k v_k v_k^T.
+         */
+        struct tridiagonal_form {
+            std::vector<double> diagonal;
+            // offDiagonal[i] couples i and i + 1, the last one is zero.
+            std::vector<double> offDiagonal;
+            // Row k of n holds v_k, which is zero before k + 1 and one at k + 1.
+            std::vector<double> reflectors;
+            std::vector<double> scales;
+        };
+
+        /*
+         * Bounds of parts of the rows [0, m) of a lower triangle with about equal numbers of
+         * entries, as many as the pool has threads if the triangle is large enough.
+         */
+        std::vector<unsigned long> TriangleParts(unsigned long m) {
+            const unsigned long parts = std::max(1ul, std::min(static_cast<unsigned long>(ParallelThreads()),
+                                                               m * m / 65536));
+            std::vector<unsigned long> bounds(parts + 1, m);
+            for (unsigned long part = 0; part < parts; ++part) {
+                bounds[part] = static_cast<unsigned long>(m * std::sqrt(static_cast<double>(part) / parts));
+            }
+            return bounds;
+        }
+
+        /*
+         * p = tau A v for the symmetric m x m matrix whose lower triangle has rows a + i stride.
+         * Every row adds its dot product to p_i and its entries times v_i to p_j, so every part
+         * of the rows sums into its own copy of p.
+         */
+        void SymmetricProduct(const double *a, unsigned long stride, unsigned long m, double tau, const double *v,
+                              double *p, std::vector<double> &partial) {
+            const std::vector<unsigned long> bounds = TriangleParts(m);
+            const unsigned long parts = bounds.size() - 1;
+            partial.assign((parts - 1) * m, 0.0);
+            std::fill(p, p + m, 0.0);
+            ParallelFor(0, parts, [&](unsigned long first, unsigned long last) {
+                for (unsigned long part = first; part < last; ++part) {
+                    double *q = part == 0 ? p : partial.data() + (part - 1) * m;
+                    for (unsigned long i = bounds[part]; i < bounds[part + 1]; ++i) {
+                        const double *row = a + i * stride;
+                        const double vi = v[i];
+                        double sum = row[i] * vi;
+                        for (unsigned long j = 0; j < i; ++j) {
+                            sum += row[j] * v[j];
+                            q[j] += row[j] * vi;
+                        }
+                        q[i] += sum;
+                    }
+                }
+            });
+            for (unsigned long part = 1; part < parts; ++part) {
+                const double *q = partial.data() + (part - 1) * m;
+                for (unsigned long j = 0; j < bounds[part + 1]; ++j) {
+                    p[j] += q[j];
+                }
+            }
+            for (unsigned long j = 0; j < m; ++j) {
+                p[j] *= tau;
+            }
+        }
+
+        /*
+         * A -= v w^T + w v^T on the lower triangle.
+         */
+        void RankTwoUpdate(double *a, unsigned long stride, unsigned long m, const double *v, const double *w) {
+            const std::vector<unsigned long> bounds = TriangleParts(m);
+            ParallelFor(0, bounds.size() - 1, [&](unsigned long first, unsigned long last) {
+                for (unsigned long part = first; part < last; ++part) {
+                    for (unsigned long i = bounds[part]; i < bounds[part + 1]; ++i) {
+                        double *row = a + i * stride;
+                        const double vi = v[i];
+                        const double wi = w[i];
+                        for (unsigned long j = 0; j <= i; ++j) {
+                            row[j] -= vi * w[j] + wi * v[j];
+                        }
+                    }
+                }
+            });
+        }
+
+        /*
+         * Householder reduction of the lower triangle of A, column by column. Reflection k
+         * zeroes column k below the subdiagonal; the trailing matrix takes it as the rank two
+         * update with w = p - (tau / 2) (p . v) v, p = tau A v.
+         */
+        tridiagonal_form Tridiagonalize(const matrix &A, bool keepReflectors) {
+            if (A.rows() != A.columns()) {
+                throw std::length_error("Symmetric eigendecomposition: matrix is not square.");
+            }
+            const unsigned long n = A.rows();
+            tridiagonal_form form;
+            form.diagonal.assign(n, 0.0);
+            form.offDiagonal.assign(n, 0.0);
+            if (keepReflectors) {
+                form.reflectors.assign(n * n, 0.0);
+                form.scales.assign(n, 0.0);
+            }
+            if (n == 0) return form;
+
+            std::vector<double> work(n * n);
+            auto rows = A.begin();
+            for (unsigned long i = 0; i < n; ++i) {
+                auto a = rows[i].begin();
+                std::copy(a, a + i + 1, work.begin() + i * n);
+            }
+
+            std::vector<double> v(n);
+            std::vector<double> p(n);
+            std::vector<double> partial;
+            for (unsigned long k = 0; k + 2 < n; ++k) {
+                const unsigned long m = n - k - 1;
+                double *column = work.data() + (k + 1) * n + k;
+                form.diagonal[k] = work[k * n + k];
+
+                const double alpha = column[0];
+                double norm = 0.0;
+                for (unsigned long i = 1; i < m; ++i) {
+                    norm += column[i * n] * column[i * n];
+                }
+                if (norm == 0) {
+                    form.offDiagonal[k] = alpha;
+                    if (keepReflectors) form.reflectors[k * n + k + 1] = 1.0;
+                    continue;
+                }
+                const double beta = -std::copysign(std::sqrt(alpha * alpha + norm), alpha);
+                const double tau = (beta - alpha) / beta;
+                const double scale = 1 / (alpha - beta);
+                v[0] = 1.0;
+                for (unsigned long i = 1; i < m; ++i) {
+                    v[i] = column[i * n] * scale;
+                }
+                form.offDiagonal[k] = beta;
+
+                double *trailing = work.data() + (k + 1) * n + k + 1;
+                SymmetricProduct(trailing, n, m, tau, v.data(), p.data(), partial);
+                double pv = 0.0;
+                for (unsigned long i = 0; i < m; ++i) {
+                    pv += p[i] * v[i];
+                }
+                for (unsigned long i = 0; i < m; ++i) {
+                    p[i] -= 0.5 * tau * pv * v[i];
+                }
+                RankTwoUpdate(trailing, n, m, v.data(), p.data());
+
+                if (keepReflectors) {
+                    std::copy(v.begin(), v.begin() + m, form.reflectors.begin() + k * n + k + 1);
+                    form.scales[k] = tau;
+                }
+            }
+            if (n >= 2) {
+                form.diagonal[n - 2] = work[(n - 2) * n + n - 2];
+                form.offDiagonal[n - 2] = work[(n - 1) * n + n - 2];
+            }
+            form.diagonal[n - 1] = work[(n - 1) * n + n - 1];
+            return form;
+        }
+
+        /*
+         * Z = Q Z for the n x c matrix Z, by blocks of reflections from the last to the first.
+         * A block H_b ... H_e is I - V S V^T with S upper triangular, so it takes two products
+         * through MultiplyAdd and one with the small S.
+         */
+        void BackTransform(const tridiagonal_form &form, unsigned long n, double *z, unsigned long c) {
+            const unsigned long reflections = n >= 3 ? n - 2 : 0;
+            if (reflections == 0 or c == 0) return;
+
+            std::vector<double> s(reflectorBlock * reflectorBlock);
+            std::vector<double> t(reflectorBlock);
+            std::vector<double> y(reflectorBlock * c);
+            std::vector<double> vRows;
+            std::vector<const double *> vtPointers(reflectorBlock);
+            std::vector<const double *> vPointers;
+            std::vector<const double *> yPointers(reflectorBlock);
+            std::vector<double *> yWritePointers(reflectorBlock);
+            std::vector<const double *> zReadPointers;
+            std::vector<double *> zPointers;
+
+            for (unsigned long blockBegin = (reflections - 1) / reflectorBlock * reflectorBlock;;
+                 blockBegin -= reflectorBlock) {
+                const unsigned long b = std::min(reflectorBlock, reflections - blockBegin);
+                const unsigned long offset = blockBegin + 1;
+                const unsigned long length = n - offset;
+                const double *v = form.reflectors.data();
+
+                // S(i, i) = scale_i, S(0:i, i) = S(0:i, 0:i) t with t_j = -scale_i v_j . v_i.
+                std::fill(s.begin(), s.end(), 0.0);
+                for (unsigned long i = 0; i < b; ++i) {
+                    const double scale = form.scales[blockBegin + i];
+                    const double *vi = v + (blockBegin + i) * n;
+                    for (unsigned long j = 0; j < i; ++j) {
+                        const double *vj = v + (blockBegin + j) * n;
+                        double dot = 0.0;
+                        for (unsigned long r = blockBegin + i + 1; r < n; ++r) {
+                            dot += vj[r] * vi[r];
+                        }
+                        t[j] = -scale * dot;
+                    }
+                    for (unsigned long j = 0; j < i; ++j) {
+                        double sum = 0.0;
+                        for (unsigned long l = j; l < i; ++l) {
+                            sum += s[j * reflectorBlock + l] * t[l];
+                        }
+                        s[j * reflectorBlock + i] = sum;
+                    }
+                    s[i * reflectorBlock + i] = scale;
+                }
+
+                vRows.assign(length * b, 0.0);
+                vPointers.resize(length);
+                zReadPointers.resize(length);
+                zPointers.resize(length);
+                for (unsigned long i = 0; i < b; ++i) {
+                    vtPointers[i] = v + (blockBegin + i) * n + offset;
+                }
+                for (unsigned long r = 0; r < length; ++r) {
+                    for (unsigned long i = 0; i < b; ++i) {
+                        vRows[r * b + i] = v[(blockBegin + i) * n + offset + r];
+                    }
+                    vPointers[r] = vRows.data() + r * b;
+                    zPointers[r] = z + (offset + r) * c;
+                    zReadPointers[r] = zPointers[r];
+                }
+                for (unsigned long i = 0; i < b; ++i) {
+                    yWritePointers[i] = y.data() + i * c;
+                    yPointers[i] = yWritePointers[i];
+                }
+
+                // Y = V^T Z, Y = S Y, Z -= V Y.
+                std::fill(y.begin(), y.begin() + b * c, 0.0);
+                MultiplyAdd(b, c, length, 1.0, vtPointers.data(), zReadPointers.data(), yWritePointers.data());
+                for (unsigned long i = 0; i < b; ++i) {
+                    double *yi = yWritePointers[i];
+                    const double diagonal = s[i * reflectorBlock + i];
+                    for (unsigned long column = 0; column < c; ++column) {
+                        yi[column] *= diagonal;
+                    }
+                    for (unsigned long j = i + 1; j < b; ++j) {
+                        const double factor = s[i * reflectorBlock + j];
+                        const double *yj = yPointers[j];
+                        for (unsigned long column = 0; column < c; ++column) {
+                            yi[column] += factor * yj[column];
+                        }
+                    }
+                }
+                MultiplyAdd(length, c, b, -1.0, vPointers.data(), yPointers.data(), zPointers.data());
+
+                if (blockBegin == 0) break;
+            }
+        }
+
+        /*
+         * Implicit QL with Wilkinson shifts on the tridiagonal matrix of d and e, e[n - 1] = 0.
+         * The rotations are applied to the columns of the n rows of z if it isn't null.
+         */
+        void TridiagonalQL(double *d, double *e, unsigned long n, double *z, unsigned long stride) {
+            for (unsigned long l = 0; l < n; ++l) {
+                unsigned int iterations = 0;
+                unsigned long m;
+                do {
+                    for (m = l; m + 1 < n; ++m) {
+                        const double scale = std::fabs(d[m]) + std::fabs(d[m + 1]);
+                        if (std::fabs(e[m]) <= epsilon * scale) break;
+                    }
+                    if (m == l) break;
+                    if (++iterations > 60) {
+                        throw std::domain_error("Symmetric eigendecomposition: QL iteration doesn't converge.");
+                    }
+
+                    double g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+                    double r = std::hypot(g, 1.0);
+                    g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+                    double s = 1.0;
+                    double c = 1.0;
+                    double p = 0.0;
+                    bool underflow = false;
+                    for (unsigned long i = m; i-- > l;) {
+                        const double f = s * e[i];
+                        const double b = c * e[i];
+                        r = std::hypot(f, g);
+                        e[i + 1] = r;
+                        if (r == 0) {
+                            d[i + 1] -= p;
+                            e[m] = 0.0;
+                            underflow = true;
+                            break;
+                        }
+                        s = f / r;
+                        c = g / r;
+                        g = d[i + 1] - p;
+                        r = (d[i] - g) * s + 2.0 * c * b;
+                        p = s * r;
+                        d[i + 1] = g + p;
+                        g = c * r - b;
+                        if (z != nullptr) {
+                            for (unsigned long k = 0; k < n; ++k) {
+                                double *row = z + k * stride;
+                                const double t = row[i + 1];
+                                row[i + 1] = s * row[i] + c * t;
+                                row[i] = c * row[i] - s * t;
+                            }
+                        }
+                    }
+                    if (underflow) continue;
+                    d[l] -= p;
+                    e[l] = g;
+                    e[m] = 0.0;
+                } while (m != l);
+            }
+        }
+
+        /*
+         * Sort d ascending, along with the columns of the n rows of z.
+         */
+        void SortEigenpairs(double *d, unsigned long n, double *z, unsigned long stride) {
+            for (unsigned long i = 0; i + 1 < n; ++i) {
+                unsigned long smallest = i;
+                for (unsigned long j = i + 1; j < n; ++j) {
+                    if (d[j] < d[smallest]) smallest = j;
+                }
+                if (smallest == i) continue;
+                std::swap(d[i], d[smallest]);
+                for (unsigned long k = 0; k < n; ++k) {
+                    std::swap(z[k * stride + i], z[k * stride + smallest]);
+                }
+            }
+        }
+
+        /*
+         * Root j of 1 + rho sum_i z_i^2 / (d_i - lambda) = 0, with d ascending and rho > 0, as
+         * lambda = d[origin] + tau. The origin is the pole nearest to the root, so the
+         * differences d_i - lambda that the eigenvectors are made of keep their precision.
+         * Iterates on a model with the two poles around the root (Bunch, Nielsen and
+         * Sorensen), falling back to bisection of the bracket.
+         */
+        double SecularRoot(const double *d, const double *z, unsigned long count, double rho, unsigned long j,
+                           unsigned long &origin) {
+            double lower;
+            double upper;
+            if (j + 1 < count) {
+                const double half = (d[j + 1] - d[j]) / 2;
+                double f = 1.0;
+                for (unsigned long i = 0; i < count; ++i) {
+                    f += rho * z[i] * z[i] / ((d[i] - d[j]) - half);
+                }
+                if (f >= 0) {
+                    origin = j;
+                    lower = 0.0;
+                    upper = half;
+                } else {
+                    origin = j + 1;
+                    lower = -half;
+                    upper = 0.0;
+                }
+            } else {
+                origin = j;
+                lower = 0.0;
+                upper = 0.0;
+                for (unsigned long i = 0; i < count; ++i) {
+                    upper += rho * z[i] * z[i];
+                }
+            }
+
+            const double base = d[origin];
+            const double left = d[j] - base;
+            const double right = j + 1 < count ? d[j + 1] - base : 0.0;
+            double tau = (lower + upper) / 2;
+            for (unsigned int iteration = 0; iteration < 100; ++iteration) {
+                double psi = 0.0, psiDerivative = 0.0, phi = 0.0, phiDerivative = 0.0;
+                for (unsigned long i = 0; i <= j; ++i) {
+                    const double term = z[i] / ((d[i] - base) - tau);
+                    psi += z[i] * term;
+                    psiDerivative += term * term;
+                }
+                for (unsigned long i = j + 1; i < count; ++i) {
+                    const double term = z[i] / ((d[i] - base) - tau);
+                    phi += z[i] * term;
+                    phiDerivative += term * term;
+                }
+                const double f = 1.0 + rho * (psi + phi);
+                if (std::fabs(f) <= epsilon * (1.0 + rho * (std::fabs(psi) + std::fabs(phi)))) break;
+                if (f < 0) {
+                    lower = tau;
+                } else {
+                    upper = tau;
+                }
+                if (upper - lower <= 2 * epsilon * std::max(std::fabs(lower), std::fabs(upper))) break;
+
+                // rho psi ~ p + q / (a - eta) and rho phi ~ r + t / (b - eta), fitted at eta = 0.
+                const double a = left - tau;
+                const double q = rho * psiDerivative * a * a;
+                double constant = 1.0 + rho * psi - q / a;
+                double eta;
+                if (j + 1 < count) {
+                    const double b = right - tau;
+                    const double t = rho * phiDerivative * b * b;
+                    constant += rho * phi - t / b;
+                    const double B = -(constant * (a + b) + q + t);
+                    const double C = constant * a * b + q * b + t * a;
+                    if (std::fabs(constant) <= epsilon * (std::fabs(B) + std::fabs(C))) {
+                        eta = -C / B;
+                    } else {
+                        const double root = std::sqrt(std::max(0.0, B * B - 4 * constant * C));
+                        const double first = (-B - std::copysign(root, B)) / (2 * constant);
+                        const double second = C / (constant * first);
+                        eta = (tau + first > lower and tau + first < upper) ? first : second;
+                    }
+                } else {
+                    eta = a + q / constant;
+                }
+                const double next = tau + eta;
+                if (next > lower and next < upper) {
+                    const bool converged = std::fabs(eta) <= 2 * epsilon * std::fabs(tau);
+                    tau = next;
+                    if (converged) break;
+                } else {
+                    tau = (lower + upper) / 2;
+                }
+            }
+            return tau;
+        }
+
+        /*
+         * Eigenvalues (into d, ascending) and eigenvectors (the columns of the n x n q) of the
+         * tridiagonal matrix of d and e, e[i] coupling i and i + 1. T is torn into two halves
+         * by subtracting |beta| u u^T, u = e_{m - 1} + sign(beta) e_m, and the eigensystems of
+         * the halves are merged as that of diag(D) + rho z z^T.
+         */
+        void DivideConquer(double *d, const double *e, unsigned long n, double *q) {
+            if (n <= leafSize) {
+                std::fill(q, q + n * n, 0.0);
+                for (unsigned long i = 0; i < n; ++i) {
+                    q[i * n + i] = 1.0;
+                }
+                std::vector<double> offDiagonal(e, e + n);
+                if (n > 0) offDiagonal[n - 1] = 0.0;
+                TridiagonalQL(d, offDiagonal.data(), n, q, n);
+                SortEigenpairs(d, n, q, n);
+                return;
+            }
+
+            const unsigned long m = n / 2;
+            const unsigned long m2 = n - m;
+            const double beta = e[m - 1];
+            const double sign = beta < 0 ? -1.0 : 1.0;
+            d[m - 1] -= std::fabs(beta);
+            d[m] -= std::fabs(beta);
+
+            std::vector<double> q1(m * m);
+            std::vector<double> q2(m2 * m2);
+            auto Half = [&](unsigned long half) {
+                if (half == 0) {
+                    DivideConquer(d, e, m, q1.data());
+                } else {
+                    DivideConquer(d + m, e + m, m2, q2.data());
+                }
+            };
+            if (n >= parallelSize) {
+                ParallelFor(0, 2, [&](unsigned long first, unsigned long last) {
+                    for (unsigned long half = first; half < last; ++half) Half(half);
+                });
+            } else {
+                Half(0);
+                Half(1);
+            }
+
+            // Eigenvectors of diag(T1, T2) and z = their transpose times u, normalized.
+            std::vector<double> block(n * n, 0.0);
+            for (unsigned long r = 0; r < m; ++r) {
+                std::copy(q1.begin() + r * m, q1.begin() + (r + 1) * m, block.begin() + r * n);
+            }
+            for (unsigned long r = 0; r < m2; ++r) {
+                std::copy(q2.begin() + r * m2, q2.begin() + (r + 1) * m2, block.begin() + (m + r) * n + m);
+            }
+            std::vector<double> z(n);
+            double zNorm = 0.0;
+            for (unsigned long j = 0; j < m; ++j) {
+                z[j] = q1[(m - 1) * m + j];
+            }
+            for (unsigned long j = 0; j < m2; ++j) {
+                z[m + j] = sign * q2[j];
+            }
+            for (unsigned long j = 0; j < n; ++j) {
+                zNorm += z[j] * z[j];
+            }
+            const double rho = std::fabs(beta) * zNorm;
+            zNorm = std::sqrt(zNorm);
+            for (unsigned long j = 0; j < n; ++j) {
+                z[j] /= zNorm;
+            }
+
+            // Deflation, in order of increasing d: a negligible z_j leaves d_j and its vector
+            // as they are, and a close pair is rotated until the z of the first one vanishes.
+            // Columns of block are nonzero in the upper rows (1), the lower rows (2) or both (3).
+            std::vector<unsigned long> order(n);
+            std::iota(order.begin(), order.end(), 0ul);
+            std::inplace_merge(order.begin(), order.begin() + m, order.end(),
+                               [d](unsigned long a, unsigned long b) { return d[a] < d[b]; });
+            std::vector<int> kind(n, 1);
+            std::fill(kind.begin() + m, kind.end(), 2);
+            double largest = 0.0;
+            for (unsigned long j = 0; j < n; ++j) {
+                largest = std::max(largest, std::max(std::fabs(d[j]), std::fabs(z[j])));
+            }
+            const double tolerance = 8 * epsilon * largest;
+            std::vector<unsigned long> kept;
+            std::vector<unsigned long> deflated;
+            long previous = -1;
+            for (unsigned long next : order) {
+                if (rho * std::fabs(z[next]) <= tolerance) {
+                    deflated.push_back(next);
+                    continue;
+                }
+                if (previous < 0) {
+                    previous = static_cast<long>(next);
+                    continue;
+                }
+                const unsigned long last = static_cast<unsigned long>(previous);
+                const double length = std::hypot(z[next], z[last]);
+                const double c = z[next] / length;
+                const double s = -z[last] / length;
+                if (std::fabs((d[next] - d[last]) * c * s) <= tolerance) {
+                    z[next] = length;
+                    z[last] = 0.0;
+                    for (unsigned long r = 0; r < n; ++r) {
+                        double *row = block.data() + r * n;
+                        const double x = row[last];
+                        const double y = row[next];
+                        row[last] = c * x + s * y;
+                        row[next] = c * y - s * x;
+                    }
+                    if (kind[last] != kind[next]) kind[last] = kind[next] = 3;
+                    const double dLast = d[last] * c * c + d[next] * s * s;
+                    d[next] = d[last] * s * s + d[next] * c * c;
+                    d[last] = dLast;
+                    deflated.push_back(last);
+                } else {
+                    kept.push_back(last);
+                }
+                previous = static_cast<long>(next);
+            }
+            if (previous >= 0) kept.push_back(static_cast<unsigned long>(previous));
+            // Rotations move d by about the tolerance, which may swap neighbours.
+            std::stable_sort(kept.begin(), kept.end(), [d](unsigned long a, unsigned long b) { return d[a] < d[b]; });
+            std::sort(deflated.begin(), deflated.end(), [d](unsigned long a, unsigned long b) { return d[a] < d[b]; });
+
+            // Roots of the secular equation, and eigenvectors of diag(D) + rho z z^T from the z
+            // that has these roots exactly.
+            const unsigned long count = kept.size();
+            std::vector<double> dk(count);
+            std::vector<double> zk(count);
+            for (unsigned long i = 0; i < count; ++i) {
+                dk[i] = d[kept[i]];
+                zk[i] = z[kept[i]];
+            }
+            std::vector<unsigned long> origins(count);
+            std::vector<double> shifts(count);
+            std::vector<double> roots(count);
+            ParallelFor(0, count, [&](unsigned long first, unsigned long last) {
+                for (unsigned long j = first; j < last; ++j) {
+                    shifts[j] = SecularRoot(dk.data(), zk.data(), count, rho, j, origins[j]);
+                    roots[j] = dk[origins[j]] + shifts[j];
+                }
+            }, 16);
+            auto Difference = [&](unsigned long i, unsigned long j) {
+                return (dk[i] - dk[origins[j]]) - shifts[j];
+            };
+            std::vector<double> zHat(count);
+            ParallelFor(0, count, [&](unsigned long first, unsigned long last) {
+                for (unsigned long i = first; i < last; ++i) {
+                    double product = -Difference(i, count - 1) / rho;
+                    for (unsigned long j = 0; j < i; ++j) {
+                        product *= -Difference(i, j) / (dk[j] - dk[i]);
+                    }
+                    for (unsigned long j = i; j + 1 < count; ++j) {
+                        product *= -Difference(i, j) / (dk[j + 1] - dk[i]);
+                    }
+                    zHat[i] = std::copysign(std::sqrt(std::fabs(product)), zk[i]);
+                }
+            }, 16);
+            std::vector<double> u(count * count);
+            ParallelFor(0, count, [&](unsigned long first, unsigned long last) {
+                for (unsigned long j = first; j < last; ++j) {
+                    double norm = 0.0;
+                    for (unsigned long i = 0; i < count; ++i) {
+                        const double entry = zHat[i] / Difference(i, j);
+                        u[i * count + j] = entry;
+                        norm += entry * entry;
+                    }
+                    norm = 1 / std::sqrt(norm);
+                    for (unsigned long i = 0; i < count; ++i) {
+                        u[i * count + j] *= norm;
+                    }
+                }
+            }, 16);
+
+            // Block columns of the kept eigenvalues times u: upper rows only meet columns of
+            // kind 1 and 3, lower rows only those of kind 3 and 2.
+            std::vector<unsigned long> grouped;
+            for (int group : {1, 3, 2}) {
+                for (unsigned long i = 0; i < count; ++i) {
+                    if (kind[kept[i]] == group) grouped.push_back(i);
+                }
+            }
+            unsigned long upperColumns = 0;
+            unsigned long lowerBegin = 0;
+            for (unsigned long i : grouped) {
+                if (kind[kept[i]] != 2) ++upperColumns;
+                if (kind[kept[i]] == 1) ++lowerBegin;
+            }
+            std::vector<double> compact(n * count);
+            std::vector<double> product(n * count, 0.0);
+            std::vector<const double *> compactRows(n);
+            std::vector<double *> productRows(n);
+            std::vector<const double *> uRows(count);
+            for (unsigned long r = 0; r < n; ++r) {
+                for (unsigned long c = 0; c < count; ++c) {
+                    compact[r * count + c] = block[r * n + kept[grouped[c]]];
+                }
+                compactRows[r] = compact.data() + r * count + (r < m ? 0 : lowerBegin);
+                productRows[r] = product.data() + r * count;
+            }
+            for (unsigned long c = 0; c < count; ++c) {
+                uRows[c] = u.data() + grouped[c] * count;
+            }
+            MultiplyAdd(m, count, upperColumns, 1.0, compactRows.data(), uRows.data(), productRows.data());
+            MultiplyAdd(m2, count, count - lowerBegin, 1.0, compactRows.data() + m, uRows.data() + lowerBegin,
+                        productRows.data() + m);
+
+            // Merge kept roots and deflated eigenvalues, both ascending, into d and q.
+            std::vector<double> values(n);
+            std::vector<const double *> sources(n);
+            std::vector<unsigned long> strides(n);
+            for (unsigned long column = 0, i = 0, t = 0; column < n; ++column) {
+                if (t == deflated.size() or (i < count and roots[i] <= d[deflated[t]])) {
+                    values[column] = roots[i];
+                    sources[column] = product.data() + i;
+                    strides[column] = count;
+                    ++i;
+                } else {
+                    values[column] = d[deflated[t]];
+                    sources[column] = block.data() + deflated[t];
+                    strides[column] = n;
+                    ++t;
+                }
+            }
+            std::copy(values.begin(), values.end(), d);
+            for (unsigned long r = 0; r < n; ++r) {
+                double *row = q + r * n;
+                for (unsigned long column = 0; column < n; ++column) {
+                    row[column] = sources[column][r * strides[column]];
+                }
+            }
+        }
+
+        /*
+         * Number of eigenvalues of the tridiagonal matrix of d and e below x.
+         */
+        unsigned long SturmCount(const double *d, const double *e, unsigned long n, double x, double pivotMinimum) {
+            unsigned long count = 0;
+            double pivot = 1.0;
+            for (unsigned long i = 0; i < n; ++i) {
+                pivot = d[i] - x - (i > 0 ? e[i - 1] * e[i - 1] / pivot : 0.0);
+                if (std::fabs(pivot) < pivotMinimum) pivot = -pivotMinimum;
+                if (pivot < 0) ++count;
+            }
+            return count;
+        }
+
+        /*
+         * Eigenvalues first, ..., first + count - 1 (ascending) of the tridiagonal matrix of d
+         * and e, by bisection on Sturm counts within the Gershgorin bounds.
+         */
+        std::vector<double> Bisection(const double *d, const double *e, unsigned long n, unsigned long first,
+                                      unsigned long count) {
+            double lower = d[0];
+            double upper = d[0];
+            double largestCoupling = 0.0;
+            for (unsigned long i = 0; i < n; ++i) {
+                const double radius = (i > 0 ? std::fabs(e[i - 1]) : 0.0) + (i + 1 < n ? std::fabs(e[i]) : 0.0);
+                lower = std::min(lower, d[i] - radius);
+                upper = std::max(upper, d[i] + radius);
+                if (i + 1 < n) largestCoupling = std::max(largestCoupling, e[i] * e[i]);
+            }
+            const double pivotMinimum = std::numeric_limits<double>::min() * std::max(1.0, largestCoupling);
+            const double margin = 2 * epsilon * std::max(std::fabs(lower), std::fabs(upper)) + pivotMinimum;
+            lower -= margin;
+            upper += margin;
+
+            std::vector<double> values(count);
+            ParallelFor(0, count, [&](unsigned long begin, unsigned long end) {
+                for (unsigned long k = begin; k < end; ++k) {
+                    double low = lower;
+                    double high = upper;
+                    while (high - low > 2 * epsilon * std::max(std::fabs(low), std::fabs(high)) + pivotMinimum) {
+                        const double middle = low + (high - low) / 2;
+                        if (middle <= low or middle >= high) break;
+                        if (SturmCount(d, e, n, middle, pivotMinimum) <= first + k) {
+                            low = middle;
+                        } else {
+                            high = middle;
+                        }
+                    }
+                    values[k] = low + (high - low) / 2;
+                }
+            }, 4);
+            return values;
+        }
+
+        /*
+         * Eigenvectors of the tridiagonal matrix of d and e for ascending eigenvalues, by inverse
+         * iteration with T - lambda I factorized with partial pivoting. Vectors of eigenvalues
+         * closer than 1e-3 |T| are kept orthogonal to each other. Column k of the n x count z.
+         */
+        void InverseIteration(const double *d, const double *e, unsigned long n, const std::vector<double> &values,
+                              double *z) {
+            const unsigned long count = values.size();
+            double norm = 0.0;
+            for (unsigned long i = 0; i < n; ++i) {
+                norm = std::max(norm, std::fabs(d[i]) + (i > 0 ? std::fabs(e[i - 1]) : 0.0) +
+                                      (i + 1 < n ? std::fabs(e[i]) : 0.0));
+            }
+            const double perturbation = std::max(epsilon * norm, std::numeric_limits<double>::min());
+            const double cluster = 1e-3 * norm;
+
+            std::vector<double> lower(n), diagonal(n), upper(n), upper2(n);
+            std::vector<char> swapped(n);
+            std::vector<double> x(n);
+            for (unsigned long k = 0; k < count; ++k) {
+                for (unsigned long i = 0; i < n; ++i) {
+                    diagonal[i] = d[i] - values[k];
+                    if (i + 1 < n) lower[i] = upper[i] = e[i];
+                    upper2[i] = 0.0;
+                }
+                for (unsigned long i = 0; i + 1 < n; ++i) {
+                    if (std::fabs(diagonal[i]) >= std::fabs(lower[i])) {
+                        if (diagonal[i] == 0) diagonal[i] = perturbation;
+                        const double factor = lower[i] / diagonal[i];
+                        lower[i] = factor;
+                        diagonal[i + 1] -= factor * upper[i];
+                        swapped[i] = 0;
+                    } else {
+                        const double factor = diagonal[i] / lower[i];
+                        diagonal[i] = lower[i];
+                        lower[i] = factor;
+                        const double t = upper[i];
+                        upper[i] = diagonal[i + 1];
+                        diagonal[i + 1] = t - factor * diagonal[i + 1];
+                        if (i + 2 < n) {
+                            upper2[i] = upper[i + 1];
+                            upper[i + 1] = -factor * upper[i + 1];
+                        }
+                        swapped[i] = 1;
+                    }
+                }
+                if (diagonal[n - 1] == 0) diagonal[n - 1] = perturbation;
+
+                // Start from a vector unlikely to be orthogonal to the eigenvector.
+                for (unsigned long i = 0; i < n; ++i) {
+                    x[i] = 1.0 + 0.5 * std::sin(static_cast<double>(i * (k + 3) + 1));
+                }
+                unsigned long clusterBegin = k;
+                while (clusterBegin > 0 and values[k] - values[clusterBegin - 1] <= cluster) --clusterBegin;
+
+                for (unsigned int iteration = 0; iteration < 3; ++iteration) {
+                    for (unsigned long i = 0; i + 1 < n; ++i) {
+                        if (swapped[i]) {
+                            const double t = x[i];
+                            x[i] = x[i + 1];
+                            x[i + 1] = t - lower[i] * x[i];
+                        } else {
+                            x[i + 1] -= lower[i] * x[i];
+                        }
+                    }
+                    for (unsigned long i = n; i-- > 0;) {
+                        double sum = x[i];
+                        if (i + 1 < n) sum -= upper[i] * x[i + 1];
+                        if (i + 2 < n) sum -= upper2[i] * x[i + 2];
+                        x[i] = sum / diagonal[i];
+                    }
+                    for (unsigned long j = clusterBegin; j < k; ++j) {
+                        double dot = 0.0;
+                        for (unsigned long i = 0; i < n; ++i) {
+                            dot += z[i * count + j] * x[i];
+                        }
+                        for (unsigned long i = 0; i < n; ++i) {
+                            x[i] -= dot * z[i * count + j];
+                        }
+                    }
+                    double length = 0.0;
+                    for (unsigned long i = 0; i < n; ++i) {
+                        length = std::max(length, std::fabs(x[i]));
+                    }
+                    double sum = 0.0;
+                    for (unsigned long i = 0; i < n; ++i) {
+                        x[i] /= length;
+                        sum += x[i] * x[i];
+                    }
+                    sum = 1 / std::sqrt(sum);
+                    for (unsigned long i = 0; i < n; ++i) {
+                        x[i] *= sum;
+                    }
+                }
+                for (unsigned long i = 0; i < n; ++i) {
+                    z[i * count + k] = x[i];
+                }
+            }
+        }
+
+        vector ToVector(const std::vector<double> &values) {
+            vector Values(values.size(), true);
+            std::copy(values.begin(), values.end(), Values.begin());
+            return Values;
+        }
+
+        matrix ToMatrix(const std::vector<double> &z, unsigned long rows, unsigned long columns) {
+            matrix Z(rows, columns);
+            auto zRows = Z.begin();
+            for (unsigned long r = 0; r < rows; ++r) {
+                std::copy(z.begin() + r * columns, z.begin() + (r + 1) * columns, zRows[r].begin());
+            }
+            return Z;
+        }
+
+        unsigned long FirstExtreme(unsigned long n, unsigned int count, bool largest) {
+            if (count > n) {
+                throw std::invalid_argument("Symmetric eigendecomposition: more eigenvalues requested than the dimension.");
+            }
+            return largest ? n - count : 0;
+        }
+    }
+
+    symmetric_eigen_result SymmetricEigenDecompose(const matrix &A) {
+        tridiagonal_form form = Tridiagonalize(A, true);
+        const unsigned long n = A.rows();
+        std::vector<double> z(n * n);
+        DivideConquer(form.diagonal.data(), form.offDiagonal.data(), n, z.data());
+        BackTransform(form, n, z.data(), n);
+        symmetric_eigen_result result;
+        result.eigenvalues = ToVector(form.diagonal);
+        result.eigenvectors = ToMatrix(z, n, n);
+        return result;
+    }
+
+    symmetric_eigen_result SymmetricEigenDecompose(const matrix &A, unsigned int count, bool largest) {
+        tridiagonal_form form = Tridiagonalize(A, true);
+        const unsigned long n = A.rows();
+        const unsigned long first = FirstExtreme(n, count, largest);
+        std::vector<double> values;
+        std::vector<double> z(n * count);
+        if (count > 0) {
+            values = Bisection(form.diagonal.data(), form.offDiagonal.data(), n, first, count);
+            InverseIteration(form.diagonal.data(), form.offDiagonal.data(), n, values, z.data());
+            BackTransform(form, n, z.data(), count);
+        }
+        symmetric_eigen_result result;
+        result.eigenvalues = ToVector(values);
+        result.eigenvectors = ToMatrix(z, n, count);
+        return result;
+    }
+
+    vector SymmetricEigenvalues(const matrix &A) {
+        tridiagonal_form form = Tridiagonalize(A, false);
+        TridiagonalQL(form.diagonal.data(), form.offDiagonal.data(), A.rows(), nullptr, 0);
+        std::sort(form.diagonal.begin(), form.diagonal.end());
+        return ToVector(form.diagonal);
+    }
+
+    vector SymmetricEigenvalues(const matrix &A, unsigned int count, bool largest) {
+        tridiagonal_form form = Tridiagonalize(A, false);
+        const unsigned long first = FirstExtreme(A.rows(), count, largest);
+        if (count == 0) return vector(0, true);
+        return ToVector(Bisection(form.diagonal.data(), form.offDiagonal.data(), A.rows(), first, count));
+    }
+
+    symmetric_eigen_result SymmetricEigenDecompose(const tridiagonal_matrix &T) {
+        const unsigned long n = T.rows();
+        std::vector<double> d = T.diagonal();
+        std::vector<double> e = T.subdiagonal();
+        e.push_back(0.0);
+        std::vector<double> z(n * n);
+        DivideConquer(d.data(), e.data(), n, z.data());
+        symmetric_eigen_result result;
+        result.eigenvalues = ToVector(d);
+        result.eigenvectors = ToMatrix(z, n, n);
+        return result;
+    }
+
+    vector SymmetricEigenvalues(const tridiagonal_matrix &T) {
+        std::vector<double> d = T.diagonal();
+        std::vector<double> e = T.subdiagonal();
+        e.push_back(0.0);
+        TridiagonalQL(d.data(), e.data(), d.size(), nullptr, 0);
+        std::sort(d.begin(), d.end());
+        return ToVector(d);
+    }
+
+    symmetric_eigen_result SymmetricEigenDecompose(const tridiagonal_matrix &T, unsigned int count, bool largest) {
+        const unsigned long n = T.rows();
+        const unsigned long first = FirstExtreme(n, count, largest);
+        const std::vector<double> &d = T.diagonal();
+        std::vector<double> e = T.subdiagonal();
+        e.push_back(0.0);
+        std::vector<double> values;
+        std::vector<double> z(n * count);
+        if (count > 0) {
+            values = Bisection(d.data(), e.data(), n, first, count);
+            InverseIteration(d.data(), e.data(), n, values, z.data());
+        }
+        symmetric_eigen_result result;
+        result.eigenvalues = ToVector(values);
+        result.eigenvectors = ToMatrix(z, n, count);
+        return result;
+    }
+}
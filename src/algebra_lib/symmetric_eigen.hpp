@@ -0,0 +1,85 @@
+/*! \file symmetric_eigen.hpp
+ * \brief Eigenvalues and eigenvectors of dense symmetric and of tridiagonal matrices.
+ *
+ * A symmetric matrix is first reduced to tridiagonal form \f$ A = Q T Q^T \f$ by Householder
+ * reflections, which holds most of the \f$ O(n^3) \f$ work of finding eigenvalues only.
+ * T is then solved by divide and conquer: halves are split off by a rank one tear, solved
+ * recursively (in parallel at the top), and merged through the secular equation, with
+ * eigenvectors that are orthogonal by construction (Gu and Eisenstat). Merging multiplies
+ * the eigenvectors of the halves by those of the rank one problem, and the reflections are
+ * applied to the eigenvectors of T in blocks of compact WY form, so both are products
+ * through MultiplyAdd.
+ *
+ * Without eigenvectors, T is solved by implicit QL in \f$ O(n^2) \f$. A few extreme
+ * eigenpairs are found by bisection on Sturm counts and inverse iteration on T, and only
+ * their eigenvectors are transformed back.
+ *
+ * Eigenvalues are always returned in ascending order, and column j of the eigenvectors
+ * belongs to eigenvalue j. Only the lower triangle of a dense A is read.
+ */
+
+#ifndef LINEARALGEBRA_SYMMETRICEIGEN_HPP
+#define LINEARALGEBRA_SYMMETRICEIGEN_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "tridiagonal_matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Eigenvalues, ascending, and the orthonormal eigenvectors in the columns of a matrix.
+     */
+    struct symmetric_eigen_result {
+        vector eigenvalues;
+        matrix eigenvectors;
+    };
+
+    /*!
+     * \brief All eigenvalues and eigenvectors of a symmetric matrix.
+     * @throw std::length_error A is not square.
+     * @throw std::domain_error The iteration on a small tridiagonal block doesn't converge.
+     */
+    symmetric_eigen_result SymmetricEigenDecompose(const matrix &A);
+
+    /*!
+     * \brief The count smallest or largest eigenvalues of a symmetric matrix, with their eigenvectors.
+     * @throw std::length_error A is not square.
+     * @throw std::invalid_argument count exceeds the dimension of A.
+     */
+    symmetric_eigen_result SymmetricEigenDecompose(const matrix &A, unsigned int count, bool largest);
+
+    /*!
+     * \brief All eigenvalues of a symmetric matrix.
+     * @throw std::length_error A is not square.
+     * @throw std::domain_error The QL iteration doesn't converge.
+     */
+    vector SymmetricEigenvalues(const matrix &A);
+
+    /*!
+     * \brief The count smallest or largest eigenvalues of a symmetric matrix.
+     * @throw std::length_error A is not square.
+     * @throw std::invalid_argument count exceeds the dimension of A.
+     */
+    vector SymmetricEigenvalues(const matrix &A, unsigned int count, bool largest);
+
+    /*!
+     * \brief All eigenvalues and eigenvectors of a symmetric tridiagonal matrix, read from its diagonal and subdiagonal.
+     * @throw std::domain_error The iteration on a small tridiagonal block doesn't converge.
+     */
+    symmetric_eigen_result SymmetricEigenDecompose(const tridiagonal_matrix &T);
+
+    /*!
+     * \brief All eigenvalues of a symmetric tridiagonal matrix, read from its diagonal and subdiagonal.
+     * @throw std::domain_error The QL iteration doesn't converge.
+     */
+    vector SymmetricEigenvalues(const tridiagonal_matrix &T);
+
+    /*!
+     * \brief The count smallest or largest eigenpairs of a symmetric tridiagonal matrix, by bisection and inverse iteration.
+     * @throw std::invalid_argument count exceeds the dimension of T.
+     */
+    symmetric_eigen_result SymmetricEigenDecompose(const tridiagonal_matrix &T, unsigned int count, bool largest);
+}
+
+#endif //LINEARALGEBRA_SYMMETRICEIGEN_HPP
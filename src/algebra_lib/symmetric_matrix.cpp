@@ -0,0 +1,148 @@
+#include <cmath>
+#include "symmetric_matrix.hpp"
+
+namespace algebra_lib {
+    symmetric_matrix::symmetric_matrix(unsigned long dimension)
+            : _dimension(dimension), _packed(dimension * (dimension + 1) / 2, 0.0) {}
+
+    symmetric_matrix::symmetric_matrix(const matrix &A) : symmetric_matrix(A.rows()) {
+        if (A.rows() != A.columns()) {
+            throw std::length_error("Symmetric matrix: matrix is not square.");
+        }
+        auto packed = _packed.begin();
+        for (unsigned long row = 0; row < _dimension; ++row) {
+            auto a = A[row].begin();
+            packed = std::copy(a, a + row + 1, packed);
+        }
+    }
+
+    double &symmetric_matrix::operator()(unsigned long row, unsigned long column) {
+        if (row < column) std::swap(row, column);
+        if (row >= _dimension) {
+            throw std::out_of_range("Exceeded matrix bounds");
+        }
+        return _packed[row * (row + 1) / 2 + column];
+    }
+
+    double symmetric_matrix::operator()(unsigned long row, unsigned long column) const {
+        if (row < column) std::swap(row, column);
+        if (row >= _dimension) {
+            throw std::out_of_range("Exceeded matrix bounds");
+        }
+        return _packed[row * (row + 1) / 2 + column];
+    }
+
+    matrix symmetric_matrix::ToFull() const {
+        matrix Full(_dimension, _dimension);
+        auto rows = Full.begin();
+        const double *packed = _packed.data();
+        for (unsigned long row = 0; row < _dimension; ++row, packed += row) {
+            auto full = rows[row].begin();
+            for (unsigned long column = 0; column <= row; ++column) {
+                full[column] = packed[column];
+                rows[column].begin()[row] = packed[column];
+            }
+        }
+        return Full;
+    }
+
+    matrix symmetric_matrix::CholeskyDecompose() const {
+        // Row by row in packed storage, so both rows in every dot product are contiguous.
+        std::vector<double> factor(_packed.size());
+        for (unsigned long row = 0; row < _dimension; ++row) {
+            double *l = factor.data() + row * (row + 1) / 2;
+            const double *a = _packed.data() + row * (row + 1) / 2;
+            for (unsigned long column = 0; column <= row; ++column) {
+                const double *lColumn = factor.data() + column * (column + 1) / 2;
+                double sum = a[column];
+                for (unsigned long k = 0; k < column; ++k) {
+                    sum -= l[k] * lColumn[k];
+                }
+                if (column < row) {
+                    l[column] = sum / lColumn[column];
+                } else if (sum > 0) {
+                    l[column] = sqrt(sum);
+                } else {
+                    throw std::domain_error("Cholesky decomposition: matrix is not positive definite.");
+                }
+            }
+        }
+
+        matrix LowerCholesky(_dimension, _dimension);
+        auto rows = LowerCholesky.begin();
+        for (unsigned long row = 0; row < _dimension; ++row) {
+            const double *l = factor.data() + row * (row + 1) / 2;
+            std::copy(l, l + row + 1, rows[row].begin());
+        }
+        return LowerCholesky;
+    }
+
+    vector operator*(const symmetric_matrix &A, const vector &U) {
+        if (A.columns() != U.size()) {
+            throw std::length_error(
+                    "Left multiplication with matrix: vector and matrix are not compatible in dimension");
+        } else if (!U.isColumn()) {
+            throw std::invalid_argument(
+                    "Left multiplication with matrix: vector is not a column vector! First transpose it for goodness' sake.");
+        }
+
+        // Every stored a_ij, j < i, adds a_ij u_j to y_i and a_ij u_i to y_j.
+        vector Product(A.rows(), true);
+        auto y = Product.begin();
+        auto u = U.begin();
+        const double *a = A.packed().data();
+        for (unsigned long i = 0; i < A.rows(); ++i, a += i) {
+            double ui = u[i];
+            double sum = 0.0;
+            for (unsigned long j = 0; j < i; ++j) {
+                sum += a[j] * u[j];
+                y[j] += a[j] * ui;
+            }
+            y[i] += sum + a[i] * ui;
+        }
+        return Product;
+    }
+
+    matrix operator*(const symmetric_matrix &A, const matrix &B) {
+        if (A.columns() != B.rows()) {
+            throw std::length_error("matrix multiplication: matrices are not compatible in dimension");
+        }
+
+        // Every stored a_ij, j < i, adds a_ij times row j of B to row i of the product,
+        // and a_ij times row i of B to row j.
+        matrix Product(A.rows(), B.columns());
+        auto rows = Product.begin();
+        const double *a = A.packed().data();
+        for (unsigned long i = 0; i < A.rows(); ++i, a += i) {
+            auto bi = B[i].begin();
+            auto ci = rows[i].begin();
+            for (unsigned long j = 0; j < i; ++j) {
+                double aij = a[j];
+                if (aij == 0) continue;
+                auto bj = B[j].begin();
+                auto cj = rows[j].begin();
+                for (unsigned long column = 0; column < B.columns(); ++column) {
+                    ci[column] += aij * bj[column];
+                    cj[column] += aij * bi[column];
+                }
+            }
+            for (unsigned long column = 0; column < B.columns(); ++column) {
+                ci[column] += a[i] * bi[column];
+            }
+        }
+        return Product;
+    }
+
+    std::ostream &operator<<(std::ostream &stream, const symmetric_matrix &A) {
+        stream << "Symmetric matrix of dimension " << A.rows() << "x" << A.columns()
+               << ", lower triangle:" << std::endl;
+        for (unsigned long row = 0; row < A.rows(); ++row) {
+            stream << "row\t" << row + 1 << "\t|\t";
+            for (unsigned long column = 0; column <= row; ++column) {
+                stream << A(row, column) << "\t";
+            }
+            stream << std::endl;
+        }
+        return stream;
+    }
+}
@@ -0,0 +1,95 @@
+/*! \file symmetric_matrix.hpp
+ * \brief Full symmetric matrices in packed lower triangular storage.
+ *
+ * Entry \f$ (i, j) \f$ with \f$ j \leq i \f$ lives at \f$ i (i + 1) / 2 + j \f$ of one
+ * contiguous array, so every row of the lower triangle is contiguous and the matrix takes
+ * \f$ n (n + 1) / 2 \f$ doubles instead of \f$ n^2 \f$.
+ */
+
+#ifndef LINEARALGEBRA_SYMMETRICMATRIX_HPP
+#define LINEARALGEBRA_SYMMETRICMATRIX_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Class for full symmetric matrices, stored as their packed lower triangle.
+     */
+    class symmetric_matrix {
+    public:
+        // Constructors
+        /*!
+         * \brief Zero matrix.
+         * @param dimension Rows and columns of the matrix.
+         */
+        explicit symmetric_matrix(unsigned long dimension = 0);
+
+        /*!
+         * \brief Symmetric matrix from the lower triangle of A. Entries above the diagonal are ignored.
+         * @throw std::length_error A is not square.
+         */
+        explicit symmetric_matrix(const matrix &A);
+
+        // Member functions
+        unsigned long rows() const { return _dimension; }
+
+        unsigned long columns() const { return _dimension; }
+
+        /*!
+         * \brief Entry (row, column), which is the same entry as (column, row).
+         * @throw std::out_of_range Entry outside matrix.
+         */
+        double &operator()(unsigned long row, unsigned long column);
+
+        /*!
+         * \brief Entry (row, column), which is the same entry as (column, row).
+         * @throw std::out_of_range Entry outside matrix.
+         */
+        double operator()(unsigned long row, unsigned long column) const;
+
+        /*!
+         * \brief Packed lower triangle, row by row.
+         */
+        const std::vector<double> &packed() const { return _packed; }
+
+        /*!
+         * \brief Matrix with both triangles stored.
+         */
+        matrix ToFull() const;
+
+        /*!
+         * \brief Lower triangular Cholesky factor L, with \f$ A = L L^T \f$.
+         * @throw std::domain_error Matrix is not positive definite.
+         */
+        matrix CholeskyDecompose() const;
+
+    private:
+        unsigned long _dimension;
+        std::vector<double> _packed;
+    };
+
+    /**
+     *  \brief Symmetric matrix vector product, reading every stored entry once.
+     * @param A \f$ n \times n \f$ symmetric matrix
+     * @param U \f$ n \times 1 \f$ (column) vector
+     * @return \f$ n \times 1 \f$ (column) vector
+     * @throw std::length_error A and U are not of compatible dimension.
+     * @throw std::invalid_argument U is not a column vector.
+     */
+    vector operator*(const symmetric_matrix &A, const vector &U);
+
+    /**
+     *  \brief Symmetric matrix matrix product, reading every stored entry of A once.
+     * @param A \f$ n \times n \f$ symmetric matrix
+     * @param B \f$ n \times l \f$ matrix
+     * @return \f$ n \times l \f$ matrix
+     * @throw std::length_error A and B are not of compatible dimension.
+     */
+    matrix operator*(const symmetric_matrix &A, const matrix &B);
+
+    std::ostream &operator<<(std::ostream &stream, const symmetric_matrix &A);
+}
+
+#endif //LINEARALGEBRA_SYMMETRICMATRIX_HPP
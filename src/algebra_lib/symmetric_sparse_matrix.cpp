@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <cmath>
+#include "parallel.hpp"
+#include "sparse_algebra.hpp"
+#include "symmetric_sparse_matrix.hpp"
+
+namespace algebra_lib {
+    symmetric_sparse_matrix::symmetric_sparse_matrix(unsigned int dimension) : _lower(dimension, dimension) {}
+
+    symmetric_sparse_matrix::symmetric_sparse_matrix(const sparse_matrix &A) : _lower(A.rows(), A.columns()) {
+        if (A.rows() != A.columns()) {
+            throw std::length_error("Symmetric matrix: matrix is not square.");
+        }
+        for (auto const &row : A) {
+            sparse_vector Row(columns(), false);
+            for (auto const &entry : row.second) {
+                if (entry.first > row.first) break;
+                Row.Append(entry.first, entry.second);
+            }
+            if (Row.nonZeros() > 0)
+                _lower.AppendRow(row.first, std::move(Row));
+        }
+    }
+
+    double symmetric_sparse_matrix::operator()(unsigned int row, unsigned int column) const {
+        if (row < column) std::swap(row, column);
+        return _lower[row][column];
+    }
+
+    void symmetric_sparse_matrix::Set(unsigned int row, unsigned int column, double value) {
+        if (row < column) std::swap(row, column);
+        if (value != 0) {
+            _lower(row)(column) = value;
+        } else if (row >= rows()) {
+            throw std::out_of_range("Exceeded number of rows");
+        } else if (_lower[row].nonZeros() > 0) {
+            _lower(row).eraseEntry(column);
+        }
+    }
+
+    unsigned long symmetric_sparse_matrix::nonZeros() const {
+        unsigned long nonZeros = 0;
+        for (auto const &row : _lower) {
+            nonZeros += row.second.nonZeros();
+        }
+        return nonZeros;
+    }
+
+    sparse_matrix symmetric_sparse_matrix::ToSparse() const {
+        sparse_matrix Upper = _lower.Transpose();
+        sparse_matrix Full(rows(), columns());
+        for (unsigned int row = 0; row < rows(); ++row) {
+            const sparse_vector Lower = _lower[row];
+            const sparse_vector Strict = Upper[row];
+            sparse_vector Row(columns(), false);
+            Row.Reserve(Lower.nonZeros() + Strict.nonZeros());
+            for (auto const &entry : Lower) {
+                Row.Append(entry.first, entry.second);
+            }
+            for (auto const &entry : Strict) {
+                if (entry.first > row) Row.Append(entry.first, entry.second);
+            }
+            if (Row.nonZeros() > 0)
+                Full.AppendRow(row, std::move(Row));
+        }
+        return Full;
+    }
+
+    sparse_matrix symmetric_sparse_matrix::CholeskyDecompose() const {
+        const unsigned int n = rows();
+        std::vector<const sparse_vector *> lowerRows(n, nullptr);
+        for (auto const &row : _lower) {
+            lowerRows[row.first] = &row.second;
+        }
+
+        // Elimination tree, built row by row along with the factor.
+        std::vector<int> parent(n, -1);
+        std::vector<int> ancestor(n, -1);
+        // Columns of L below the diagonal, needed for the updates of later rows.
+        std::vector<std::vector<std::pair<unsigned int, double>>> factorColumns(n);
+        std::vector<double> diagonal(n, 0.0);
+        std::vector<double> work(n, 0.0);
+        std::vector<unsigned int> mark(n, n);
+        std::vector<unsigned int> pattern(n);
+        std::vector<std::pair<unsigned int, double>> rowEntries;
+
+        sparse_matrix L(n, n);
+        for (unsigned int k = 0; k < n; ++k) {
+            double d = 0.0;
+            unsigned int top = n;
+            mark[k] = k;
+            if (lowerRows[k] != nullptr) {
+                for (auto const &entry : *lowerRows[k]) {
+                    unsigned int i = entry.first;
+                    if (i == k) {
+                        d = entry.second;
+                        continue;
+                    }
+                    // Extend the elimination tree with row k, compressing paths as we go.
+                    for (int node = static_cast<int>(i); node != -1 and node < static_cast<int>(k);) {
+                        int next = ancestor[node];
+                        ancestor[node] = k;
+                        if (next == -1) parent[node] = k;
+                        node = next;
+                    }
+
+                    // The pattern of row k of L is the union of the tree paths from i up to k.
+                    work[i] = entry.second;
+                    unsigned int length = 0;
+                    for (int node = static_cast<int>(i); mark[node] != k; node = parent[node]) {
+                        pattern[length++] = static_cast<unsigned int>(node);
+                        mark[node] = k;
+                    }
+                    while (length > 0) {
+                        pattern[--top] = pattern[--length];
+                    }
+                }
+            }
+
+            // Sparse triangular solve for row k, in topological order of the pattern.
+            rowEntries.clear();
+            for (; top < n; ++top) {
+                unsigned int i = pattern[top];
+                double lki = work[i] / diagonal[i];
+                work[i] = 0.0;
+                for (auto const &entry : factorColumns[i]) {
+                    work[entry.first] -= entry.second * lki;
+                }
+                d -= lki * lki;
+                factorColumns[i].emplace_back(k, lki);
+                rowEntries.emplace_back(i, lki);
+            }
+            if (!(d > 0)) {
+                throw std::domain_error("Cholesky decomposition: matrix is not positive definite.");
+            }
+            diagonal[k] = sqrt(d);
+
+            std::sort(rowEntries.begin(), rowEntries.end());
+            sparse_vector Row(n, false);
+            Row.Reserve(static_cast<unsigned int>(rowEntries.size() + 1));
+            for (auto const &entry : rowEntries) {
+                Row.Append(entry.first, entry.second);
+            }
+            Row.Append(k, diagonal[k]);
+            L.AppendRow(k, std::move(Row));
+        }
+        return L;
+    }
+
+    vector operator*(const symmetric_sparse_matrix &A, const vector &U) {
+        if (A.columns() != U.size()) {
+            throw std::length_error(
+                    "Left multiplication with matrix: vector and matrix are not compatible in dimension");
+        } else if (!U.isColumn()) {
+            throw std::invalid_argument(
+                    "Left multiplication with matrix: vector is not a column vector! First transpose it for goodness' sake.");
+        }
+
+        std::vector<std::pair<unsigned int, const sparse_vector *>> storedRows;
+        for (auto const &row : A.lower()) {
+            storedRows.emplace_back(row.first, &row.second);
+        }
+
+        // Every stored a_ij adds to both y_i and y_j. Parts of the rows write y_j for j < i
+        // to their own accumulator, the first part straight into the product. Accumulators
+        // are zeroed by their own part and summed in parallel over ranges of entries.
+        unsigned long parts = std::max(1ul, std::min(static_cast<unsigned long>(ParallelThreads()),
+                                                     static_cast<unsigned long>(storedRows.size() / 1024)));
+        vector Product(A.rows(), true);
+        if (A.rows() == 0) return Product;
+        auto product = Product.begin();
+        std::vector<std::vector<double>> accumulators(parts - 1);
+        auto u = U.begin();
+        ParallelFor(0, parts, [&](unsigned long first, unsigned long last) {
+            for (unsigned long part = first; part < last; ++part) {
+                double *y = &product[0];
+                if (part > 0) {
+                    accumulators[part - 1].assign(A.rows(), 0.0);
+                    y = accumulators[part - 1].data();
+                }
+                for (std::size_t row = storedRows.size() * part / parts;
+                     row < storedRows.size() * (part + 1) / parts; ++row) {
+                    unsigned int i = storedRows[row].first;
+                    double ui = u[i];
+                    double sum = 0.0;
+                    for (auto const &entry : *storedRows[row].second) {
+                        sum += entry.second * u[entry.first];
+                        if (entry.first != i) y[entry.first] += entry.second * ui;
+                    }
+                    y[i] += sum;
+                }
+            }
+        });
+
+        if (!accumulators.empty()) {
+            ParallelFor(0, A.rows(), [&](unsigned long first, unsigned long last) {
+                for (auto const &y : accumulators) {
+                    for (unsigned long i = first; i < last; ++i) {
+                        product[i] += y[i];
+                    }
+                }
+            }, 4096);
+        }
+        return Product;
+    }
+
+    sparse_vector operator*(const symmetric_sparse_matrix &A, const sparse_vector &U) {
+        if (A.columns() != U.size()) {
+            throw std::length_error(
+                    "Left multiplication with matrix: vector and matrix are not compatible in dimension");
+        } else if (!U.isColumn()) {
+            throw std::invalid_argument(
+                    "Left multiplication with matrix: vector is not a column vector! First transpose it for goodness' sake.");
+        }
+
+        // y = L u + (L - D)^T u. The first term needs every stored row against u, the
+        // second only the rows where u is stored.
+        std::vector<double> y(A.rows(), 0.0);
+        auto entryU = U.begin();
+        for (auto const &row : A.lower()) {
+            y[row.first] += row.second * U;
+            while (entryU != U.end() and entryU->first < row.first) ++entryU;
+            if (entryU != U.end() and entryU->first == row.first) {
+                for (auto const &entry : row.second) {
+                    if (entry.first != row.first) y[entry.first] += entry.second * entryU->second;
+                }
+            }
+        }
+
+        sparse_vector Product(A.rows(), true);
+        for (unsigned int i = 0; i < A.rows(); ++i) {
+            if (y[i] != 0) Product.Append(i, y[i]);
+        }
+        return Product;
+    }
+
+    std::ostream &operator<<(std::ostream &stream, const symmetric_sparse_matrix &A) {
+        stream << "Symmetric sparse matrix of dimension " << A.rows() << "x" << A.columns()
+               << ", lower triangle:" << std::endl;
+        stream << A.lower();
+        return stream;
+    }
+}
@@ -0,0 +1,104 @@
+/*! \file symmetric_sparse_matrix.hpp
+ * \brief Sparse symmetric matrices storing only their lower triangle.
+ *
+ * Covariance and mass matrices are symmetric, so storing both triangles doubles their
+ * memory and the memory traffic of every product. symmetric_sparse_matrix stores entry
+ * \f$ (i, j) \f$ only for \f$ j \leq i \f$, and its kernels use every stored off-diagonal
+ * entry for both triangles.
+ */
+
+#ifndef LINEARALGEBRA_SYMMETRICSPARSEMATRIX_HPP
+#define LINEARALGEBRA_SYMMETRICSPARSEMATRIX_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "sparse_vector.hpp"
+#include "sparse_matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Class for sparse symmetric matrices, stored as their lower triangle.
+     */
+    class symmetric_sparse_matrix {
+    public:
+        // Constructors
+        /*!
+         * \brief Zero matrix.
+         * @param dimension Rows and columns of the matrix.
+         */
+        explicit symmetric_sparse_matrix(unsigned int dimension = 0);
+
+        /*!
+         * \brief Symmetric matrix from the lower triangle of A. Entries above the diagonal are ignored.
+         * @throw std::length_error A is not square.
+         */
+        explicit symmetric_sparse_matrix(const sparse_matrix &A);
+
+        // Member functions
+        unsigned int rows() const { return _lower.rows(); }
+
+        unsigned int columns() const { return _lower.columns(); }
+
+        /*!
+         * \brief Entry (row, column), read from the lower triangle.
+         */
+        double operator()(unsigned int row, unsigned int column) const;
+
+        /*!
+         * \brief Set entries (row, column) and (column, row).
+         */
+        void Set(unsigned int row, unsigned int column, double value);
+
+        /*!
+         * \brief Stored lower triangle, diagonal included.
+         */
+        const sparse_matrix &lower() const { return _lower; }
+
+        /*!
+         * \brief Number of stored entries, in the lower triangle.
+         */
+        unsigned long nonZeros() const;
+
+        /*!
+         * \brief Matrix with both triangles stored.
+         */
+        sparse_matrix ToSparse() const;
+
+        /*!
+         * \brief Lower triangular Cholesky factor L, with \f$ A = L L^T \f$.
+         *
+         * Up-looking factorization: row k of L is found by a sparse triangular solve with
+         * the rows above it, whose pattern follows from the elimination tree. Only entries
+         * that are structurally non-zero in L are ever computed.
+         * @throw std::domain_error Matrix is not positive definite.
+         */
+        sparse_matrix CholeskyDecompose() const;
+
+    private:
+        sparse_matrix _lower;
+    };
+
+    /**
+     *  \brief Symmetric matrix vector product, reading every stored entry once.
+     * @param A \f$ n \times n \f$ symmetric sparse matrix
+     * @param U \f$ n \times 1 \f$ (column) vector
+     * @return \f$ n \times 1 \f$ (column) vector
+     * @throw std::length_error A and U are not of compatible dimension.
+     * @throw std::invalid_argument U is not a column vector.
+     */
+    vector operator*(const symmetric_sparse_matrix &A, const vector &U);
+
+    /**
+     *  \brief Symmetric matrix vector product, reading every stored entry once.
+     * @param A \f$ n \times n \f$ symmetric sparse matrix
+     * @param U \f$ n \times 1 \f$ sparse (column) vector
+     * @return \f$ n \times 1 \f$ sparse (column) vector
+     * @throw std::length_error A and U are not of compatible dimension.
+     * @throw std::invalid_argument U is not a column vector.
+     */
+    sparse_vector operator*(const symmetric_sparse_matrix &A, const sparse_vector &U);
+
+    std::ostream &operator<<(std::ostream &stream, const symmetric_sparse_matrix &A);
+}
+
+#endif //LINEARALGEBRA_SYMMETRICSPARSEMATRIX_HPP
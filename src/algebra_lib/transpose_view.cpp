@@ -0,0 +1,210 @@
+#include <algorithm>
+#include "parallel.hpp"
+#include "sparse_builder.hpp"
+#include "transpose_view.hpp"
+
+namespace algebra_lib {
+    sparse_matrix_transpose TransposeView(const sparse_matrix &A) {
+        return sparse_matrix_transpose(A);
+    }
+
+    matrix_transpose TransposeView(const matrix &A) {
+        return matrix_transpose(A);
+    }
+
+    vector operator*(const sparse_matrix_transpose &At, const vector &U) {
+        if (At.columns() != U.size()) {
+            throw std::length_error(
+                    "Left multiplication with matrix: vector and matrix are not compatible in dimension");
+        } else if (!U.isColumn()) {
+            throw std::invalid_argument(
+                    "Left multiplication with matrix: vector is not a column vector! First transpose it for goodness' sake.");
+        }
+
+        // Row i of A is column i of At, scatter it scaled by u_i.
+        vector Product(At.rows(), true);
+        auto product = Product.begin();
+        auto u = U.begin();
+        for (auto const &row : At.original()) {
+            double factor = u[row.first];
+            if (factor == 0) continue;
+            for (auto const &entry : row.second) {
+                product[entry.first] += factor * entry.second;
+            }
+        }
+        return Product;
+    }
+
+    sparse_vector operator*(const sparse_matrix_transpose &At, const sparse_vector &U) {
+        if (At.columns() != U.size()) {
+            throw std::length_error(
+                    "Left multiplication with matrix: vector and matrix are not compatible in dimension");
+        } else if (!U.isColumn()) {
+            throw std::invalid_argument(
+                    "Left multiplication with matrix: vector is not a column vector! First transpose it for goodness' sake.");
+        }
+
+        // Scatter into a full accumulator, remembering which entries were touched.
+        std::vector<double> accumulator(At.rows(), 0.0);
+        std::vector<unsigned int> touched;
+        const sparse_matrix &A = At.original();
+        auto row = A.begin();
+        for (auto const &entryU : U) {
+            while (row != A.end() and row->first < entryU.first) ++row;
+            if (row == A.end()) break;
+            if (row->first != entryU.first) continue;
+            for (auto const &entry : row->second) {
+                if (accumulator[entry.first] == 0) touched.push_back(entry.first);
+                accumulator[entry.first] += entryU.second * entry.second;
+            }
+        }
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+        sparse_vector Product(At.rows(), true);
+        Product.Reserve(static_cast<unsigned int>(touched.size()));
+        for (unsigned int index : touched) {
+            if (accumulator[index] != 0)
+                Product.Append(index, accumulator[index]);
+        }
+        return Product;
+    }
+
+    vector operator*(const vector &U, const sparse_matrix_transpose &At) {
+        if (At.rows() != U.size()) {
+            throw std::length_error(
+                    "Right multiplication with matrix: vector and matrix are not compatible in dimension");
+        } else if (U.isColumn()) {
+            throw std::invalid_argument(
+                    "Right multiplication with matrix: vector is not a row vector! First transpose it for goodness' "
+                            "sake.");
+        }
+
+        // Entry i of the product is row i of A dotted with u.
+        vector Product(At.columns(), false);
+        auto product = Product.begin();
+        auto u = U.begin();
+        for (auto const &row : At.original()) {
+            double sum = 0.0;
+            for (auto const &entry : row.second) {
+                sum += entry.second * u[entry.first];
+            }
+            product[row.first] = sum;
+        }
+        return Product;
+    }
+
+    sparse_matrix operator*(const sparse_matrix_transpose &At, const sparse_matrix &B) {
+        if (At.columns() != B.rows()) {
+            throw std::length_error("Matrix multiplication: matrices are not compatible in dimension");
+        }
+
+        // A^T B is the sum over k of (row k of A)^T (row k of B). Pair up the stored rows,
+        // and let every part of them add its outer products to its own builder slot.
+        const sparse_matrix &A = At.original();
+        std::vector<std::pair<const sparse_vector *, const sparse_vector *>> pairs;
+        auto rowB = B.begin();
+        for (auto const &rowA : A) {
+            while (rowB != B.end() and rowB->first < rowA.first) ++rowB;
+            if (rowB == B.end()) break;
+            if (rowB->first == rowA.first)
+                pairs.emplace_back(&rowA.second, &rowB->second);
+        }
+
+        unsigned int parts = std::max(1u, std::min(ParallelThreads(), static_cast<unsigned int>(pairs.size())));
+        sparse_matrix_builder Builder(At.rows(), B.columns(), parts);
+        ParallelFor(0, parts, [&](unsigned long first, unsigned long last) {
+            for (unsigned long part = first; part < last; ++part) {
+                unsigned int slot = static_cast<unsigned int>(part);
+                std::size_t begin = pairs.size() * part / parts;
+                std::size_t end = pairs.size() * (part + 1) / parts;
+                for (std::size_t pair = begin; pair < end; ++pair) {
+                    for (auto const &entryA : *pairs[pair].first) {
+                        for (auto const &entryB : *pairs[pair].second) {
+                            Builder.Add(entryA.first, entryB.first, entryA.second * entryB.second, slot);
+                        }
+                    }
+                }
+            }
+        });
+        return Builder.Build();
+    }
+
+    vector operator*(const matrix_transpose &At, const vector &U) {
+        if (At.columns() != U.size()) {
+            throw std::length_error(
+                    "Left multiplication with matrix: vector and matrix are not compatible in dimension");
+        } else if (!U.isColumn()) {
+            throw std::invalid_argument(
+                    "Left multiplication with matrix: vector is not a column vector! First transpose it for goodness' sake.");
+        }
+
+        // Sum of the rows of A scaled by the entries of u, reading A row by row.
+        vector Product(At.rows(), true);
+        auto product = Product.begin();
+        auto u = U.begin();
+        unsigned long rowIndex = 0;
+        for (auto const &row : At.original()) {
+            double factor = u[rowIndex++];
+            if (factor == 0) continue;
+            auto a = row.begin();
+            for (unsigned long column = 0; column < At.rows(); ++column) {
+                product[column] += factor * a[column];
+            }
+        }
+        return Product;
+    }
+
+    matrix operator*(const matrix_transpose &At, const matrix &B) {
+        if (At.columns() != B.rows()) {
+            throw std::length_error("matrix multiplication: matrices are not compatible in dimension");
+        }
+
+        // Row i of the product is the sum over k of A[k][i] times row k of B. Every chunk
+        // of product rows streams through all rows of A and B.
+        const matrix &A = At.original();
+        matrix Product(At.rows(), B.columns());
+        auto productRows = Product.begin();
+        ParallelFor(0, At.rows(), [&](unsigned long first, unsigned long last) {
+            for (unsigned long k = 0; k < A.rows(); ++k) {
+                auto a = A[k].begin();
+                auto b = B[k].begin();
+                for (unsigned long i = first; i < last; ++i) {
+                    double factor = a[i];
+                    if (factor == 0) continue;
+                    auto product = productRows[i].begin();
+                    for (unsigned long j = 0; j < B.columns(); ++j) {
+                        product[j] += factor * b[j];
+                    }
+                }
+            }
+        });
+        return Product;
+    }
+
+    matrix operator*(const matrix &A, const matrix_transpose &Bt) {
+        if (A.columns() != Bt.rows()) {
+            throw std::length_error("matrix multiplication: matrices are not compatible in dimension");
+        }
+
+        // Entry (i, j) of the product is row i of A dotted with row j of B.
+        const matrix &B = Bt.original();
+        matrix Product(A.rows(), Bt.columns());
+        auto productRows = Product.begin();
+        ParallelFor(0, A.rows(), [&](unsigned long first, unsigned long last) {
+            for (unsigned long i = first; i < last; ++i) {
+                auto a = A[i].begin();
+                auto product = productRows[i].begin();
+                for (unsigned long j = 0; j < B.rows(); ++j) {
+                    auto b = B[j].begin();
+                    double sum = 0.0;
+                    for (unsigned long k = 0; k < A.columns(); ++k) {
+                        sum += a[k] * b[k];
+                    }
+                    product[j] = sum;
+                }
+            }
+        });
+        return Product;
+    }
+}
@@ -0,0 +1,162 @@
+/*! \file transpose_view.hpp
+ * \brief Transposed matrices without materializing them.
+ *
+ * Most transposes in our code only serve products like \f$ A^T x \f$ or \f$ A^T B \f$.
+ * TransposeView wraps a matrix without copying its entries, and the products below
+ * read the rows of A directly: a row of A is a column of \f$ A^T \f$, so \f$ A^T x \f$
+ * scatters row \f$ i \f$ of A scaled by \f$ x_i \f$ into the result. This costs the same
+ * as \f$ A x \f$ and allocates nothing besides the result.
+ *
+ * A view holds a copy of the matrix, which shares its storage (see sparse_matrix), so it
+ * stays valid when the original goes out of scope, and doesn't see later modifications.
+ */
+
+#ifndef LINEARALGEBRA_TRANSPOSEVIEW_HPP
+#define LINEARALGEBRA_TRANSPOSEVIEW_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "sparse_vector.hpp"
+#include "sparse_matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Transpose of a sparse matrix, read through the rows of the original.
+     */
+    class sparse_matrix_transpose {
+    public:
+        explicit sparse_matrix_transpose(const sparse_matrix &A) : _matrix(A) {}
+
+        unsigned int rows() const { return _matrix.columns(); }
+
+        unsigned int columns() const { return _matrix.rows(); }
+
+        /*!
+         * \brief The matrix being transposed.
+         */
+        const sparse_matrix &original() const { return _matrix; }
+
+        /*!
+         * \brief Transpose of the view, which is the original matrix. Costs \f$ O(1) \f$.
+         */
+        const sparse_matrix &Transpose() const { return _matrix; }
+
+        /*!
+         * \brief Build the transposed matrix.
+         */
+        sparse_matrix Materialize() const { return _matrix.Transpose(); }
+
+    private:
+        sparse_matrix _matrix;
+    };
+
+    /*!
+     * \brief Transpose of a full matrix, read through the rows of the original.
+     */
+    class matrix_transpose {
+    public:
+        explicit matrix_transpose(const matrix &A) : _matrix(A) {}
+
+        unsigned long rows() const { return _matrix.columns(); }
+
+        unsigned long columns() const { return _matrix.rows(); }
+
+        /*!
+         * \brief The matrix being transposed.
+         */
+        const matrix &original() const { return _matrix; }
+
+        /*!
+         * \brief Transpose of the view, which is the original matrix. Costs \f$ O(1) \f$.
+         */
+        const matrix &Transpose() const { return _matrix; }
+
+        /*!
+         * \brief Build the transposed matrix.
+         */
+        matrix Materialize() const { return _matrix.Transpose(); }
+
+    private:
+        matrix _matrix;
+    };
+
+    /*!
+     * \brief Transpose of A, without copying its entries.
+     */
+    sparse_matrix_transpose TransposeView(const sparse_matrix &A);
+
+    /*!
+     * \brief Transpose of A, without copying its entries.
+     */
+    matrix_transpose TransposeView(const matrix &A);
+
+    /**
+     *  \brief Transposed matrix vector product \f$ A^T u \f$.
+     * @param At View of \f$ A^T \f$, A being \f$ m \times n \f$
+     * @param U \f$ m \times 1 \f$ (column) vector
+     * @return \f$ n \times 1 \f$ (column) vector
+     * @throw std::length_error At and U are not of compatible dimension.
+     * @throw std::invalid_argument U is not a column vector.
+     */
+    vector operator*(const sparse_matrix_transpose &At, const vector &U);
+
+    /**
+     *  \brief Transposed matrix vector product \f$ A^T u \f$.
+     * @param At View of \f$ A^T \f$, A being \f$ m \times n \f$
+     * @param U \f$ m \times 1 \f$ sparse (column) vector
+     * @return \f$ n \times 1 \f$ sparse (column) vector
+     * @throw std::length_error At and U are not of compatible dimension.
+     * @throw std::invalid_argument U is not a column vector.
+     */
+    sparse_vector operator*(const sparse_matrix_transpose &At, const sparse_vector &U);
+
+    /**
+     *  \brief Vector transposed matrix product \f$ u^T A^T = (A u)^T \f$.
+     * @param U \f$ 1 \times n \f$ (row) vector
+     * @param At View of \f$ A^T \f$, A being \f$ m \times n \f$
+     * @return \f$ 1 \times m \f$ (row) vector
+     * @throw std::length_error U and At are not of compatible dimension.
+     * @throw std::invalid_argument U is not a row vector.
+     */
+    vector operator*(const vector &U, const sparse_matrix_transpose &At);
+
+    /**
+     *  \brief Transposed matrix matrix product \f$ A^T B \f$, accumulating outer products of rows.
+     * @param At View of \f$ A^T \f$, A being \f$ m \times n \f$
+     * @param B \f$ m \times l \f$ sparse matrix
+     * @return \f$ n \times l \f$ sparse matrix
+     * @throw std::length_error At and B are not of compatible dimension.
+     */
+    sparse_matrix operator*(const sparse_matrix_transpose &At, const sparse_matrix &B);
+
+    /**
+     *  \brief Transposed matrix vector product \f$ A^T u \f$.
+     * @param At View of \f$ A^T \f$, A being \f$ m \times n \f$
+     * @param U \f$ m \times 1 \f$ (column) vector
+     * @return \f$ n \times 1 \f$ (column) vector
+     * @throw std::length_error At and U are not of compatible dimension.
+     * @throw std::invalid_argument U is not a column vector.
+     */
+    vector operator*(const matrix_transpose &At, const vector &U);
+
+    /**
+     *  \brief Transposed matrix matrix product \f$ A^T B \f$.
+     * @param At View of \f$ A^T \f$, A being \f$ m \times n \f$
+     * @param B \f$ m \times l \f$ matrix
+     * @return \f$ n \times l \f$ matrix
+     * @throw std::length_error At and B are not of compatible dimension.
+     */
+    matrix operator*(const matrix_transpose &At, const matrix &B);
+
+    /**
+     *  \brief Matrix transposed matrix product \f$ A B^T \f$, as dot products of rows.
+     * @param A \f$ m \times n \f$ matrix
+     * @param Bt View of \f$ B^T \f$, B being \f$ l \times n \f$
+     * @return \f$ m \times l \f$ matrix
+     * @throw std::length_error A and Bt are not of compatible dimension.
+     */
+    matrix operator*(const matrix &A, const matrix_transpose &Bt);
+}
+
+#endif //LINEARALGEBRA_TRANSPOSEVIEW_HPP
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include "parallel.hpp"
+#include "triangular_solve.hpp"
+
+namespace algebra_lib {
+    namespace {
+        // Levels with fewer rows than this are solved on the calling thread.
+        const unsigned long minimumLevelChunk = 256;
+    }
+
+    triangular_solve_plan::triangular_solve_plan()
+            : _dimension(0), _levelOffsets(1, 0), _lowerOffsets(1, 0), _upperOffsets(1, 0) {}
+
+    triangular_solve_plan::triangular_solve_plan(const sparse_matrix &L)
+            : _dimension(L.rows()), _diagonal(L.rows(), 0.0), _lowerOffsets(L.rows() + 1, 0),
+              _upperOffsets(L.rows() + 1, 0) {
+        if (L.rows() != L.columns()) {
+            throw std::length_error("Triangular solve: matrix is not square.");
+        }
+
+        // Compressed rows of the strictly lower part, and the level of every row.
+        std::vector<unsigned int> level(_dimension, 0);
+        unsigned int levels = _dimension > 0 ? 1 : 0;
+        std::vector<const sparse_vector *> storedRows(_dimension, nullptr);
+        for (auto const &row : L) {
+            storedRows[row.first] = &row.second;
+        }
+        for (unsigned int row = 0; row < _dimension; ++row) {
+            if (storedRows[row] != nullptr) {
+                for (auto const &entry : *storedRows[row]) {
+                    if (entry.first >= row) {
+                        if (entry.first == row) _diagonal[row] = entry.second;
+                        break;
+                    }
+                    if (entry.second == 0) continue;
+                    _lowerIndices.push_back(entry.first);
+                    _lowerValues.push_back(entry.second);
+                    ++_upperOffsets[entry.first + 1];
+                    level[row] = std::max(level[row], level[entry.first] + 1);
+                }
+            }
+            if (_diagonal[row] == 0) {
+                throw std::domain_error("Triangular solve: zero on the diagonal.");
+            }
+            _lowerOffsets[row + 1] = _lowerIndices.size();
+            levels = std::max(levels, level[row] + 1);
+        }
+
+        // Transpose by counting sort, rows of L^T come out sorted.
+        for (unsigned int row = 0; row < _dimension; ++row) {
+            _upperOffsets[row + 1] += _upperOffsets[row];
+        }
+        std::vector<unsigned long> position(_upperOffsets.begin(), _upperOffsets.end() - 1);
+        _upperIndices.resize(_lowerIndices.size());
+        _upperValues.resize(_lowerValues.size());
+        for (unsigned int row = 0; row < _dimension; ++row) {
+            for (unsigned long entry = _lowerOffsets[row]; entry < _lowerOffsets[row + 1]; ++entry) {
+                unsigned long target = position[_lowerIndices[entry]]++;
+                _upperIndices[target] = row;
+                _upperValues[target] = _lowerValues[entry];
+            }
+        }
+
+        // Rows grouped by level, by counting sort, in increasing order within a level.
+        _levelOffsets.assign(levels + 1, 0);
+        for (unsigned int row = 0; row < _dimension; ++row) {
+            ++_levelOffsets[level[row] + 1];
+        }
+        for (unsigned int l = 0; l < levels; ++l) {
+            _levelOffsets[l + 1] += _levelOffsets[l];
+        }
+        position.assign(_levelOffsets.begin(), _levelOffsets.end() - 1);
+        _levelRows.resize(_dimension);
+        for (unsigned int row = 0; row < _dimension; ++row) {
+            _levelRows[position[level[row]]++] = row;
+        }
+    }
+
+    void triangular_solve_plan::Solve(const vector &Y, vector &X) const {
+        if (Y.size() != _dimension or X.size() != _dimension) {
+            throw std::length_error("Solving lower triangular matrix: vector and matrix are not compatible in dimension");
+        }
+
+        auto y = Y.begin();
+        auto x = X.begin();
+        auto SolveRow = [&](unsigned int row) {
+            double sum = y[row];
+            for (unsigned long entry = _lowerOffsets[row]; entry < _lowerOffsets[row + 1]; ++entry) {
+                sum -= _lowerValues[entry] * x[_lowerIndices[entry]];
+            }
+            x[row] = sum / _diagonal[row];
+        };
+
+        if (ParallelThreads() == 1) {
+            for (unsigned int row = 0; row < _dimension; ++row) {
+                SolveRow(row);
+            }
+            return;
+        }
+        for (unsigned int l = 0; l < levels(); ++l) {
+            ParallelFor(_levelOffsets[l], _levelOffsets[l + 1], [&](unsigned long first, unsigned long last) {
+                for (unsigned long i = first; i < last; ++i) {
+                    SolveRow(_levelRows[i]);
+                }
+            }, minimumLevelChunk);
+        }
+    }
+
+    void triangular_solve_plan::SolveTransposed(const vector &Y, vector &X) const {
+        if (Y.size() != _dimension or X.size() != _dimension) {
+            throw std::length_error("Solving upper triangular matrix: vector and matrix are not compatible in dimension");
+        }
+
+        auto y = Y.begin();
+        auto x = X.begin();
+        auto SolveRow = [&](unsigned int row) {
+            double sum = y[row];
+            for (unsigned long entry = _upperOffsets[row]; entry < _upperOffsets[row + 1]; ++entry) {
+                sum -= _upperValues[entry] * x[_upperIndices[entry]];
+            }
+            x[row] = sum / _diagonal[row];
+        };
+
+        if (ParallelThreads() == 1) {
+            for (unsigned int row = _dimension; row-- > 0;) {
+                SolveRow(row);
+            }
+            return;
+        }
+        for (unsigned int l = levels(); l-- > 0;) {
+            ParallelFor(_levelOffsets[l], _levelOffsets[l + 1], [&](unsigned long first, unsigned long last) {
+                for (unsigned long i = first; i < last; ++i) {
+                    SolveRow(_levelRows[i]);
+                }
+            }, minimumLevelChunk);
+        }
+    }
+
+    vector triangular_solve_plan::Solve(const vector &Y) const {
+        vector X(Y.size(), true);
+        Solve(Y, X);
+        return X;
+    }
+
+    vector triangular_solve_plan::SolveTransposed(const vector &Y) const {
+        vector X(Y.size(), true);
+        SolveTransposed(Y, X);
+        return X;
+    }
+}
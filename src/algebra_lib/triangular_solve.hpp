@@ -0,0 +1,92 @@
+/*! \file triangular_solve.hpp
+ * \brief Level scheduled sparse triangular solves.
+ *
+ * Row i of \f$ L x = y \f$ can be solved once the rows it references are. Giving every row
+ * the level one past the highest level among them groups the rows into levels whose rows
+ * are independent, so every level is solved in parallel, one level after the other. For
+ * \f$ L^T x = y \f$ the dependencies are reversed, and the same levels are solved in
+ * reverse order. triangular_solve_plan does this analysis once, so a factor that is
+ * applied many times keeps its plan next to it.
+ */
+
+#ifndef LINEARALGEBRA_TRIANGULARSOLVE_HPP
+#define LINEARALGEBRA_TRIANGULARSOLVE_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "sparse_matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Levels and compressed rows of a sparse lower triangular matrix L, for repeated solves with L and L^T.
+     */
+    class triangular_solve_plan {
+    public:
+        // Constructors
+        /*!
+         * \brief Empty plan, of a \f$ 0 \times 0 \f$ matrix.
+         */
+        triangular_solve_plan();
+
+        /*!
+         * \brief Analyze L. Entries above the diagonal and stored zeros are ignored.
+         * @throw std::length_error L is not square.
+         * @throw std::domain_error A diagonal entry of L is zero.
+         */
+        explicit triangular_solve_plan(const sparse_matrix &L);
+
+        // Member functions
+        unsigned int rows() const { return _dimension; }
+
+        unsigned int columns() const { return _dimension; }
+
+        /*!
+         * \brief Number of levels, the length of the longest dependency chain.
+         */
+        unsigned int levels() const { return static_cast<unsigned int>(_levelOffsets.size() - 1); }
+
+        /*!
+         * \brief Solve \f$ L x = y \f$.
+         * @param Y Right hand side.
+         * @param X Solution, of the same dimension. May be Y itself.
+         * @throw std::length_error Y or X is not of compatible dimension.
+         */
+        void Solve(const vector &Y, vector &X) const;
+
+        /*!
+         * \brief Solve \f$ L^T x = y \f$.
+         * @param Y Right hand side.
+         * @param X Solution, of the same dimension. May be Y itself.
+         * @throw std::length_error Y or X is not of compatible dimension.
+         */
+        void SolveTransposed(const vector &Y, vector &X) const;
+
+        /*!
+         * \brief Solve \f$ L x = y \f$.
+         * @throw std::length_error Y is not of compatible dimension.
+         */
+        vector Solve(const vector &Y) const;
+
+        /*!
+         * \brief Solve \f$ L^T x = y \f$.
+         * @throw std::length_error Y is not of compatible dimension.
+         */
+        vector SolveTransposed(const vector &Y) const;
+
+    private:
+        unsigned int _dimension;
+        // Rows of every level, level after level.
+        std::vector<unsigned long> _levelOffsets;
+        std::vector<unsigned int> _levelRows;
+        std::vector<double> _diagonal;
+        // Strictly lower part of L and of L^T, in compressed rows.
+        std::vector<unsigned long> _lowerOffsets;
+        std::vector<unsigned int> _lowerIndices;
+        std::vector<double> _lowerValues;
+        std::vector<unsigned long> _upperOffsets;
+        std::vector<unsigned int> _upperIndices;
+        std::vector<double> _upperValues;
+    };
+}
+
+#endif //LINEARALGEBRA_TRIANGULARSOLVE_HPP
@@ -0,0 +1,144 @@
+#include <cmath>
+#include "parallel.hpp"
+#include "tridiagonal_matrix.hpp"
+
+namespace algebra_lib {
+    tridiagonal_matrix::tridiagonal_matrix(unsigned int dimension)
+            : _subdiagonal(dimension ? dimension - 1 : 0, 0.0), _diagonal(dimension, 0.0),
+              _superdiagonal(dimension ? dimension - 1 : 0, 0.0) {}
+
+    tridiagonal_matrix::tridiagonal_matrix(std::vector<double> subdiagonal, std::vector<double> diagonal,
+                                           std::vector<double> superdiagonal)
+            : _subdiagonal(std::move(subdiagonal)), _diagonal(std::move(diagonal)),
+              _superdiagonal(std::move(superdiagonal)) {
+        std::size_t offDiagonal = _diagonal.empty() ? 0 : _diagonal.size() - 1;
+        if (_subdiagonal.size() != offDiagonal or _superdiagonal.size() != offDiagonal) {
+            throw std::length_error("Tridiagonal matrix: diagonals are not compatible in dimension");
+        }
+    }
+
+    double &tridiagonal_matrix::operator()(unsigned int row, unsigned int column) {
+        if (row >= rows() or column >= columns()) {
+            throw std::out_of_range("Exceeded matrix bounds");
+        } else if (row == column) {
+            return _diagonal[row];
+        } else if (row == column + 1) {
+            return _subdiagonal[column];
+        } else if (column == row + 1) {
+            return _superdiagonal[row];
+        }
+        throw std::out_of_range("Exceeded matrix band");
+    }
+
+    double tridiagonal_matrix::operator()(unsigned int row, unsigned int column) const {
+        if (row >= rows() or column >= columns()) {
+            throw std::out_of_range("Exceeded matrix bounds");
+        } else if (row == column) {
+            return _diagonal[row];
+        } else if (row == column + 1) {
+            return _subdiagonal[column];
+        } else if (column == row + 1) {
+            return _superdiagonal[row];
+        }
+        return 0.0;
+    }
+
+    band_matrix tridiagonal_matrix::ToBand() const {
+        band_matrix Band(rows(), 1, 1);
+        for (unsigned int i = 0; i < rows(); ++i) {
+            Band(i, i) = _diagonal[i];
+            if (i > 0) {
+                Band(i, i - 1) = _subdiagonal[i - 1];
+                Band(i - 1, i) = _superdiagonal[i - 1];
+            }
+        }
+        return Band;
+    }
+
+    vector tridiagonal_matrix::Solve(const vector &Y) const {
+        const unsigned int n = rows();
+        if (Y.size() != n) {
+            throw std::length_error("Solving tridiagonal matrix: vector and matrix are not compatible in dimension");
+        }
+
+        // Forward elimination keeps the modified superdiagonal in upper, back substitution
+        // then runs on x in place.
+        vector X(Y);
+        auto x = X.begin();
+        std::vector<double> upper(n);
+        for (unsigned int i = 0; i < n; ++i) {
+            double pivot = _diagonal[i];
+            if (i > 0) {
+                pivot -= _subdiagonal[i - 1] * upper[i - 1];
+                x[i] -= _subdiagonal[i - 1] * x[i - 1];
+            }
+            if (pivot == 0) {
+                throw std::domain_error("Solving tridiagonal matrix: zero pivot.");
+            }
+            upper[i] = i + 1 < n ? _superdiagonal[i] / pivot : 0.0;
+            x[i] /= pivot;
+        }
+        for (unsigned int i = n; i-- > 1;) {
+            x[i - 1] -= upper[i - 1] * x[i];
+        }
+        return X;
+    }
+
+    band_matrix tridiagonal_matrix::CholeskyDecompose() const {
+        band_matrix L(rows(), 1, 0);
+        double previous = 0.0;
+        for (unsigned int i = 0; i < rows(); ++i) {
+            double d = _diagonal[i];
+            if (i > 0) {
+                double l = _subdiagonal[i - 1] / previous;
+                L(i, i - 1) = l;
+                d -= l * l;
+            }
+            if (!(d > 0)) {
+                throw std::domain_error("Cholesky decomposition: matrix is not positive definite.");
+            }
+            previous = sqrt(d);
+            L(i, i) = previous;
+        }
+        return L;
+    }
+
+    vector operator*(const tridiagonal_matrix &A, const vector &U) {
+        if (A.columns() != U.size()) {
+            throw std::length_error(
+                    "Left multiplication with matrix: vector and matrix are not compatible in dimension");
+        } else if (!U.isColumn()) {
+            throw std::invalid_argument(
+                    "Left multiplication with matrix: vector is not a column vector! First transpose it for goodness' sake.");
+        }
+
+        const unsigned int n = A.rows();
+        const double *sub = A.subdiagonal().data();
+        const double *diagonal = A.diagonal().data();
+        const double *super = A.superdiagonal().data();
+        vector Product(n, true);
+        auto u = U.begin();
+        auto y = Product.begin();
+        ParallelFor(0, n, [&](unsigned long first, unsigned long last) {
+            for (unsigned long i = first; i < last; ++i) {
+                double sum = diagonal[i] * u[i];
+                if (i > 0) sum += sub[i - 1] * u[i - 1];
+                if (i + 1 < n) sum += super[i] * u[i + 1];
+                y[i] = sum;
+            }
+        }, 16384);
+        return Product;
+    }
+
+    std::ostream &operator<<(std::ostream &stream, const tridiagonal_matrix &A) {
+        stream << "Tridiagonal matrix of dimension " << A.rows() << "x" << A.columns() << ":" << std::endl;
+        for (unsigned int i = 0; i < A.rows(); ++i) {
+            stream << "row\t" << i + 1 << "\t|\t";
+            if (i > 0) stream << A.subdiagonal()[i - 1] << "\t";
+            stream << A.diagonal()[i] << "\t";
+            if (i + 1 < A.rows()) stream << A.superdiagonal()[i] << "\t";
+            stream << std::endl;
+        }
+        return stream;
+    }
+}
@@ -0,0 +1,103 @@
+/*! \file tridiagonal_matrix.hpp
+ * \brief Tridiagonal matrices, stored as their three diagonals.
+ *
+ * Precision matrices of first order autoregressive processes and second difference
+ * operators are tridiagonal. Solving with the Thomas algorithm and factorizing both take
+ * \f$ O(n) \f$ on three contiguous arrays.
+ */
+
+#ifndef LINEARALGEBRA_TRIDIAGONALMATRIX_HPP
+#define LINEARALGEBRA_TRIDIAGONALMATRIX_HPP
+
+#include "globals.hpp"
+#include "vector.hpp"
+#include "band_matrix.hpp"
+
+namespace algebra_lib {
+    /*!
+     * \brief Class for square tridiagonal matrices.
+     */
+    class tridiagonal_matrix {
+    public:
+        // Constructors
+        /*!
+         * \brief Zero matrix.
+         * @param dimension Rows and columns of the matrix.
+         */
+        explicit tridiagonal_matrix(unsigned int dimension = 0);
+
+        /*!
+         * \brief Matrix from its diagonals.
+         * @param subdiagonal Entries (i + 1, i), one shorter than diagonal.
+         * @param diagonal Entries (i, i).
+         * @param superdiagonal Entries (i, i + 1), one shorter than diagonal.
+         * @throw std::length_error Lengths of the diagonals don't match.
+         */
+        tridiagonal_matrix(std::vector<double> subdiagonal, std::vector<double> diagonal,
+                           std::vector<double> superdiagonal);
+
+        // Member functions
+        unsigned int rows() const { return static_cast<unsigned int>(_diagonal.size()); }
+
+        unsigned int columns() const { return static_cast<unsigned int>(_diagonal.size()); }
+
+        /*!
+         * \brief Entry (row, column) on one of the three diagonals.
+         * @throw std::out_of_range Entry outside matrix or off the three diagonals.
+         */
+        double &operator()(unsigned int row, unsigned int column);
+
+        /*!
+         * \brief Entry (row, column), zero off the three diagonals.
+         * @throw std::out_of_range Entry outside matrix.
+         */
+        double operator()(unsigned int row, unsigned int column) const;
+
+        const std::vector<double> &subdiagonal() const { return _subdiagonal; }
+
+        const std::vector<double> &diagonal() const { return _diagonal; }
+
+        const std::vector<double> &superdiagonal() const { return _superdiagonal; }
+
+        /*!
+         * \brief Band matrix with one sub- and one superdiagonal.
+         */
+        band_matrix ToBand() const;
+
+        /*!
+         * \brief Solve \f$ A x = y \f$ with the Thomas algorithm, Gaussian elimination without pivoting.
+         *
+         * Stable for diagonally dominant and for symmetric positive definite matrices.
+         * @throw std::length_error Y is not of compatible dimension.
+         * @throw std::domain_error A pivot is zero.
+         */
+        vector Solve(const vector &Y) const;
+
+        /*!
+         * \brief Lower bidiagonal Cholesky factor L, with \f$ A = L L^T \f$, for CholeskySolve.
+         *
+         * Reads only the diagonal and the subdiagonal.
+         * @throw std::domain_error Matrix is not positive definite.
+         */
+        band_matrix CholeskyDecompose() const;
+
+    private:
+        std::vector<double> _subdiagonal;
+        std::vector<double> _diagonal;
+        std::vector<double> _superdiagonal;
+    };
+
+    /**
+     *  \brief Tridiagonal matrix vector product.
+     * @param A \f$ n \times n \f$ tridiagonal matrix
+     * @param U \f$ n \times 1 \f$ (column) vector
+     * @return \f$ n \times 1 \f$ (column) vector
+     * @throw std::length_error A and U are not of compatible dimension.
+     * @throw std::invalid_argument U is not a column vector.
+     */
+    vector operator*(const tridiagonal_matrix &A, const vector &U);
+
+    std::ostream &operator<<(std::ostream &stream, const tridiagonal_matrix &A);
+}
+
+#endif //LINEARALGEBRA_TRIDIAGONALMATRIX_HPP